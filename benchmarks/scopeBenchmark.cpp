@@ -0,0 +1,241 @@
+/*
+Copyright (C) 2026  agent <agent@local>
+This file is part of kdenlive. See www.kdenlive.org.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+*/
+
+#include "histogramgenerator.h"
+#include "rgbparadegenerator.h"
+#include "vectorscopegenerator.h"
+#include "waveformgenerator.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QGuiApplication>
+#include <QImage>
+#include <QImageReader>
+#include <QStringList>
+#include <iostream>
+#include <memory>
+#include <mlt++/Mlt.h>
+
+enum Scope { Waveform, Histogram, Vectorscope, RGBParade };
+
+const QList<Scope> allScopes()
+{
+    return {Waveform, Histogram, Vectorscope, RGBParade};
+}
+
+const QString scopeName(Scope scope)
+{
+    switch (scope) {
+    case Waveform:
+        return QStringLiteral("waveform");
+    case Histogram:
+        return QStringLiteral("histogram");
+    case Vectorscope:
+        return QStringLiteral("vectorscope");
+    case RGBParade:
+        return QStringLiteral("rgbparade");
+    }
+    return QString();
+}
+
+bool scopeFromName(const QString &name, Scope &scope)
+{
+    for (Scope s : allScopes()) {
+        if (scopeName(s) == name.toLower()) {
+            scope = s;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Drive the generators with the default settings of each scope widget
+QImage renderScope(Scope scope, const QImage &frame, const QSize &size, uint accelFactor)
+{
+    static WaveformGenerator waveformGenerator;
+    static HistogramGenerator histogramGenerator;
+    static VectorscopeGenerator vectorscopeGenerator;
+    static RGBParadeGenerator rgbParadeGenerator;
+    switch (scope) {
+    case Waveform:
+        return waveformGenerator.calculateWaveform(size, frame, WaveformGenerator::PaintMode_Yellow, true, ITURec::Rec_709, accelFactor);
+    case Histogram:
+        return histogramGenerator.calculateHistogram(size, frame,
+                                                     HistogramGenerator::ComponentY | HistogramGenerator::ComponentR | HistogramGenerator::ComponentG |
+                                                         HistogramGenerator::ComponentB,
+                                                     ITURec::Rec_709, false, false, accelFactor);
+    case Vectorscope:
+        return vectorscopeGenerator.calculateVectorscope(size, frame, 1., VectorscopeGenerator::PaintMode_Green2, VectorscopeGenerator::ColorSpace_YUV, true,
+                                                         accelFactor);
+    case RGBParade:
+        return rgbParadeGenerator.calculateRGBParade(size, frame, RGBParadeGenerator::PaintMode_RGB, true, false, accelFactor);
+    }
+    return QImage();
+}
+
+void printUsage(const char *path)
+{
+    std::cout << "This executable renders the colour scopes without a display, to measure their speed" << std::endl
+              << "and to compare their output against reference images." << std::endl
+              << std::endl
+              << path << " <image directory or video file>" << std::endl
+              << "\t-h, --help\n\t\tDisplay this help" << std::endl
+              << "\t--scopes=<list>\n\t\tComma separated scopes to render: waveform, histogram, vectorscope, rgbparade (default all)" << std::endl
+              << "\t--accel=<list>\n\t\tComma separated acceleration factors (default 1,2,4,8)" << std::endl
+              << "\t--size=<w>x<h>\n\t\tSize of the scope images (default 512x512)" << std::endl
+              << "\t--frames=<n>\n\t\tNumber of frames decoded from a video file, evenly spread over the clip (default 25)" << std::endl
+              << "\t--output=<directory>\n\t\tWrite the scope images of the first frame to this directory" << std::endl
+              << "\t--profile=<profile>\n\t\tUse the given profile to decode a video file (run: melt -query profiles)" << std::endl;
+}
+
+QList<QImage> loadImages(const QString &path)
+{
+    QList<QImage> frames;
+    QDir dir(path);
+    QStringList filters;
+    for (const QByteArray &format : QImageReader::supportedImageFormats()) {
+        filters << QStringLiteral("*.") + QString::fromLatin1(format);
+    }
+    for (const QString &file : dir.entryList(filters, QDir::Files, QDir::Name)) {
+        QImage img(dir.absoluteFilePath(file));
+        if (!img.isNull()) {
+            // The generators read the frame as QRgb values
+            frames << img.convertToFormat(QImage::Format_RGB32);
+        }
+    }
+    return frames;
+}
+
+QList<QImage> decodeClip(const std::string &profile, const QString &path, int count)
+{
+    QList<QImage> frames;
+    Mlt::Factory::init(nullptr);
+    Mlt::Profile prof(profile.c_str());
+    Mlt::Producer prod(prof, path.toUtf8().constData());
+    if (!prod.is_valid()) {
+        return frames;
+    }
+    int length = prod.get_length();
+    int step = qMax(1, length / count);
+    for (int pos = 0; pos < length && frames.count() < count; pos += step) {
+        prod.seek(pos);
+        std::unique_ptr<Mlt::Frame> frame(prod.get_frame());
+        mlt_image_format format = mlt_image_rgb24a;
+        int width = prof.width();
+        int height = prof.height();
+        const uchar *imagedata = frame->get_image(format, width, height);
+        if (imagedata != nullptr) {
+            frames << QImage(imagedata, width, height, QImage::Format_RGBA8888).convertToFormat(QImage::Format_RGB32);
+        }
+    }
+    return frames;
+}
+
+int main(int argc, char *argv[])
+{
+    // Scopes draw their axis labels with QPainter, which needs a platform plugin but no display
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QGuiApplication app(argc, argv);
+    QStringList args = app.arguments();
+    args.removeAt(0);
+
+    std::string profile = "atsc_1080p_25";
+    QList<Scope> scopes = allScopes();
+    QList<uint> accelFactors = {1, 2, 4, 8};
+    QSize size(512, 512);
+    int count = 25;
+    QString outputDir;
+
+    for (const QString &str : app.arguments().mid(1)) {
+        const QString value = str.section(QLatin1Char('='), 1);
+        if (str.startsWith(QLatin1String("--profile="))) {
+            profile = value.toStdString();
+        } else if (str.startsWith(QLatin1String("--scopes="))) {
+            scopes.clear();
+#if QT_VERSION < QT_VERSION_CHECK(5, 15, 0)
+            const QStringList names = value.split(QLatin1Char(','), QString::SkipEmptyParts);
+#else
+            const QStringList names = value.split(QLatin1Char(','), Qt::SkipEmptyParts);
+#endif
+            for (const QString &name : names) {
+                Scope scope;
+                if (!scopeFromName(name, scope)) {
+                    std::cout << "Unknown scope: " << name.toStdString() << std::endl;
+                    return 1;
+                }
+                scopes << scope;
+            }
+        } else if (str.startsWith(QLatin1String("--accel="))) {
+            accelFactors.clear();
+#if QT_VERSION < QT_VERSION_CHECK(5, 15, 0)
+            const QStringList factors = value.split(QLatin1Char(','), QString::SkipEmptyParts);
+#else
+            const QStringList factors = value.split(QLatin1Char(','), Qt::SkipEmptyParts);
+#endif
+            for (const QString &factor : factors) {
+                accelFactors << qMax(1u, factor.toUInt());
+            }
+        } else if (str.startsWith(QLatin1String("--size="))) {
+            size = QSize(value.section(QLatin1Char('x'), 0, 0).toInt(), value.section(QLatin1Char('x'), 1, 1).toInt());
+        } else if (str.startsWith(QLatin1String("--frames="))) {
+            count = qMax(1, value.toInt());
+        } else if (str.startsWith(QLatin1String("--output="))) {
+            outputDir = value;
+        } else if (str == "-h" || str == "--help") {
+            printUsage(argv[0]);
+            return 0;
+        } else {
+            continue;
+        }
+        args.removeOne(str);
+    }
+
+    if (args.isEmpty() || size.isEmpty() || scopes.isEmpty() || accelFactors.isEmpty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    const QString source = args.at(0);
+    QList<QImage> frames = QFileInfo(source).isDir() ? loadImages(source) : decodeClip(profile, source, count);
+    if (frames.isEmpty()) {
+        std::cout << source.toStdString() << " does not contain any usable frame." << std::endl;
+        return 2;
+    }
+    if (!outputDir.isEmpty() && !QDir().mkpath(outputDir)) {
+        std::cout << "Cannot create " << outputDir.toStdString() << std::endl;
+        return 2;
+    }
+
+    std::cout << "Rendering " << frames.count() << " frames of " << frames.first().width() << "x" << frames.first().height() << " into " << size.width()
+              << "x" << size.height() << " scopes" << std::endl;
+    for (Scope scope : scopes) {
+        const std::string name = scopeName(scope).toStdString();
+        for (uint accel : accelFactors) {
+            QElapsedTimer timer;
+            timer.start();
+            QImage first;
+            for (const QImage &frame : frames) {
+                QImage result = renderScope(scope, frame, size, accel);
+                if (first.isNull()) {
+                    first = result;
+                }
+            }
+            double perFrame = double(timer.nsecsElapsed()) / 1000000. / frames.count();
+            std::cout << name << "\taccel " << accel << ":\t" << perFrame << " ms/frame" << std::endl;
+            if (!outputDir.isEmpty() && !first.isNull()) {
+                first.save(QDir(outputDir).absoluteFilePath(QStringLiteral("%1_accel%2.png").arg(scopeName(scope)).arg(accel)));
+            }
+        }
+    }
+    return 0;
+}
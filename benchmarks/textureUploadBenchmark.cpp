@@ -0,0 +1,183 @@
+/*
+Copyright (C) 2026  agent <agent@local>
+This file is part of kdenlive. See www.kdenlive.org.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+*/
+
+#include "textureuploader.h"
+
+#include <QElapsedTimer>
+#include <QGuiApplication>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLExtraFunctions>
+#include <QStringList>
+#include <iostream>
+#include <vector>
+
+void printUsage(const char *path)
+{
+    std::cout << "This executable measures how fast the monitor uploads YUV 4:2:0 frames to textures," << std::endl
+              << "comparing the previous reallocating upload with the direct and pixel buffer paths of TextureUploader." << std::endl
+              << "It renders into an offscreen surface, so no display is needed." << std::endl
+              << std::endl
+              << path << std::endl
+              << "\t-h, --help\n\t\tDisplay this help" << std::endl
+              << "\t--width=<w>\n\t\tFrame width (default 3840)" << std::endl
+              << "\t--height=<h>\n\t\tFrame height (default 2160)" << std::endl
+              << "\t--frames=<n>\n\t\tNumber of frames uploaded by each pass (default 200)" << std::endl;
+}
+
+// Same steps as the monitor before TextureUploader: new textures and glTexImage2D for each frame
+void legacyUpload(QOpenGLFunctions *f, const uint8_t *image, int width, int height, GLuint texture[3])
+{
+    f->glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if (texture[0] != 0u) {
+        f->glDeleteTextures(3, texture);
+    }
+    f->glGenTextures(3, texture);
+    const uint8_t *planes[3] = {image, image + width * height, image + width * height + (width / 2) * (height / 2)};
+    for (int i = 0; i < 3; ++i) {
+        f->glBindTexture(GL_TEXTURE_2D, texture[i]);
+        f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        int w = i == 0 ? width : width / 2;
+        int h = i == 0 ? height : height / 2;
+        f->glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE, w, h, 0, GL_LUMINANCE, GL_UNSIGNED_BYTE, planes[i]);
+    }
+    f->glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+struct PassResult
+{
+    double msPerFrame;
+    double submitMsPerFrame;
+};
+
+// Frames cycle through a few different images so that the driver cannot skip identical uploads
+PassResult runPass(QOpenGLContext *context, const std::vector<std::vector<uint8_t>> &images, int width, int height, int frames, int mode)
+{
+    QOpenGLFunctions *f = context->functions();
+    QOpenGLExtraFunctions *ef = context->extraFunctions();
+    TextureUploader uploader;
+    if (mode > 0) {
+        uploader.initialize(context, mode == 2);
+    }
+    GLuint legacyTextures[3] = {0, 0, 0};
+    GLsync pending = nullptr;
+    qint64 submitTime = 0;
+    QElapsedTimer timer;
+    QElapsedTimer submitTimer;
+    timer.start();
+    for (int i = 0; i < frames; ++i) {
+        const uint8_t *image = images.at(size_t(i) % images.size()).data();
+        GLuint textures[3];
+        submitTimer.start();
+        GLsync fence = nullptr;
+        if (mode == 0) {
+            legacyUpload(f, image, width, height, legacyTextures);
+        } else {
+            fence = uploader.upload(image, width, height, textures);
+        }
+        if (fence == nullptr) {
+            // What the frame renderer does so that the monitor can use the textures
+            f->glFinish();
+        }
+        submitTime += submitTimer.nsecsElapsed();
+        if (pending != nullptr) {
+            // The monitor consumes the previous frame while this one is transferred
+            ef->glClientWaitSync(pending, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+            ef->glDeleteSync(pending);
+        }
+        pending = fence;
+    }
+    if (pending != nullptr) {
+        ef->glClientWaitSync(pending, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+        ef->glDeleteSync(pending);
+    }
+    f->glFinish();
+    PassResult result{timer.nsecsElapsed() / 1e6 / frames, submitTime / 1e6 / frames};
+    if (legacyTextures[0] != 0u) {
+        f->glDeleteTextures(3, legacyTextures);
+    }
+    uploader.cleanup();
+    return result;
+}
+
+int main(int argc, char *argv[])
+{
+    // Only an offscreen surface is used, no display is needed
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QGuiApplication app(argc, argv);
+    int width = 3840;
+    int height = 2160;
+    int frames = 200;
+
+    for (const QString &str : app.arguments().mid(1)) {
+        const QString value = str.section(QLatin1Char('='), 1);
+        if (str.startsWith(QLatin1String("--width="))) {
+            width = qMax(2, value.toInt()) & ~1;
+        } else if (str.startsWith(QLatin1String("--height="))) {
+            height = qMax(2, value.toInt()) & ~1;
+        } else if (str.startsWith(QLatin1String("--frames="))) {
+            frames = qMax(1, value.toInt());
+        } else if (str == "-h" || str == "--help") {
+            printUsage(argv[0]);
+            return 0;
+        }
+    }
+
+    QOpenGLContext context;
+    if (!context.create()) {
+        std::cout << "Cannot create an OpenGL context." << std::endl;
+        return 2;
+    }
+    QOffscreenSurface surface;
+    surface.setFormat(context.format());
+    surface.create();
+    if (!context.makeCurrent(&surface)) {
+        std::cout << "Cannot use the offscreen surface." << std::endl;
+        return 2;
+    }
+
+    const size_t frameSize = size_t(width * height + 2 * (width / 2) * (height / 2));
+    std::vector<std::vector<uint8_t>> images(4, std::vector<uint8_t>(frameSize));
+    for (size_t i = 0; i < images.size(); ++i) {
+        for (size_t j = 0; j < frameSize; ++j) {
+            images[i][j] = uint8_t((j * 7 + i * 31) & 0xff);
+        }
+    }
+
+    TextureUploader probe;
+    probe.initialize(&context);
+    const QSurfaceFormat format = context.format();
+    std::cout << "Renderer: " << reinterpret_cast<const char *>(context.functions()->glGetString(GL_RENDERER)) << " ("
+              << (context.isOpenGLES() ? "OpenGL ES " : "OpenGL ") << format.majorVersion() << "." << format.minorVersion() << ")"
+              << std::endl;
+    std::cout << "Uploading " << frames << " frames of " << width << "x" << height << std::endl;
+    std::cout << "Pixel buffer path " << (probe.mode() == TextureUploader::PixelBuffer ? "available" : "not used on this renderer") << std::endl;
+
+    const char *names[3] = {"Reallocating upload:", "Direct upload:     ", "Pixel buffers:     "};
+    const int passes = probe.mode() == TextureUploader::PixelBuffer ? 3 : 2;
+    double reference = 0.;
+    for (int mode = 0; mode < passes; ++mode) {
+        // Warm up the driver before timing
+        runPass(&context, images, width, height, 5, mode);
+        PassResult result = runPass(&context, images, width, height, frames, mode);
+        if (mode == 0) {
+            reference = result.msPerFrame;
+        }
+        std::cout << names[mode] << " " << result.msPerFrame << " ms/frame, " << result.submitMsPerFrame << " ms blocking the renderer thread, "
+                  << (result.msPerFrame > 0 ? reference / result.msPerFrame : 0.) << "x" << std::endl;
+    }
+    context.doneCurrent();
+    return 0;
+}
@@ -0,0 +1,158 @@
+/*
+Copyright (C) 2026  agent <agent@local>
+This file is part of kdenlive. See www.kdenlive.org.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+*/
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QStringList>
+#include <iostream>
+#include <memory>
+#include <mlt++/Mlt.h>
+
+void printUsage(const char *path)
+{
+    std::cout << "This executable measures how many timeline thumbnails per second can be " << std::endl
+              << "extracted from a clip, comparing frame exact seeking with keyframe aligned decoding." << std::endl
+              << std::endl
+              << path << " <video file>" << std::endl
+              << "\t-h, --help\n\t\tDisplay this help" << std::endl
+              << "\t--count=<n>\n\t\tNumber of thumbnails, evenly spread over the clip (default 100)" << std::endl
+              << "\t--height=<h>\n\t\tThumbnail height (default 54)" << std::endl
+              << "\t--profile=<profile>\n\t\tUse the given profile for calculation (run: melt -query profiles)" << std::endl;
+}
+
+std::unique_ptr<Mlt::Producer> buildProducer(Mlt::Profile &profile, const char *file, bool keyframesOnly)
+{
+    std::unique_ptr<Mlt::Producer> prod(new Mlt::Producer(profile, "avformat-novalidate", file));
+    if (!prod->is_valid()) {
+        return prod;
+    }
+    if (keyframesOnly) {
+        prod->set("skip_frame", "nokey");
+        prod->set("skip_loop_filter", "all");
+    }
+    Mlt::Filter scaler(profile, "swscale");
+    Mlt::Filter padder(profile, "resize");
+    Mlt::Filter converter(profile, "avcolor_space");
+    prod->set("audio_index", -1);
+    prod->set("out", prod->get_length() - 1);
+    prod->attach(scaler);
+    prod->attach(padder);
+    prod->attach(converter);
+    return prod;
+}
+
+// Same steps as KThumb::getFrame: copy, swap and scale
+QImage exactThumb(Mlt::Producer &prod, int pos, int width, int height)
+{
+    prod.seek(pos);
+    std::unique_ptr<Mlt::Frame> frame(prod.get_frame());
+    mlt_image_format format = mlt_image_rgb24a;
+    int ow = width;
+    int oh = height;
+    const uchar *imagedata = frame->get_image(format, ow, oh);
+    if (imagedata == nullptr) {
+        return QImage();
+    }
+    QImage temp(ow, oh, QImage::Format_ARGB32);
+    memcpy(temp.scanLine(0), imagedata, (unsigned)(ow * oh * 4));
+    return temp.rgbSwapped();
+}
+
+// Same steps as KThumb::getThumbnail: wrap and copy once
+QImage fastThumb(Mlt::Producer &prod, int pos, int width, int height)
+{
+    prod.seek(pos);
+    std::unique_ptr<Mlt::Frame> frame(prod.get_frame());
+    frame->set("deinterlace_method", "onefield");
+    frame->set("top_field_first", -1);
+    frame->set("rescale.interp", "nearest");
+    mlt_image_format format = mlt_image_rgb24a;
+    int ow = width;
+    int oh = height;
+    const uchar *imagedata = frame->get_image(format, ow, oh);
+    if (imagedata == nullptr) {
+        return QImage();
+    }
+    return QImage(imagedata, ow, oh, QImage::Format_RGBA8888).copy();
+}
+
+double runPass(Mlt::Producer &prod, int count, int width, int height, bool fast)
+{
+    int length = prod.get_length();
+    int step = qMax(1, length / count);
+    int done = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (int pos = 0; pos < length && done < count; pos += step) {
+        QImage img = fast ? fastThumb(prod, pos, width, height) : exactThumb(prod, pos, width, height);
+        if (!img.isNull()) {
+            done++;
+        }
+    }
+    qint64 elapsed = qMax(qint64(1), timer.elapsed());
+    return done * 1000. / elapsed;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QStringList args = app.arguments();
+    args.removeAt(0);
+
+    std::string profile = "atsc_1080p_24";
+    int count = 100;
+    int height = 54;
+
+    for (const QString &str : app.arguments().mid(1)) {
+        if (str.startsWith(QLatin1String("--profile="))) {
+            profile = str.section(QLatin1Char('='), 1).toStdString();
+            args.removeOne(str);
+        } else if (str.startsWith(QLatin1String("--count="))) {
+            count = qMax(1, str.section(QLatin1Char('='), 1).toInt());
+            args.removeOne(str);
+        } else if (str.startsWith(QLatin1String("--height="))) {
+            height = qMax(8, str.section(QLatin1Char('='), 1).toInt());
+            args.removeOne(str);
+        } else if (str == "-h" || str == "--help") {
+            printUsage(argv[0]);
+            return 0;
+        }
+    }
+
+    if (args.isEmpty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    std::string file = args.at(0).toStdString();
+
+    Mlt::Factory::init(nullptr);
+    Mlt::Profile prof(profile.c_str());
+    // Thumbnails are decoded through a small profile, like Core::thumbProfile()
+    int width = int(height * prof.dar() + 0.5);
+    width += width % 2;
+    prof.set_width(width);
+    prof.set_height(height);
+
+    std::unique_ptr<Mlt::Producer> exact = buildProducer(prof, file.c_str(), false);
+    std::unique_ptr<Mlt::Producer> fast = buildProducer(prof, file.c_str(), true);
+    if (!exact->is_valid() || !fast->is_valid()) {
+        std::cout << file << " is invalid." << std::endl;
+        return 2;
+    }
+
+    std::cout << "Extracting " << count << " thumbnails of " << width << "x" << height << " from " << file << std::endl;
+    double exactRate = runPass(*exact.get(), count, width, height, false);
+    std::cout << "Frame exact seeking:     " << exactRate << " thumbnails/sec" << std::endl;
+    double fastRate = runPass(*fast.get(), count, width, height, true);
+    std::cout << "Keyframe aligned decode: " << fastRate << " thumbnails/sec" << std::endl;
+    std::cout << "Speedup: " << (exactRate > 0 ? fastRate / exactRate : 0.) << "x" << std::endl;
+    return 0;
+}
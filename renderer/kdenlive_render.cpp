@@ -19,6 +19,7 @@
 
 #include "../src/lib/localeHandling.h"
 #include "mlt++/Mlt.h"
+#include "previewdaemon.h"
 #include "renderjob.h"
 #include <QApplication>
 #include <QDir>
@@ -29,6 +30,16 @@ int main(int argc, char **argv)
     QApplication app(argc, argv);
     QStringList args = app.arguments();
     QStringList preargs;
+    if (args.count() >= 5 && args.at(1) == QLatin1String("-daemon")) {
+        // Timeline preview renderer kept running by Kdenlive: profile, rendered file extension, avformat consumer params
+#if QT_VERSION < QT_VERSION_CHECK(5, 15, 0)
+        QStringList consumerParams = args.at(4).split(QLatin1Char(' '), QString::SkipEmptyParts);
+#else
+        QStringList consumerParams = args.at(4).split(QLatin1Char(' '), Qt::SkipEmptyParts);
+#endif
+        PreviewDaemon daemon(args.at(2), args.at(3), consumerParams);
+        return daemon.exec();
+    }
     if (args.count() >= 4) {
         // Remove program name
         args.removeFirst();
@@ -162,7 +173,9 @@ int main(int argc, char **argv)
                 "  player: path to video player to play when rendering is over, use '-' to disable playing\n"
                 "  src: source file (usually MLT XML)\n"
                 "  dest: destination file\n"
-                "  args: space separated libavformat arguments\n");
+                "  args: space separated libavformat arguments\n"
+                "\nkdenlive_render -daemon [profile] [extension] [args]\n"
+                "  Render timeline preview chunks requested on stdin until it is closed\n");
         return 1;
     }
 }
@@ -0,0 +1,209 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by agent <agent@local>                             *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+
+#include "previewdaemon.h"
+#include "../src/lib/localeHandling.h"
+#include "mlt++/Mlt.h"
+
+#include <QCryptographicHash>
+#include <QFile>
+#include <QLocale>
+#include <QMutexLocker>
+#include <QThread>
+#include <cstdio>
+
+PreviewDaemon::PreviewDaemon(const QString &profilePath, const QString &extension, const QStringList &consumerParams)
+    : m_profilePath(profilePath)
+    , m_extension(extension)
+    , m_consumerParams(consumerParams)
+    , m_quit(false)
+    , m_abortCount(0)
+{
+}
+
+PreviewDaemon::~PreviewDaemon()
+{
+    m_scene.reset();
+    m_profile.reset();
+}
+
+int PreviewDaemon::exec()
+{
+    // After initialising the MLT factory, set the locale back from user default to C
+    // to ensure numbers are always serialised with . as decimal point.
+    Mlt::Factory::init();
+    LocaleHandling::resetLocale();
+    m_profile.reset(new Mlt::Profile(m_profilePath.toUtf8().constData()));
+    m_profile->set_explicit(1);
+
+    QThread *reader = QThread::create([this]() { readCommands(); });
+    reader->start();
+    fprintf(stderr, "READY\n");
+    forever {
+        QMutexLocker lk(&m_mutex);
+        while (m_jobs.isEmpty() && !m_quit) {
+            m_jobQueued.wait(&m_mutex);
+        }
+        if (m_jobs.isEmpty()) {
+            break;
+        }
+        Job job = m_jobs.takeFirst();
+        lk.unlock();
+        render(job);
+    }
+    // We only get here once the reader is done with stdin
+    reader->wait();
+    delete reader;
+    return 0;
+}
+
+void PreviewDaemon::readCommands()
+{
+    QFile input;
+    if (!input.open(stdin, QIODevice::ReadOnly)) {
+        QMutexLocker lk(&m_mutex);
+        m_quit = true;
+        m_jobQueued.wakeAll();
+        return;
+    }
+    forever {
+        const QByteArray line = input.readLine();
+        if (line.isEmpty()) {
+            // Kdenlive closed the pipe or exited
+            break;
+        }
+        const QString command = QString::fromUtf8(line).trimmed();
+        if (command == QLatin1String("abort")) {
+            m_abortCount++;
+        } else if (command == QLatin1String("quit")) {
+            break;
+        } else if (command.startsWith(QLatin1String("render\t"))) {
+            const QStringList params = command.split(QLatin1Char('\t'));
+            if (params.count() < 5) {
+                fprintf(stderr, "INVALID command: %s\n", line.constData());
+                continue;
+            }
+            Job job;
+            job.scene = params.at(1);
+            job.folder = QDir(params.at(2));
+            job.chunkSize = qMax(1, params.at(3).toInt());
+#if QT_VERSION < QT_VERSION_CHECK(5, 15, 0)
+            job.chunks = params.at(4).split(QLatin1Char(','), QString::SkipEmptyParts);
+#else
+            job.chunks = params.at(4).split(QLatin1Char(','), Qt::SkipEmptyParts);
+#endif
+            job.abortCount = m_abortCount;
+            QMutexLocker lk(&m_mutex);
+            m_jobs << job;
+            m_jobQueued.wakeAll();
+        }
+    }
+    m_abortCount++;
+    QMutexLocker lk(&m_mutex);
+    m_jobs.clear();
+    m_quit = true;
+    m_jobQueued.wakeAll();
+}
+
+bool PreviewDaemon::loadScene(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const QByteArray hash = QCryptographicHash::hash(file.readAll(), QCryptographicHash::Md5);
+    file.close();
+    if (m_scene && hash == m_sceneHash) {
+        // Timeline did not change since the last job, for example when the zone was extended
+        return true;
+    }
+    m_scene.reset(new Mlt::Producer(*m_profile.get(), nullptr, path.toUtf8().constData()));
+    if (!m_scene->is_valid()) {
+        m_scene.reset();
+        m_sceneHash.clear();
+        return false;
+    }
+    m_sceneHash = hash;
+    const char *localename = m_scene->get_lcnumeric();
+    QLocale::setDefault(QLocale(localename));
+    return true;
+}
+
+void PreviewDaemon::render(const Job &job)
+{
+    if (job.abortCount != m_abortCount) {
+        fprintf(stderr, "ABORTED\n");
+        return;
+    }
+    if (!loadScene(job.scene)) {
+        fprintf(stderr, "INVALID playlist: %s \n", job.scene.toUtf8().constData());
+        fprintf(stderr, "FINISHED\n");
+        return;
+    }
+    for (const QString &frame : job.chunks) {
+        fprintf(stderr, "START:%d \n", frame.toInt());
+        QString fileName = QStringLiteral("%1.%2").arg(frame, m_extension);
+        if (job.folder.exists(fileName)) {
+            // Don't overwrite an existing file
+            fprintf(stderr, "DONE:%d \n", frame.toInt());
+            continue;
+        }
+        if (!renderChunk(frame.toInt(), job.chunkSize, job.folder.absoluteFilePath(fileName), job.abortCount)) {
+            // Never leave a truncated chunk behind
+            job.folder.remove(fileName);
+            fprintf(stderr, job.abortCount != m_abortCount ? "ABORTED\n" : "FAILED\n");
+            return;
+        }
+        fprintf(stderr, "DONE:%d \n", frame.toInt());
+    }
+    fprintf(stderr, "FINISHED\n");
+}
+
+bool PreviewDaemon::renderChunk(int frame, int chunkSize, const QString &file, int abortCount)
+{
+    QScopedPointer<Mlt::Producer> playlst(m_scene->cut(frame, frame + chunkSize - 1));
+    QScopedPointer<Mlt::Consumer> cons(new Mlt::Consumer(*m_profile.get(), QString("avformat:%1").arg(file).toUtf8().constData()));
+    if (!cons->is_valid()) {
+        fprintf(stderr, "INVALID consumer for chunk %d: %s\n", frame, file.toUtf8().constData());
+        return false;
+    }
+    for (const QString &param : qAsConst(m_consumerParams)) {
+        if (param.contains(QLatin1Char('='))) {
+            cons->set(param.section(QLatin1Char('='), 0, 0).toUtf8().constData(), param.section(QLatin1Char('='), 1).toUtf8().constData());
+        }
+    }
+    cons->set("terminate_on_pause", 1);
+    cons->connect(*playlst);
+    playlst.reset();
+    cons->start();
+    bool aborted = false;
+    while (!cons->is_stopped()) {
+        if (abortCount != m_abortCount) {
+            aborted = true;
+            break;
+        }
+        QThread::msleep(20);
+    }
+    cons->stop();
+    cons->purge();
+    return !aborted;
+}
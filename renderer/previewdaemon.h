@@ -0,0 +1,90 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by agent <agent@local>                             *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+
+#ifndef PREVIEWDAEMON_H
+#define PREVIEWDAEMON_H
+
+#include <QDir>
+#include <QMutex>
+#include <QStringList>
+#include <QWaitCondition>
+#include <atomic>
+#include <memory>
+
+namespace Mlt {
+class Profile;
+class Producer;
+} // namespace Mlt
+
+/**
+ * @class PreviewDaemon
+ * @brief Long running timeline preview renderer, started with kdenlive_render -daemon.
+ * The MLT factory, the profile and the last loaded scene are kept between jobs, so that re-rendering
+ * a couple of chunks after an edit does not pay for the whole MLT startup again.
+ * Commands are read from stdin, one per line:
+ *   render\t<scene>\t<folder>\t<chunk size>\t<frame>,<frame>,...
+ *   abort
+ *   quit
+ * The scene is only parsed again when the file content changed since the previous job.
+ * Progress is reported on stderr like the one shot -split mode (START:frame, DONE:frame), each job
+ * ending with either FINISHED, ABORTED or FAILED if a chunk could not be rendered. Closing stdin quits the daemon.
+ */
+class PreviewDaemon
+{
+public:
+    PreviewDaemon(const QString &profilePath, const QString &extension, const QStringList &consumerParams);
+    ~PreviewDaemon();
+    /** @brief Process commands until quit, returns the process exit code */
+    int exec();
+
+private:
+    struct Job
+    {
+        QString scene;
+        QDir folder;
+        int chunkSize;
+        QStringList chunks;
+        /** @brief Value of m_abortCount when the job was queued, an abort received later cancels it */
+        int abortCount;
+    };
+    QString m_profilePath;
+    QString m_extension;
+    QStringList m_consumerParams;
+    std::unique_ptr<Mlt::Profile> m_profile;
+    std::unique_ptr<Mlt::Producer> m_scene;
+    QByteArray m_sceneHash;
+    QMutex m_mutex;
+    QWaitCondition m_jobQueued;
+    QList<Job> m_jobs;
+    bool m_quit;
+    std::atomic_int m_abortCount;
+
+    /** @brief Read commands from stdin, runs in its own thread so that aborts are seen during a render */
+    void readCommands();
+    /** @brief Make sure the scene in @param path is loaded, returns false if it is invalid */
+    bool loadScene(const QString &path);
+    void render(const Job &job);
+    /** @brief Render one chunk into @param file, returns false if the job was aborted meanwhile or the chunk cannot be encoded */
+    bool renderChunk(int frame, int chunkSize, const QString &file, int abortCount);
+};
+
+#endif
@@ -23,6 +23,8 @@
 #define ASSETSREPOSITORY_H
 
 #include "definitions.h"
+#include <QFuture>
+#include <QHash>
 #include <QSet>
 #include <memory>
 #include <mlt++/Mlt.h>
@@ -62,6 +64,11 @@ public:
     /* @brief Returns a DomElement representing the asset's properties */
     QDomElement getXml(const QString &assetId) const;
 
+    /* @brief Starts reading the catalog cache with the given file name in a background thread.
+       The repository uses this data instead of reading the file when it is built. Must be called from the GUI thread
+     */
+    static void prefetchCatalog(const QString &catalogName);
+
 protected:
     struct Info
     {
@@ -111,11 +118,36 @@ protected:
     /* @brief Returns the path to the assets' preferred list*/
     virtual QString assetPreferredListPath() const = 0;
 
+    /* @brief Returns the file name of the catalog cache for this repository */
+    virtual QString assetCatalogName() const = 0;
+
+    /* @brief Computes a key identifying the state of MLT, its plugins and the custom asset files.
+       The catalog cache is only used if it was written with the same key. Returns an empty key, disabling the cache, if
+       the MLT repository directory is unknown.
+       @param assets the list of assets available in MLT
+       @param customFiles the custom XML files, in parsing order
+     */
+    QByteArray catalogKey(Mlt::Properties *assets, const QStringList &customFiles) const;
+
+    /* @brief Returns the path of the catalog cache with the given file name */
+    static QString catalogPath(const QString &catalogName);
+
+    /* @brief Fills the asset list from the catalog cache, using the prefetched data if any
+       @return true if the cache exists and matches the given key
+     */
+    bool loadCatalog(const QString &path, const QByteArray &key);
+
+    /* @brief Writes the current asset list to the catalog cache. The file is written in a background thread */
+    void storeCatalog(const QString &path, const QByteArray &key) const;
+
     std::unordered_map<QString, Info> m_assets;
 
     QSet<QString> m_blacklist;
 
     QSet<QString> m_preferred_list;
+
+    /* @brief Catalog caches being read by prefetchCatalog(), by path */
+    static QHash<QString, QFuture<QByteArray>> m_prefetchedCatalogs;
 };
 
 #include "abstractassetsrepository.ipp"
@@ -22,11 +22,18 @@
 #include "xml/xml.hpp"
 #include "kdenlivesettings.h"
 
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QFile>
+#include <QSaveFile>
 #include <QStandardPaths>
 #include <QString>
 #include <QTextStream>
+#include <QtConcurrent>
 #include <KLocalizedString>
 
 #include <locale>
@@ -34,10 +41,28 @@
 #include <xlocale.h>
 #endif
 
+template <typename AssetType> QHash<QString, QFuture<QByteArray>> AbstractAssetsRepository<AssetType>::m_prefetchedCatalogs;
+
 template <typename AssetType> AbstractAssetsRepository<AssetType>::AbstractAssetsRepository() = default;
 
+template <typename AssetType> QString AbstractAssetsRepository<AssetType>::catalogPath(const QString &catalogName)
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/assets/") + catalogName;
+}
+
+template <typename AssetType> void AbstractAssetsRepository<AssetType>::prefetchCatalog(const QString &catalogName)
+{
+    const QString path = catalogPath(catalogName);
+    m_prefetchedCatalogs.insert(path, QtConcurrent::run([path]() {
+        QFile file(path);
+        return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+    }));
+}
+
 template <typename AssetType> void AbstractAssetsRepository<AssetType>::init()
 {
+    QElapsedTimer timer;
+    timer.start();
     // Parse blacklist
     parseAssetList(assetBlackListPath(), m_blacklist);
 
@@ -46,6 +71,30 @@ template <typename AssetType> void AbstractAssetsRepository<AssetType>::init()
 
     // Retrieve the list of MLT's available assets.
     QScopedPointer<Mlt::Properties> assets(retrieveListFromMlt());
+
+    // Set the directories to look into for effects.
+    QStringList asset_dirs = assetDirs();
+    // reverse order to prioritize local install
+    QStringList customFiles;
+    QListIterator<QString> dirs_it(asset_dirs);
+    for (dirs_it.toBack(); dirs_it.hasPrevious();) { auto dir=dirs_it.previous();
+        QDir current_dir(dir);
+        QStringList filter {QStringLiteral("*.xml")};
+        QStringList fileList = current_dir.entryList(filter, QDir::Files);
+        for (const auto &file : qAsConst(fileList)) {
+            customFiles << current_dir.absoluteFilePath(file);
+        }
+    }
+
+    // If nothing changed since last start, load the assets from our catalog instead of querying MLT
+    const QString catalogFile = catalogPath(assetCatalogName());
+    const QByteArray key = catalogKey(assets.data(), customFiles);
+    qint64 listTime = timer.restart();
+    if (loadCatalog(catalogFile, key)) {
+        qDebug() << "Loaded" << m_assets.size() << "assets from" << catalogFile << ": lists" << listTime << "ms, catalog" << timer.elapsed() << "ms";
+        return;
+    }
+
     int max = assets->count();
     QString sox = QStringLiteral("sox.");
     for (int i = 0; i < max; ++i) {
@@ -64,28 +113,18 @@ template <typename AssetType> void AbstractAssetsRepository<AssetType>::init()
             }
         }
     }
+    qint64 mltTime = timer.restart();
 
     // We now parse custom effect xml
 
-    // Set the directories to look into for effects.
-    QStringList asset_dirs = assetDirs();
-
     /* Parsing of custom xml works as follows: we parse all custom files.
        Each of them contains a tag, which is the corresponding mlt asset, and an id that is the name of the asset. Note that several custom files can correspond
        to the same tag, and in that case they must have different ids. We do the parsing in a map from ids to parse info, and then we add them to the asset
        list, while discarding the bare version of each tag (the one with no file associated)
     */
     std::unordered_map<QString, Info> customAssets;
-    // reverse order to prioritize local install
-    QListIterator<QString> dirs_it(asset_dirs);
-    for (dirs_it.toBack(); dirs_it.hasPrevious();) { auto dir=dirs_it.previous();
-        QDir current_dir(dir);
-        QStringList filter {QStringLiteral("*.xml")};
-        QStringList fileList = current_dir.entryList(filter, QDir::Files);
-        for (const auto &file : qAsConst(fileList)) {
-            QString path = current_dir.absoluteFilePath(file);
-            parseCustomAssetFile(path, customAssets);
-        }
+    for (const QString &path : qAsConst(customFiles)) {
+        parseCustomAssetFile(path, customAssets);
     }
 
     // We add the custom assets
@@ -93,6 +132,138 @@ template <typename AssetType> void AbstractAssetsRepository<AssetType>::init()
         // Custom assets should override default ones
         m_assets[custom.first] = custom.second;
     }
+    qint64 customTime = timer.restart();
+    // Custom files may have been upgraded while parsing, so compute the key again
+    const QByteArray parsedKey = catalogKey(assets.data(), customFiles);
+    if (!parsedKey.isEmpty()) {
+        storeCatalog(catalogFile, parsedKey);
+    }
+    qDebug() << "Parsed" << m_assets.size() << "assets: lists" << listTime << "ms, MLT metadata" << mltTime << "ms, custom files" << customTime << "ms, catalog"
+             << timer.elapsed() << "ms";
+}
+
+template <typename AssetType> QByteArray AbstractAssetsRepository<AssetType>::catalogKey(Mlt::Properties *assets, const QStringList &customFiles) const
+{
+    // Without the directory MLT loaded its modules from, we cannot tell if they were updated
+    const QString repository = QString::fromUtf8(mlt_factory_directory());
+    if (repository.isEmpty() || !QFileInfo(repository).isDir()) {
+        return QByteArray();
+    }
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QCoreApplication::applicationVersion().toUtf8());
+    hash.addData(mlt_version_get_string());
+    // Asset names and descriptions are translated
+    hash.addData(KLocalizedString::languages().join(QLatin1Char(',')).toUtf8());
+    // MLT modules, an updated module can change the metadata of its services
+    const QFileInfoList modules = QDir(repository).entryInfoList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+    for (const QFileInfo &module : modules) {
+        hash.addData(module.fileName().toUtf8());
+        hash.addData(QByteArray::number(module.lastModified().toMSecsSinceEpoch()));
+    }
+    // Services registered by the modules, this covers plugins loaded from other places like frei0r or LADSPA
+    for (int i = 0; i < assets->count(); ++i) {
+        hash.addData(assets->get_name(i));
+    }
+    // Blacklisted assets are not in the catalog
+    QStringList blacklist = m_blacklist.values();
+    blacklist.sort();
+    hash.addData(blacklist.join(QLatin1Char(',')).toUtf8());
+    for (const QString &file : customFiles) {
+        QFileInfo info(file);
+        hash.addData(file.toUtf8());
+        hash.addData(QByteArray::number(info.size()));
+        hash.addData(QByteArray::number(info.lastModified().toMSecsSinceEpoch()));
+    }
+    return hash.result();
+}
+
+template <typename AssetType> bool AbstractAssetsRepository<AssetType>::loadCatalog(const QString &path, const QByteArray &key)
+{
+    QByteArray data;
+    auto prefetched = m_prefetchedCatalogs.find(path);
+    if (prefetched != m_prefetchedCatalogs.end()) {
+        data = prefetched.value().result();
+        m_prefetchedCatalogs.erase(prefetched);
+    } else if (!key.isEmpty()) {
+        QFile file(path);
+        if (file.open(QIODevice::ReadOnly)) {
+            data = file.readAll();
+        }
+    }
+    if (key.isEmpty() || data.isEmpty()) {
+        return false;
+    }
+    QDataStream stream(data);
+    stream.setVersion(QDataStream::Qt_5_9);
+    quint32 version;
+    QByteArray fileKey;
+    stream >> version >> fileKey;
+    if (version != 1 || fileKey != key) {
+        return false;
+    }
+    quint32 count;
+    QByteArray xmlData;
+    stream >> count >> xmlData;
+    // All asset descriptions are stored in a single document so that they are parsed in one go
+    QDomDocument doc;
+    if (!doc.setContent(qUncompress(xmlData), false)) {
+        return false;
+    }
+    QDomElement node = doc.documentElement().firstChildElement();
+    std::unordered_map<QString, Info> assets;
+    for (quint32 i = 0; i < count; ++i) {
+        Info info;
+        int type;
+        stream >> info.id >> info.mltId >> info.name >> info.description >> info.author >> info.version_str >> info.version >> type;
+        if (stream.status() != QDataStream::Ok || node.isNull()) {
+            qWarning() << "Corrupted asset catalog" << path;
+            return false;
+        }
+        info.type = static_cast<AssetType>(type);
+        if (node.tagName() != QLatin1String("nullasset")) {
+            info.xml = node;
+        }
+        node = node.nextSiblingElement();
+        assets[info.id] = info;
+    }
+    m_assets = std::move(assets);
+    return true;
+}
+
+template <typename AssetType> void AbstractAssetsRepository<AssetType>::storeCatalog(const QString &path, const QByteArray &key) const
+{
+    QDomDocument doc;
+    QDomElement root = doc.createElement(QStringLiteral("catalog"));
+    doc.appendChild(root);
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_9);
+    for (const auto &asset : m_assets) {
+        const Info &info = asset.second;
+        stream << info.id << info.mltId << info.name << info.description << info.author << info.version_str << info.version << int(info.type);
+        if (info.xml.isNull()) {
+            // Keep one element per asset so that the document stays aligned with the list
+            root.appendChild(doc.createElement(QStringLiteral("nullasset")));
+        } else {
+            root.appendChild(doc.importNode(info.xml, true));
+        }
+    }
+    QByteArray xmlData = doc.toByteArray(-1);
+    quint32 count = quint32(m_assets.size());
+    // Compression and disk access do not need to delay startup
+    QtConcurrent::run([path, key, count, data, xmlData]() {
+        QDir().mkpath(QFileInfo(path).absolutePath());
+        QSaveFile file(path);
+        if (!file.open(QIODevice::WriteOnly)) {
+            qWarning() << "Cannot write asset catalog" << path;
+            return;
+        }
+        QDataStream out(&file);
+        out.setVersion(QDataStream::Qt_5_9);
+        out << quint32(1) << key << count << qCompress(xmlData);
+        out.writeRawData(data.constData(), data.size());
+        file.commit();
+    });
 }
 
 template <typename AssetType> void AbstractAssetsRepository<AssetType>::parseAssetList(const QString &filePath, QSet<QString> &destination)
@@ -288,8 +288,10 @@ void AssetParameterModel::setParameter(const QString &name, int value, bool upda
         if (!m_isAudio) {
             // Trigger monitor refresh
             pCore->refreshProjectItem(m_ownerId);
-            // Invalidate timeline preview
-            pCore->invalidateItem(m_ownerId);
+            // Invalidate timeline preview, a disabled effect cannot change it
+            if (m_asset->get_int("disable") == 0) {
+                pCore->invalidateItem(m_ownerId);
+            }
         }
     }
 }
@@ -391,8 +393,10 @@ void AssetParameterModel::setParameter(const QString &name, const QString &param
         if (!m_isAudio) {
             // Trigger monitor refresh
             pCore->refreshProjectItem(m_ownerId);
-            // Invalidate timeline preview
-            pCore->invalidateItem(m_ownerId);
+            // Invalidate timeline preview, a disabled effect cannot change it
+            if (m_asset->get_int("disable") == 0) {
+                pCore->invalidateItem(m_ownerId);
+            }
         }
     }
 }
@@ -0,0 +1,340 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by agent <agent@local>                             *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+
+#include "meteringengine.hpp"
+
+#include "mlt++/MltFilter.h"
+#include "mlt++/MltService.h"
+
+#include <QtMath>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+
+// Extra channels are not metered
+static const int maxChannels = 8;
+// Must hold the longest integration window, 3 seconds at 60fps
+static const int ringSize = 256;
+// Displayed value for silence
+static const double silenceDb = -100.;
+
+namespace {
+struct MeterSlot
+{
+    // Odd while the audio thread writes the slot
+    std::atomic<quint32> sequence{0};
+    std::atomic<int> generation{-1};
+    std::atomic<int> position{0};
+    std::atomic<int> samples{0};
+    std::atomic<int> channels{0};
+    std::atomic<float> peak[maxChannels];
+    std::atomic<float> meanSquare[maxChannels];
+    // Mean square after the K-weighting filter, for loudness
+    std::atomic<float> weighted[maxChannels];
+};
+
+struct Biquad
+{
+    double b0, b1, b2, a1, a2;
+};
+} // namespace
+
+struct MeterTapState
+{
+    std::atomic_bool active{false};
+    std::atomic<int> generation{0};
+    std::atomic<quint32> writeIndex{0};
+    MeterSlot slots[ringSize];
+
+    // Only used from the audio thread
+    int frequency{0};
+    int lastPosition{-1};
+    Biquad stages[2];
+    double history[maxChannels][2][2];
+
+    void setupFilters(int rate);
+    void analyse(int position, const float *buffer, int samples, int channelCount, int rate);
+};
+
+void MeterTapState::setupFilters(int rate)
+{
+    // K-weighting filter of ITU-R BS.1770: a high shelf followed by a high pass
+    frequency = rate;
+    double f0 = 1681.974450955533;
+    double gain = 3.999843853973347;
+    double q = 0.7071752369554196;
+    double k = std::tan(M_PI * f0 / rate);
+    double vh = std::pow(10.0, gain / 20.0);
+    double vb = std::pow(vh, 0.4996667741545416);
+    double a0 = 1.0 + k / q + k * k;
+    stages[0] = {(vh + vb * k / q + k * k) / a0, 2.0 * (k * k - vh) / a0, (vh - vb * k / q + k * k) / a0, 2.0 * (k * k - 1.0) / a0, (1.0 - k / q + k * k) / a0};
+    f0 = 38.13547087602444;
+    q = 0.5003270373238773;
+    k = std::tan(M_PI * f0 / rate);
+    a0 = 1.0 + k / q + k * k;
+    stages[1] = {1.0, -2.0, 1.0, 2.0 * (k * k - 1.0) / a0, (1.0 - k / q + k * k) / a0};
+    lastPosition = -1;
+}
+
+void MeterTapState::analyse(int position, const float *buffer, int samples, int channelCount, int rate)
+{
+    if (samples <= 0 || rate <= 0) {
+        return;
+    }
+    if (rate != frequency) {
+        setupFilters(rate);
+    }
+    if (position != lastPosition + 1) {
+        // Seek, the filter history belongs to another part of the timeline
+        memset(history, 0, sizeof(history));
+    }
+    lastPosition = position;
+    int channels = qMin(channelCount, maxChannels);
+    MeterSlot &slot = slots[writeIndex.fetch_add(1, std::memory_order_relaxed) % ringSize];
+    quint32 sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (int c = 0; c < channels; ++c) {
+        // Audio is planar
+        const float *data = buffer + c * samples;
+        double peak = 0.;
+        double sum = 0.;
+        double weightedSum = 0.;
+        double(&z)[2][2] = history[c];
+        for (int i = 0; i < samples; ++i) {
+            double x = data[i];
+            peak = qMax(peak, std::fabs(x));
+            sum += x * x;
+            for (int s = 0; s < 2; ++s) {
+                const Biquad &f = stages[s];
+                double y = f.b0 * x + z[s][0];
+                z[s][0] = f.b1 * x - f.a1 * y + z[s][1];
+                z[s][1] = f.b2 * x - f.a2 * y;
+                x = y;
+            }
+            weightedSum += x * x;
+        }
+        slot.peak[c].store(float(peak), std::memory_order_relaxed);
+        slot.meanSquare[c].store(float(sum / samples), std::memory_order_relaxed);
+        slot.weighted[c].store(float(weightedSum / samples), std::memory_order_relaxed);
+    }
+    slot.channels.store(channels, std::memory_order_relaxed);
+    slot.samples.store(samples, std::memory_order_relaxed);
+    slot.position.store(position, std::memory_order_relaxed);
+    slot.generation.store(generation.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+static void destroy_state(void *state)
+{
+    delete static_cast<MeterTapState *>(state);
+}
+
+static int tap_get_audio(mlt_frame frame, void **buffer, mlt_audio_format *format, int *frequency, int *channels, int *samples)
+{
+    auto filter = static_cast<mlt_filter>(mlt_frame_pop_audio(frame));
+    auto *state = static_cast<MeterTapState *>(mlt_properties_get_data(MLT_FILTER_PROPERTIES(filter), "_meter_state", nullptr));
+    if (state == nullptr || !state->active.load(std::memory_order_relaxed)) {
+        return mlt_frame_get_audio(frame, buffer, format, frequency, channels, samples);
+    }
+    *format = mlt_audio_float;
+    int error = mlt_frame_get_audio(frame, buffer, format, frequency, channels, samples);
+    if (error == 0 && *format == mlt_audio_float && *buffer != nullptr) {
+        state->analyse(int(mlt_frame_get_position(frame)), static_cast<const float *>(*buffer), *samples, *channels, *frequency);
+    }
+    return error;
+}
+
+static mlt_frame tap_process(mlt_filter filter, mlt_frame frame)
+{
+    mlt_frame_push_audio(frame, filter);
+    mlt_frame_push_audio(frame, (void *)tap_get_audio);
+    return frame;
+}
+
+MeterTap::MeterTap(mlt_profile profile)
+    : m_state(nullptr)
+    , m_fps(mlt_profile_fps(profile))
+{
+    mlt_filter filter = mlt_filter_new();
+    if (filter == nullptr) {
+        return;
+    }
+    filter->process = tap_process;
+    mlt_properties properties = MLT_FILTER_PROPERTIES(filter);
+    mlt_properties_set_data(properties, "_profile", profile, 0, nullptr, nullptr);
+    m_state = new MeterTapState();
+    mlt_properties_set_data(properties, "_meter_state", m_state, 0, destroy_state, nullptr);
+    // Never saved with the project
+    mlt_properties_set_int(properties, "_loader", 1);
+    mlt_properties_set_int(properties, "_kdenlive_meter", 1);
+    mlt_properties_set_int(properties, "disable", 1);
+    m_filter.reset(new Mlt::Filter(filter));
+    mlt_filter_close(filter);
+}
+
+MeterTap::~MeterTap() = default;
+
+bool MeterTap::isValid() const
+{
+    return m_filter && m_filter->is_valid();
+}
+
+void MeterTap::attach(Mlt::Service &service)
+{
+    service.attach(*m_filter.get());
+}
+
+void MeterTap::detach(Mlt::Service &service)
+{
+    service.detach(*m_filter.get());
+}
+
+void MeterTap::setActive(bool active)
+{
+    if (!isValid()) {
+        return;
+    }
+    m_state->active = active;
+    // A disabled filter is skipped by MLT, so hidden meters cost nothing
+    m_filter->set("disable", active ? 0 : 1);
+}
+
+bool MeterTap::isActive() const
+{
+    return isValid() && m_state->active;
+}
+
+void MeterTap::clear()
+{
+    if (isValid()) {
+        m_state->generation++;
+    }
+}
+
+static double toDb(double value, double factor)
+{
+    return value > 0. ? qMax(silenceDb, factor * std::log10(value)) : silenceDb;
+}
+
+bool MeterTap::levels(int position, Mode mode, int rmsWindow, QVector<double> &values) const
+{
+    if (!isValid()) {
+        return false;
+    }
+    int window = 1;
+    if (mode == Rms) {
+        window = qBound(1, rmsWindow, ringSize);
+    } else if (mode == Loudness) {
+        // EBU R128 momentary loudness
+        window = qBound(1, qRound(0.4 * m_fps), ringSize);
+    }
+    const int generation = m_state->generation.load(std::memory_order_relaxed);
+    double peak[maxChannels] = {0.};
+    double sum[maxChannels] = {0.};
+    qint64 totalSamples = 0;
+    int channels = 0;
+    for (const MeterSlot &slot : m_state->slots) {
+        quint32 before = slot.sequence.load(std::memory_order_acquire);
+        if (before & 1) {
+            // Being written
+            continue;
+        }
+        int slotPosition = slot.position.load(std::memory_order_relaxed);
+        if (slot.generation.load(std::memory_order_relaxed) != generation || slotPosition > position || slotPosition <= position - window) {
+            continue;
+        }
+        int slotChannels = slot.channels.load(std::memory_order_relaxed);
+        int samples = slot.samples.load(std::memory_order_relaxed);
+        double slotPeak[maxChannels];
+        double slotSum[maxChannels];
+        for (int c = 0; c < slotChannels; ++c) {
+            slotPeak[c] = slot.peak[c].load(std::memory_order_relaxed);
+            slotSum[c] = mode == Loudness ? slot.weighted[c].load(std::memory_order_relaxed) : slot.meanSquare[c].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != before) {
+            // Overwritten while we were reading
+            continue;
+        }
+        channels = qMax(channels, slotChannels);
+        for (int c = 0; c < slotChannels; ++c) {
+            peak[c] = qMax(peak[c], slotPeak[c]);
+            sum[c] += slotSum[c] * samples;
+        }
+        totalSamples += samples;
+    }
+    if (channels == 0 || totalSamples == 0) {
+        return false;
+    }
+    values.resize(channels);
+    switch (mode) {
+    case Peak:
+        for (int c = 0; c < channels; ++c) {
+            values[c] = toDb(peak[c], 20.);
+        }
+        break;
+    case Rms:
+        for (int c = 0; c < channels; ++c) {
+            values[c] = toDb(sum[c] / totalSamples, 10.);
+        }
+        break;
+    case Loudness: {
+        // Channel weights of ITU-R BS.1770, surround channels of a 5.1 layout are boosted and the LFE ignored
+        double power = 0.;
+        for (int c = 0; c < channels; ++c) {
+            double weight = 1.;
+            if (channels == 6) {
+                weight = c == 3 ? 0. : (c > 3 ? 1.41 : 1.);
+            }
+            power += weight * sum[c] / totalSamples;
+        }
+        values.fill(power > 0. ? qMax(silenceDb, -0.691 + 10. * std::log10(power)) : silenceDb);
+        break;
+    }
+    }
+    return true;
+}
+
+void MeterBallistics::reset()
+{
+    m_values.clear();
+    m_timer.invalidate();
+}
+
+const QVector<double> &MeterBallistics::process(const QVector<double> &values, double releasePerSecond)
+{
+    double elapsed = m_timer.isValid() ? m_timer.restart() / 1000. : 0.;
+    if (!m_timer.isValid()) {
+        m_timer.start();
+    }
+    if (m_values.size() != values.size()) {
+        m_values = values;
+        return m_values;
+    }
+    double release = releasePerSecond * elapsed;
+    for (int i = 0; i < values.size(); ++i) {
+        // Instant attack, the release follows the configured rate
+        m_values[i] = qMax(values.at(i), m_values.at(i) - release);
+    }
+    return m_values;
+}
@@ -0,0 +1,90 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by agent <agent@local>                             *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+
+#ifndef METERINGENGINE_H
+#define METERINGENGINE_H
+
+#include <QElapsedTimer>
+#include <QVector>
+#include <memory>
+#include <mlt/framework/mlt_types.h>
+
+namespace Mlt {
+class Filter;
+class Service;
+} // namespace Mlt
+
+struct MeterTapState;
+
+/**
+ * @class MeterTap
+ * @brief Measures the audio passing through a service (a track or the master tractor) for the mixer meters.
+ * The measure is done in the audio thread: for each frame, the peak, mean square and K-weighted mean square
+ * of every channel are written to a lock-free ring buffer. The mixer pulls the values for the displayed frame
+ * at display rate, without any property lookup or locking on the audio side.
+ */
+class MeterTap
+{
+public:
+    enum Mode { Peak = 0, Rms = 1, Loudness = 2 };
+
+    explicit MeterTap(mlt_profile profile);
+    ~MeterTap();
+    bool isValid() const;
+    /** @brief Attach the tap to @param service, it should come last so that the other filters are reflected in the meter */
+    void attach(Mlt::Service &service);
+    void detach(Mlt::Service &service);
+    /** @brief Audio is only analysed while the meter is visible */
+    void setActive(bool active);
+    bool isActive() const;
+    /** @brief Discard the stored measures, for example when the mix changed */
+    void clear();
+    /** @brief Compute the meter value of each channel at @param position, in dBFS (LUFS in loudness mode)
+     *  @param rmsWindow the integration time of the rms mode, in frames. Loudness always uses the 400ms momentary window
+     *  @return false if no measure is available for this position
+     */
+    bool levels(int position, Mode mode, int rmsWindow, QVector<double> &values) const;
+
+private:
+    std::unique_ptr<Mlt::Filter> m_filter;
+    /** @brief Owned by the filter, so that it stays valid as long as the audio thread may use it */
+    MeterTapState *m_state;
+    double m_fps;
+};
+
+/**
+ * @class MeterBallistics
+ * @brief Smooths meter values for display: instant attack and a release at a fixed rate in dB per second.
+ */
+class MeterBallistics
+{
+public:
+    void reset();
+    /** @brief Feed the measured values (in dB) and return the ones to display */
+    const QVector<double> &process(const QVector<double> &values, double releasePerSecond);
+
+private:
+    QVector<double> m_values;
+    QElapsedTimer m_timer;
+};
+
+#endif
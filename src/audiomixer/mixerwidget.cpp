@@ -23,7 +23,6 @@
 
 #include "mlt++/MltFilter.h"
 #include "mlt++/MltTractor.h"
-#include "mlt++/MltEvent.h"
 #include "mlt++/MltProfile.h"
 #include "core.h"
 #include "kdenlivesettings.h"
@@ -41,6 +40,7 @@
 #include <QSpinBox>
 #include <QDoubleSpinBox>
 #include <QLabel>
+#include <QMenu>
 #include <QMouseEvent>
 #include <QStyle>
 #include <QFontDatabase>
@@ -80,40 +80,21 @@ static inline int fromDB(double level)
     return value;
 }
 
-void MixerWidget::property_changed( mlt_service , MixerWidget *widget, char *name )
-{
-    if (widget && !strcmp(name, "_position")) {
-        mlt_properties filter_props = MLT_FILTER_PROPERTIES( widget->m_monitorFilter->get_filter());
-        int pos = mlt_properties_get_int(filter_props, "_position");
-        if (!widget->m_levels.contains(pos)) {
-            QVector<double> levels;
-            for (int i = 0; i < widget->m_channels; i++) {
-                levels << IEC_Scale(mlt_properties_get_double(filter_props, QString("_audio_level.%1").arg(i).toUtf8().constData()));
-            }
-            widget->m_levels[pos] = std::move(levels);
-            //{IEC_Scale(mlt_properties_get_double(filter_props, "_audio_level.0")), IEC_Scale(mlt_properties_get_double(filter_props, "_audio_level.1"))};
-            if (widget->m_levels.size() > widget->m_maxLevels) {
-                widget->m_levels.erase(widget->m_levels.begin());
-            }
-        }
-    }
-}
-
 MixerWidget::MixerWidget(int tid, std::shared_ptr<Mlt::Tractor> service, const QString &trackTag, MixerManager *parent)
 : QWidget(parent)
     , m_manager(parent)
     , m_tid(tid)
     , m_levelFilter(nullptr)
-    , m_monitorFilter(nullptr)
     , m_balanceFilter(nullptr)
     , m_channels(pCore->audioChannels())
     , m_balanceSlider(nullptr)
-    , m_maxLevels(qMax(30, (int)(service->get_fps() * 1.5)))
+    , m_fps(service->get_fps())
     , m_solo(nullptr)
     , m_record(nullptr)
     , m_collapse(nullptr)
     , m_lastVolume(0)
-    , m_listener(nullptr)
+    , m_meterConnected(false)
+    , m_meterPaused(false)
     , m_recording(false)
 {
     buildUI(service.get(), trackTag);
@@ -124,16 +105,16 @@ MixerWidget::MixerWidget(int tid, Mlt::Tractor *service, const QString &trackTag
     , m_manager(parent)
     , m_tid(tid)
     , m_levelFilter(nullptr)
-    , m_monitorFilter(nullptr)
     , m_balanceFilter(nullptr)
     , m_channels(pCore->audioChannels())
     , m_balanceSlider(nullptr)
-    , m_maxLevels(qMax(30, (int)(service->get_fps() * 1.5)))
+    , m_fps(service->get_fps())
     , m_solo(nullptr)
     , m_record(nullptr)
     , m_collapse(nullptr)
     , m_lastVolume(0)
-    , m_listener(nullptr)
+    , m_meterConnected(false)
+    , m_meterPaused(false)
     , m_recording(false)
 {
     buildUI(service, trackTag);
@@ -141,8 +122,8 @@ MixerWidget::MixerWidget(int tid, Mlt::Tractor *service, const QString &trackTag
 
 MixerWidget::~MixerWidget()
 {
-    if (m_listener) {
-        delete m_listener;
+    if (m_meterTap) {
+        m_meterTap->setActive(false);
     }
 }
 
@@ -195,15 +176,16 @@ void MixerWidget::buildUI(Mlt::Tractor *service, const QString &trackTag)
 
     // Check if we already have build-in filters for this tractor
     int max = service->filter_count();
+    std::vector<std::shared_ptr<Mlt::Filter>> staleMeters;
     for (int i = 0; i < max; i++) {
         std::shared_ptr<Mlt::Filter> fl(service->filter(i));
         if (!fl->is_valid()) {
             continue;
         }
         const QString filterService = fl->get("mlt_service");
-        if (filterService == QLatin1String("audiolevel")) {
-            m_monitorFilter = fl;
-            m_monitorFilter->set("disable", 0);
+        if (fl->get_int("_kdenlive_meter") == 1 || filterService == QLatin1String("audiolevel")) {
+            // Meter of a previous mixer, or audiolevel filter saved by older versions
+            staleMeters.push_back(fl);
         } else if (filterService == QLatin1String("volume")) {
             m_levelFilter = fl;
             double volume = m_levelFilter->get_double("level");
@@ -234,13 +216,13 @@ void MixerWidget::buildUI(Mlt::Tractor *service, const QString &trackTag)
             service->attach(*m_balanceFilter.get());
         }
     }
+    for (auto &fl : staleMeters) {
+        service->detach(*fl.get());
+    }
     // Monitoring should be appended last so that other effects are reflected in audio monitor
-    if (m_monitorFilter == nullptr) {
-        m_monitorFilter.reset(new Mlt::Filter(service->get_profile(), "audiolevel"));
-        if (m_monitorFilter->is_valid()) {
-            m_monitorFilter->set("iec_scale", 0);
-            service->attach(*m_monitorFilter.get());
-        }
+    m_meterTap.reset(new MeterTap(service->get_profile()));
+    if (m_meterTap->isValid()) {
+        m_meterTap->attach(*service);
     }
 
     m_trackLabel = new QLabel(trackTag, this);
@@ -340,7 +322,7 @@ void MixerWidget::buildUI(Mlt::Tractor *service, const QString &trackTag)
             m_volumeSpin->setValue(dbValue);
             m_levelFilter->set("level", dbValue);
             m_levelFilter->set("disable", value == 60 ? 1 : 0);
-            m_levels.clear();
+            clear();
             emit m_manager->purgeCache();
             pCore->setDocumentModified();
         }
@@ -352,7 +334,7 @@ void MixerWidget::buildUI(Mlt::Tractor *service, const QString &trackTag)
             if (m_balanceFilter != nullptr) {
                 m_balanceFilter->set("start", (value + 50) / 100.);
                 m_balanceFilter->set("disable", value == 0 ? 1 : 0);
-                m_levels.clear();
+                clear();
                 emit m_manager->purgeCache();
                 pCore->setDocumentModified();
             }
@@ -401,7 +383,22 @@ void MixerWidget::mousePressEvent(QMouseEvent *event)
 {
     if(event->button() == Qt::RightButton) {
         QWidget *child = childAt(event->pos());
-        if (child == m_balanceSlider) {
+        if (child == m_audioMeterWidget.get()) {
+            // Meter mode is shared by all mixers
+            QMenu menu(this);
+            const QStringList modes = {i18n("Peak"), i18n("RMS"), i18n("Loudness (momentary)")};
+            for (int i = 0; i < modes.count(); i++) {
+                QAction *ac = menu.addAction(modes.at(i));
+                ac->setCheckable(true);
+                ac->setChecked(KdenliveSettings::mixermetermode() == i);
+                ac->setData(i);
+            }
+            QAction *selected = menu.exec(event->globalPos());
+            if (selected) {
+                KdenliveSettings::setMixermetermode(selected->data().toInt());
+                emit m_manager->clearMixers();
+            }
+        } else if (child == m_balanceSlider) {
             m_balanceSpin->setValue(0);
         } else if (child == m_volumeSlider) {
             m_volumeSlider->setValue(60);
@@ -444,27 +441,39 @@ void MixerWidget::updateLabel()
 
 void MixerWidget::updateAudioLevel(int pos)
 {
-    QMutexLocker lk(&m_storeMutex);
-    if (m_levels.contains(pos)) {
-        m_audioMeterWidget->setAudioValues(m_levels.value(pos));
-        //m_levels.remove(pos);
-    } else {
+    if (!m_meterTap || !m_meterTap->isActive() || m_recording) {
+        return;
+    }
+    QVector<double> levels;
+    int rmsWindow = qMax(1, qRound(KdenliveSettings::mixerrmswindow() * m_fps / 1000.));
+    if (!m_meterTap->levels(pos, MeterTap::Mode(KdenliveSettings::mixermetermode()), rmsWindow, levels)) {
+        m_ballistics.reset();
         m_audioMeterWidget->setAudioValues(m_audioData);
+        return;
+    }
+    const QVector<double> &display = m_ballistics.process(levels, KdenliveSettings::mixermeterrelease());
+    for (int i = 0; i < display.size(); i++) {
+        levels[i] = IEC_Scale(pow(10., display.at(i) / 20.));
     }
+    m_audioMeterWidget->setAudioValues(levels);
 }
 
 
 void MixerWidget::reset()
 {
-    QMutexLocker lk(&m_storeMutex);
-    m_levels.clear();
+    if (m_meterTap) {
+        m_meterTap->clear();
+    }
+    m_ballistics.reset();
     m_audioMeterWidget->setAudioValues(m_audioData);
 }
 
 void MixerWidget::clear()
 {
-    QMutexLocker lk(&m_storeMutex);
-    m_levels.clear();
+    if (m_meterTap) {
+        m_meterTap->clear();
+    }
+    m_ballistics.reset();
 }
 
 
@@ -525,19 +534,19 @@ void MixerWidget::setRecordState(bool recording)
 
 void MixerWidget::connectMixer(bool doConnect)
 {
-    if (doConnect) {
-        if (m_listener == nullptr) {
-            m_listener = m_monitorFilter->listen("property-changed", this, (mlt_listener)property_changed);
-        }
-    } else {
-        delete m_listener;
-        m_listener = nullptr;
-    }
+    m_meterConnected = doConnect;
+    updateMeterState();
 }
 
 void MixerWidget::pauseMonitoring(bool pause)
 {
-    if (m_monitorFilter) {
-        m_monitorFilter->set("disable", pause ? 1 : 0);
+    m_meterPaused = pause;
+    updateMeterState();
+}
+
+void MixerWidget::updateMeterState()
+{
+    if (m_meterTap) {
+        m_meterTap->setActive(m_meterConnected && !m_meterPaused);
     }
 }
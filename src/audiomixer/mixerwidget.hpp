@@ -23,12 +23,12 @@
 #define MIXERWIDGET_H
 
 #include "definitions.h"
+#include "meteringengine.hpp"
 #include "mlt++/MltService.h"
 
 #include <memory>
 #include <unordered_map>
 #include <QWidget>
-#include <QMutex>
 
 class KDualAction;
 class AudioLevelWidget;
@@ -42,7 +42,6 @@ class MixerManager;
 
 namespace Mlt {
     class Tractor;
-    class Event;
 }
 
 class MixerWidget : public QWidget
@@ -58,7 +57,6 @@ public:
     void reset();
     /** @brief discard stored audio values */
     void clear();
-    static void property_changed( mlt_service , MixerWidget *self, char *name );
     void setMute(bool mute);
     /** @brief Returns true if track is muted
      * */
@@ -66,7 +64,7 @@ public:
     /** @brief Uncheck the solo button
      * */
     void unSolo();
-    /** @brief Connect the mixer widgets to the correspondent filters */
+    /** @brief Start/stop metering, only visible meters analyse audio */
     void connectMixer(bool doConnect);
     /** @brief Disable/enable monitoring by disabling/enabling filter */
     void pauseMonitoring(bool pause);
@@ -85,15 +83,15 @@ protected:
     MixerManager *m_manager;
     int m_tid;
     std::shared_ptr<Mlt::Filter> m_levelFilter;
-    std::shared_ptr<Mlt::Filter> m_monitorFilter;
     std::shared_ptr<Mlt::Filter> m_balanceFilter;
-    QMap<int, QVector<double>> m_levels;
+    std::unique_ptr<MeterTap> m_meterTap;
+    MeterBallistics m_ballistics;
     int m_channels;
     KDualAction *m_muteAction;
     QSpinBox *m_balanceSpin;
     QSlider *m_balanceSlider;
     QDoubleSpinBox *m_volumeSpin;
-    int m_maxLevels;
+    double m_fps;
 
 private:
     std::shared_ptr<AudioLevelWidget> m_audioMeterWidget;
@@ -102,13 +100,14 @@ private:
     QToolButton *m_record;
     QToolButton *m_collapse;
     QLabel *m_trackLabel;
-    QMutex m_storeMutex;
     int m_lastVolume;
     QVector <double>m_audioData;
-    Mlt::Event *m_listener;
+    bool m_meterConnected;
+    bool m_meterPaused;
     bool m_recording;
     /** @Update track label to reflect state */
     void updateLabel();
+    void updateMeterState();
 
 signals:
     void gotLevels(QPair <double, double>);
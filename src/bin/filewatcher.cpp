@@ -20,28 +20,56 @@
  ***************************************************************************/
 
 #include "filewatcher.hpp"
+#include "projectclip.h"
 
 #include <QFileInfo>
+#include <QtConcurrent>
+
+// A folder is processed once it did not receive any notification for this delay
+static const int quietDelay = 1500;
+// ... or once its first pending notification is older than this
+static const int maxDelay = 10000;
 
 FileWatcher::FileWatcher(QObject *parent)
     : QObject(parent)
     , m_fileWatcher(new KDirWatch())
 {
     // Init clip modification tracker
-    m_modifiedTimer.setInterval(1500);
+    m_modifiedTimer.setInterval(500);
     connect(m_fileWatcher.get(), &KDirWatch::dirty, this, &FileWatcher::slotUrlModified);
     connect(m_fileWatcher.get(), &KDirWatch::deleted, this, &FileWatcher::slotUrlMissing);
     connect(m_fileWatcher.get(), &KDirWatch::created, this, &FileWatcher::slotUrlAdded);
     connect(&m_modifiedTimer, &QTimer::timeout, this, &FileWatcher::slotProcessModifiedUrls);
+    connect(&m_verification, &QFutureWatcher<std::pair<QString, Signature>>::finished, this, &FileWatcher::slotVerificationDone);
+}
+
+FileWatcher::~FileWatcher()
+{
+    m_verification.waitForFinished();
 }
 
-void FileWatcher::addFile(const QString &binId, const QString &url)
+void FileWatcher::addFile(const QString &binId, const QString &url, const QString &hash)
 {
     if (url.isEmpty()) {
         return;
     }
     if (m_occurences.count(url) == 0) {
-        m_fileWatcher->addFile(url);
+        QFileInfo info(url);
+        const QString folder = info.absolutePath();
+        if (m_folders.count(folder) == 0) {
+            // One watch for the whole folder, files are reported individually
+            m_fileWatcher->addDir(folder, KDirWatch::WatchFiles);
+        }
+        m_folders[folder].insert(url);
+        Signature sig;
+        if (info.exists()) {
+            sig.size = info.size();
+            sig.modified = info.lastModified();
+        }
+        sig.hash = hash;
+        m_signatures[url] = sig;
+    } else if (!hash.isEmpty()) {
+        m_signatures[url].hash = hash;
     }
     m_occurences[url].insert(binId);
     m_binClipPaths[binId] = url;
@@ -56,17 +84,40 @@ void FileWatcher::removeFile(const QString &binId)
     m_occurences[url].erase(binId);
     m_binClipPaths.erase(binId);
     if (m_occurences[url].empty()) {
-        m_fileWatcher->removeFile(url);
         m_occurences.erase(url);
+        m_signatures.erase(url);
+        m_waitingUrls.erase(url);
+        const QString folder = QFileInfo(url).absolutePath();
+        m_folders[folder].erase(url);
+        if (m_folders[folder].empty()) {
+            m_fileWatcher->removeDir(folder);
+            m_folders.erase(folder);
+            m_modifiedFolders.erase(folder);
+        } else if (m_modifiedFolders.count(folder) > 0) {
+            m_modifiedFolders[folder].urls.erase(url);
+        }
     }
 }
 
-void FileWatcher::slotUrlModified(const QString &path)
+void FileWatcher::queueChange(const QString &folder, const QString &url)
 {
-    if (m_modifiedUrls.count(path) == 0) {
-        m_modifiedUrls.insert(path);
-        for (const QString &id : m_occurences[path]) {
-            emit binClipWaiting(id);
+    bool newFolder = m_modifiedFolders.count(folder) == 0;
+    PendingFolder &pending = m_modifiedFolders[folder];
+    if (newFolder) {
+        pending.firstEvent.start();
+    }
+    pending.lastEvent.start();
+    if (url.isEmpty()) {
+        pending.allFiles = true;
+    } else if (pending.urls.insert(url).second) {
+        // Only announce the files we are sure to reload, an unchanged hash may still cancel the others
+        const Signature &sig = m_signatures[url];
+        QFileInfo info(url);
+        if (info.size() != sig.size || (sig.hash.isEmpty() && info.lastModified() != sig.modified)) {
+            m_waitingUrls.insert(url);
+            for (const QString &id : m_occurences[url]) {
+                emit binClipWaiting(id);
+            }
         }
     }
     if (!m_modifiedTimer.isActive()) {
@@ -74,44 +125,140 @@ void FileWatcher::slotUrlModified(const QString &path)
     }
 }
 
-void FileWatcher::slotUrlAdded(const QString &path)
+void FileWatcher::slotUrlModified(const QString &path)
 {
-    for (const QString &id : m_occurences[path]) {
-        emit binClipModified(id);
+    if (m_occurences.count(path) > 0) {
+        queueChange(QFileInfo(path).absolutePath(), path);
+    } else if (m_folders.count(path) > 0) {
+        // Some backends only report the folder
+        queueChange(path, QString());
     }
 }
 
+void FileWatcher::slotUrlAdded(const QString &path)
+{
+    // A file that reappears is verified like a modified one
+    slotUrlModified(path);
+}
+
 void FileWatcher::slotUrlMissing(const QString &path)
 {
-    for (const QString &id : m_occurences[path]) {
-        emit binClipMissing(id);
+    std::vector<QString> urls;
+    if (m_occurences.count(path) > 0) {
+        urls.push_back(path);
+    } else if (m_folders.count(path) > 0) {
+        urls.assign(m_folders[path].begin(), m_folders[path].end());
+    }
+    for (const QString &url : urls) {
+        m_signatures[url].size = -1;
+        for (const QString &id : m_occurences[url]) {
+            emit binClipMissing(id);
+        }
     }
 }
 
+std::pair<QString, FileWatcher::Signature> FileWatcher::verify(const std::pair<QString, Signature> &previous)
+{
+    Signature current;
+    QFileInfo info(previous.first);
+    if (!info.exists()) {
+        return {previous.first, current};
+    }
+    current.size = info.size();
+    current.modified = info.lastModified();
+    if (current.size == previous.second.size) {
+        if (current.modified == previous.second.modified) {
+            current.hash = previous.second.hash;
+        } else if (!previous.second.hash.isEmpty()) {
+            // Touched but maybe not modified, as done by sync tools
+            current.hash = QString(ProjectClip::calculateHash(previous.first).first.toHex());
+        }
+    }
+    return {previous.first, current};
+}
+
 void FileWatcher::slotProcessModifiedUrls()
 {
-    auto checkList = m_modifiedUrls;
-    for (const QString &path : checkList) {
-        if (m_fileWatcher->ctime(path).msecsTo(QDateTime::currentDateTime()) > 2000) {
-            for (const QString &id : m_occurences[path]) {
-                emit binClipModified(id);
+    if (m_verification.isRunning()) {
+        // Wait for the running check, we will be called again
+        return;
+    }
+    std::vector<std::pair<QString, Signature>> toCheck;
+    for (auto it = m_modifiedFolders.begin(); it != m_modifiedFolders.end();) {
+        const PendingFolder &pending = it->second;
+        if (pending.lastEvent.elapsed() < quietDelay && pending.firstEvent.elapsed() < maxDelay) {
+            // Still busy
+            ++it;
+            continue;
+        }
+        const std::unordered_set<QString> &urls = pending.allFiles ? m_folders[it->first] : pending.urls;
+        for (const QString &url : urls) {
+            if (m_signatures.count(url) > 0) {
+                toCheck.emplace_back(url, m_signatures.at(url));
             }
-            m_modifiedUrls.erase(path);
         }
+        it = m_modifiedFolders.erase(it);
     }
-    if (m_modifiedUrls.empty()) {
+    if (m_modifiedFolders.empty()) {
         m_modifiedTimer.stop();
     }
+    if (!toCheck.empty()) {
+        m_verification.setFuture(QtConcurrent::mapped(toCheck, &FileWatcher::verify));
+    }
+}
+
+void FileWatcher::slotVerificationDone()
+{
+    QStringList modified;
+    const QList<std::pair<QString, Signature>> results = m_verification.future().results();
+    for (const auto &result : results) {
+        const QString &url = result.first;
+        if (m_occurences.count(url) == 0) {
+            // Removed in the meantime
+            continue;
+        }
+        const Signature &current = result.second;
+        Signature &previous = m_signatures[url];
+        bool waiting = m_waitingUrls.erase(url) > 0;
+        if (current.size == -1) {
+            if (previous.size != -1) {
+                for (const QString &id : m_occurences[url]) {
+                    emit binClipMissing(id);
+                }
+            }
+        } else if (current.size != previous.size || (current.modified != previous.modified && (current.hash.isEmpty() || current.hash != previous.hash))) {
+            for (const QString &id : m_occurences[url]) {
+                modified << id;
+            }
+        } else if (waiting) {
+            // The file was only touched, or came back to its previous state
+            for (const QString &id : m_occurences[url]) {
+                emit binClipUnchanged(id);
+            }
+        }
+        previous = current;
+    }
+    if (!modified.isEmpty()) {
+        emit binClipsModified(modified);
+    }
+    if (!m_modifiedFolders.empty() && !m_modifiedTimer.isActive()) {
+        m_modifiedTimer.start();
+    }
 }
 
 void FileWatcher::clear()
 {
+    m_verification.waitForFinished();
     m_fileWatcher->stopScan();
-    for (const auto &f : m_occurences) {
-        m_fileWatcher->removeFile(f.first);
+    for (const auto &f : m_folders) {
+        m_fileWatcher->removeDir(f.first);
     }
     m_occurences.clear();
-    m_modifiedUrls.clear();
+    m_waitingUrls.clear();
+    m_modifiedFolders.clear();
     m_binClipPaths.clear();
+    m_folders.clear();
+    m_signatures.clear();
+    m_modifiedTimer.stop();
     m_fileWatcher->startScan();
 }
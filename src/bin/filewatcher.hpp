@@ -24,12 +24,19 @@
 
 #include "definitions.h"
 #include <KDirWatch>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
 #include <QTimer>
 #include <unordered_map>
 #include <unordered_set>
 
 /** @brief This class is responsible for watching all files used in the project
     and triggers a reload notification when a file changes.
+    Folders are watched instead of individual files so that a folder with many clips only costs one watch.
+    Change events are queued per folder and processed once the folder has been quiet for a moment. The queued files
+    are then compared with their last known size, modification time and hash in a background thread, and all
+    the clips whose content really changed are reloaded at once.
  */
 
 class FileWatcher : public QObject
@@ -39,19 +46,32 @@ class FileWatcher : public QObject
 public:
     // Constructor
     explicit FileWatcher(QObject *parent = nullptr);
-    // Add a file to the list of watched items
-    void addFile(const QString &binId, const QString &url);
+    ~FileWatcher() override;
+    /** @brief Add a file to the list of watched items
+     *  @param hash the hash of the file as calculated by ProjectClip::calculateHash(), used to detect modifications that don't change the content
+     */
+    void addFile(const QString &binId, const QString &url, const QString &hash = QString());
     // Remove a binId from the list of watched items
     void removeFile(const QString &binId);
     // Reset all watched files
     void clear();
 
+    /** @brief What we know about the content of a watched file */
+    struct Signature
+    {
+        qint64 size = -1;
+        QDateTime modified;
+        QString hash;
+    };
+
 signals:
-    /** @brief This signal is triggered whenever the file corresponding to a bin clip has been modified and should be reloaded. Note that this signal is sent no
-     * more than every 1500 ms. We also make sure that at least 1000ms has passed since the last modification of the file. */
-    void binClipModified(const QString &binId);
-    /** @brief Same signal than binClipModified, but triggers immediately. Can be useful to refresh UI without actually reloading the file (yet)*/
+    /** @brief This signal is triggered with all the bin clips whose file was modified and should be reloaded. It is sent once the folders containing
+     * the files have not received any change notification for 1500 ms. */
+    void binClipsModified(const QStringList &binIds);
+    /** @brief Triggers as soon as we know a file has changed. Can be useful to refresh UI without actually reloading the file (yet)*/
     void binClipWaiting(const QString &binId);
+    /** @brief A clip announced by binClipWaiting() turned out to be unchanged, it does not need to be reloaded */
+    void binClipUnchanged(const QString &binId);
     void binClipMissing(const QString &binId);
 
 private slots:
@@ -59,6 +79,7 @@ private slots:
     void slotUrlMissing(const QString &path);
     void slotUrlAdded(const QString &path);
     void slotProcessModifiedUrls();
+    void slotVerificationDone();
 
 private:
     // This is a handle to the watcher singleton, not owned by this class.
@@ -67,11 +88,32 @@ private:
     std::unordered_map<QString, std::unordered_set<QString>> m_occurences;
     // keys are binId, keys are stored paths
     std::unordered_map<QString, QString> m_binClipPaths;
+    // keys are the watched folders, values the watched urls they contain
+    std::unordered_map<QString, std::unordered_set<QString>> m_folders;
+    // Last known state of each watched url
+    std::unordered_map<QString, Signature> m_signatures;
+    // Urls whose clips were announced with binClipWaiting, until they are verified
+    std::unordered_set<QString> m_waitingUrls;
 
-    // List of files for which we received an update since the last send
-    std::unordered_set<QString> m_modifiedUrls;
+    struct PendingFolder
+    {
+        // The modified urls in this folder
+        std::unordered_set<QString> urls;
+        // The folder itself changed, check all the urls it contains
+        bool allFiles = false;
+        QElapsedTimer firstEvent;
+        QElapsedTimer lastEvent;
+    };
+    // Folders for which we received an update since the last check
+    std::unordered_map<QString, PendingFolder> m_modifiedFolders;
 
     QTimer m_modifiedTimer;
+    QFutureWatcher<std::pair<QString, Signature>> m_verification;
+
+    /** @brief Queue a change notification for @param folder, @param url is the modified file or empty if the folder itself changed */
+    void queueChange(const QString &folder, const QString &url);
+    /** @brief Runs in a worker thread, returns the current signature of a file, only hashing it when size and modification time cannot tell */
+    static std::pair<QString, Signature> verify(const std::pair<QString, Signature> &previous);
 };
 
 #endif
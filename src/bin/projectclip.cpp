@@ -58,6 +58,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <KMessageBox>
 #include <QApplication>
 #include <QCryptographicHash>
+#include <QDateTime>
 #include <QDir>
 #include <QDomElement>
 #include <QFile>
@@ -371,6 +372,7 @@ void ProjectClip::reloadProducer(bool refreshOnly, bool isProxy, bool forceAudio
         ThumbnailCache::get()->invalidateThumbsForClip(clipId());
         pCore->jobManager()->discardJobs(clipId(), AbstractClipJob::THUMBJOB);
         m_thumbsProducer.reset();
+        m_keyframeThumbsProducer.reset();
         emit pCore->jobManager()->startJob<ThumbJob>({clipId()}, loadjobId, QString(), -1, true, true);
     } else {
         // If another load job is running?
@@ -384,6 +386,7 @@ void ProjectClip::reloadProducer(bool refreshOnly, bool isProxy, bool forceAudio
             bool hashChanged = false;
             pCore->jobManager()->discardJobs(clipId(), AbstractClipJob::THUMBJOB);
             m_thumbsProducer.reset();
+            m_keyframeThumbsProducer.reset();
             ClipType::ProducerType type = clipType();
             if (type != ClipType::Color && type != ClipType::Image && type != ClipType::SlideShow) {
                 xml.removeAttribute("out");
@@ -484,6 +487,7 @@ bool ProjectClip::setProducer(std::shared_ptr<Mlt::Producer> producer, bool repl
     updateProducer(producer);
     emit producerChanged(m_binId, producer);
     m_thumbsProducer.reset();
+    m_keyframeThumbsProducer.reset();
     connectEffectStack();
 
     // Update info
@@ -627,6 +631,49 @@ std::shared_ptr<Mlt::Producer> ProjectClip::thumbProducer()
     return m_thumbsProducer;
 }
 
+QMutex *ProjectClip::thumbSeekMutex()
+{
+    return &m_thumbSeekMutex;
+}
+
+std::shared_ptr<Mlt::Producer> ProjectClip::keyframeThumbProducer()
+{
+    if (m_keyframeThumbsProducer) {
+        return m_keyframeThumbsProducer;
+    }
+    if ((clipType() != ClipType::AV && clipType() != ClipType::Video) || KdenliveSettings::gpu_accel()) {
+        return thumbProducer();
+    }
+    m_thumbMutex.lock();
+    std::shared_ptr<Mlt::Producer> prod = originalProducer();
+    QString mltService = m_masterProducer->get("mlt_service");
+    if (!prod->is_valid() || !mltService.startsWith(QLatin1String("avformat"))) {
+        m_thumbMutex.unlock();
+        return thumbProducer();
+    }
+    const QString mltResource = m_masterProducer->get("resource");
+    m_keyframeThumbsProducer.reset(new Mlt::Producer(*pCore->thumbProfile(), "avformat-novalidate", mltResource.toUtf8().constData()));
+    if (m_keyframeThumbsProducer->is_valid()) {
+        Mlt::Properties original(m_masterProducer->get_properties());
+        Mlt::Properties cloneProps(m_keyframeThumbsProducer->get_properties());
+        cloneProps.pass_list(original, ClipController::getPassPropertiesList());
+        // These are passed to the decoder: only output keyframes and skip the loop filter,
+        // so a seek stops at the next keyframe instead of decoding the whole GOP
+        m_keyframeThumbsProducer->set("skip_frame", "nokey");
+        m_keyframeThumbsProducer->set("skip_loop_filter", "all");
+        Mlt::Filter scaler(*pCore->thumbProfile(), "swscale");
+        Mlt::Filter padder(*pCore->thumbProfile(), "resize");
+        Mlt::Filter converter(*pCore->thumbProfile(), "avcolor_space");
+        m_keyframeThumbsProducer->set("audio_index", -1);
+        m_keyframeThumbsProducer->set("out", m_keyframeThumbsProducer->get_length() -1);
+        m_keyframeThumbsProducer->attach(scaler);
+        m_keyframeThumbsProducer->attach(padder);
+        m_keyframeThumbsProducer->attach(converter);
+    }
+    m_thumbMutex.unlock();
+    return m_keyframeThumbsProducer;
+}
+
 void ProjectClip::createDisabledMasterProducer()
 {
     if (!m_disabledProducer) {
@@ -1077,9 +1124,12 @@ const QString ProjectClip::getFileHash()
         fileHash = QCryptographicHash::hash(fileData, QCryptographicHash::Md5);
         break;
     default:
+        // Read the modification time before hashing, so that a file modified while hashing is checked again on next opening
+        const qint64 modified = QFileInfo(clipUrl()).lastModified().toMSecsSinceEpoch();
         QPair<QByteArray, qint64> hashData = calculateHash(clipUrl());
         fileHash = hashData.first;
         ClipController::setProducerProperty(QStringLiteral("kdenlive:file_size"), QString::number(hashData.second));
+        ClipController::setProducerProperty(QStringLiteral("kdenlive:file_modified"), QString::number(modified));
         break;
     }
     if (fileHash.isEmpty()) {
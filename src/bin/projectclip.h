@@ -148,6 +148,12 @@ public:
 
     /** @brief Returns this clip's producer. */
     std::shared_ptr<Mlt::Producer> thumbProducer() override;
+    /** @brief Returns a thumb producer that only decodes keyframes, seeking returns the next keyframe.
+     *  Falls back to thumbProducer() for clips not handled by avformat. */
+    std::shared_ptr<Mlt::Producer> keyframeThumbProducer();
+    /** @brief Returns the lock to hold while seeking and reading frames from thumbProducer() or keyframeThumbProducer().
+     *  Both are shared by the timeline thumbnail provider, the thumbnail prefetcher and the thumbnail jobs. */
+    QMutex *thumbSeekMutex();
 
     /** @brief Recursively disable/enable bin effects. */
     void setBinEffectsEnabled(bool enabled) override;
@@ -289,6 +295,8 @@ private:
     const QString getFileHash();
     QMutex m_producerMutex;
     QMutex m_thumbMutex;
+    QMutex m_thumbSeekMutex;
+    std::shared_ptr<Mlt::Producer> m_keyframeThumbsProducer;
     QFuture<void> m_thumbThread;
     QList<int> m_requestedThumbs;
     const QString geometryWithOffset(const QString &data, int offset);
@@ -63,8 +63,9 @@ ProjectItemModel::ProjectItemModel(QObject *parent)
     QPixmap pix(QSize(160, 90));
     pix.fill(Qt::lightGray);
     m_blankThumb.addPixmap(pix);
-    connect(m_fileWatcher.get(), &FileWatcher::binClipModified, this, &ProjectItemModel::reloadClip);
+    connect(m_fileWatcher.get(), &FileWatcher::binClipsModified, this, &ProjectItemModel::reloadClips);
     connect(m_fileWatcher.get(), &FileWatcher::binClipWaiting, this, &ProjectItemModel::setClipWaiting);
+    connect(m_fileWatcher.get(), &FileWatcher::binClipUnchanged, this, &ProjectItemModel::resetClipWaiting);
     connect(m_fileWatcher.get(), &FileWatcher::binClipMissing, this, &ProjectItemModel::setClipInvalid);
 }
 
@@ -1081,6 +1082,17 @@ void ProjectItemModel::reloadClip(const QString &binId)
     }
 }
 
+void ProjectItemModel::reloadClips(const QStringList &binIds)
+{
+    QWriteLocker locker(&m_lock);
+    for (const QString &binId : binIds) {
+        std::shared_ptr<ProjectClip> clip = getClipByBinID(binId);
+        if (clip) {
+            clip->reloadProducer();
+        }
+    }
+}
+
 void ProjectItemModel::setClipWaiting(const QString &binId)
 {
     QWriteLocker locker(&m_lock);
@@ -1090,6 +1102,15 @@ void ProjectItemModel::setClipWaiting(const QString &binId)
     }
 }
 
+void ProjectItemModel::resetClipWaiting(const QString &binId)
+{
+    QWriteLocker locker(&m_lock);
+    std::shared_ptr<ProjectClip> clip = getClipByBinID(binId);
+    if (clip && clip->clipStatus() == FileStatus::StatusWaiting) {
+        clip->setClipStatus(clip->hasProxy() ? FileStatus::StatusProxy : FileStatus::StatusReady);
+    }
+}
+
 void ProjectItemModel::setClipInvalid(const QString &binId)
 {
     QWriteLocker locker(&m_lock);
@@ -1109,7 +1130,9 @@ void ProjectItemModel::updateWatcher(const std::shared_ptr<ProjectClip> &clipIte
         QFileInfo check_file(clipItem->clipUrl());
         // check if file exists and if yes: Is it really a file and no directory?
         if ((check_file.exists() && check_file.isFile()) || clipItem->clipStatus() == FileStatus::StatusMissing) {
-            m_fileWatcher->addFile(clipItem->clipId(), clipItem->clipUrl());
+            // Text templates are hashed on their content, not their file
+            const QString hash = clipItem->clipType() == ClipType::TextTemplate ? QString() : clipItem->getProducerProperty(QStringLiteral("kdenlive:file_hash"));
+            m_fileWatcher->addFile(clipItem->clipId(), clipItem->clipUrl(), hash);
         }
     }
 }
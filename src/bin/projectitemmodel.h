@@ -201,9 +201,13 @@ public:
 
     /** @brief Request that the producer of a given clip is reloaded */
     void reloadClip(const QString &binId);
+    /** @brief Request that the producers of several clips are reloaded, their load jobs run in parallel */
+    void reloadClips(const QStringList &binIds);
 
     /** @brief Set the status of the clip to "waiting". This happens when the corresponding file has changed*/
     void setClipWaiting(const QString &binId);
+    /** @brief Restore the status of a clip that was waiting for a file change which did not happen */
+    void resetClipWaiting(const QString &binId);
     void setClipInvalid(const QString &binId);
 
     /** @brief Returns true if current project has a clip with id @clipId and a hash of @clipHash */
@@ -30,6 +30,9 @@ the Free Software Foundation, either version 3 of the License, or
 #include "timeline2/view/timelinecontroller.h"
 #include "timeline2/view/timelinewidget.h"
 #include "dialogs/subtitleedit.h"
+#include "effects/effectsrepository.hpp"
+#include "transitions/transitionsrepository.hpp"
+#include "utils/startupprofiler.hpp"
 #include <mlt++/MltRepository.h>
 
 #include <KMessageBox>
@@ -37,6 +40,7 @@ the Free Software Foundation, either version 3 of the License, or
 #include <QInputDialog>
 #include <QDir>
 #include <QQuickStyle>
+#include <QTimer>
 #include <locale>
 #ifdef Q_OS_MAC
 #include <xlocale.h>
@@ -90,19 +94,28 @@ void Core::build(bool isAppImage, const QString &MltPath)
     qRegisterMetaType<QDomElement>("QDomElement");
     qRegisterMetaType<requestClipInfo>("requestClipInfo");
 
-    if (isAppImage) {
-        QString appPath = qApp->applicationDirPath();
-        KdenliveSettings::setFfmpegpath(QDir::cleanPath(appPath + QStringLiteral("/ffmpeg")));
-        KdenliveSettings::setFfplaypath(QDir::cleanPath(appPath + QStringLiteral("/ffplay")));
-        KdenliveSettings::setFfprobepath(QDir::cleanPath(appPath + QStringLiteral("/ffprobe")));
-        KdenliveSettings::setRendererpath(QDir::cleanPath(appPath + QStringLiteral("/melt")));
-        MltConnection::construct(QDir::cleanPath(appPath + QStringLiteral("/../share/mlt/profiles")));
-    } else {
-        // Open connection with Mlt
-        MltConnection::construct(MltPath);
+    {
+        StartupProfiler::Phase phase(QStringLiteral("MLT connection"));
+        if (isAppImage) {
+            QString appPath = qApp->applicationDirPath();
+            KdenliveSettings::setFfmpegpath(QDir::cleanPath(appPath + QStringLiteral("/ffmpeg")));
+            KdenliveSettings::setFfplaypath(QDir::cleanPath(appPath + QStringLiteral("/ffplay")));
+            KdenliveSettings::setFfprobepath(QDir::cleanPath(appPath + QStringLiteral("/ffprobe")));
+            KdenliveSettings::setRendererpath(QDir::cleanPath(appPath + QStringLiteral("/melt")));
+            MltConnection::construct(QDir::cleanPath(appPath + QStringLiteral("/../share/mlt/profiles")));
+        } else {
+            // Open connection with Mlt
+            MltConnection::construct(MltPath);
+        }
     }
 
+    // MLT is not thread safe, so the effect and transition repositories are built in the GUI thread when first used.
+    // Only their catalog caches are read from disk meanwhile.
+    EffectsRepository::prefetch();
+    TransitionsRepository::prefetch();
+
     // load the profile from disk
+    StartupProfiler::Phase phase(QStringLiteral("Profiles and project model"));
     ProfileRepository::get()->refresh();
     // load default profile
     m_self->m_profile = KdenliveSettings::default_profile();
@@ -123,11 +136,15 @@ void Core::build(bool isAppImage, const QString &MltPath)
 
 void Core::initGUI(const QUrl &Url, const QString &clipsToLoad)
 {
+    StartupProfiler::Phase guiPhase(QStringLiteral("GUI setup"));
     m_profile = KdenliveSettings::default_profile();
     m_currentProfile = m_profile;
     profileChanged();
     m_mainWindow = new MainWindow();
     m_guiConstructed = true;
+    // The asset lists are built by now, messages about removed favorites can reach the status bar
+    EffectsRepository::get()->checkFavorites();
+    TransitionsRepository::get()->checkFavorites();
     QStringList styles = QQuickStyle::availableStyles();
     if (styles.contains(QLatin1String("org.kde.desktop"))) {
         QQuickStyle::setStyle("org.kde.desktop");
@@ -177,16 +194,22 @@ void Core::initGUI(const QUrl &Url, const QString &clipsToLoad)
         profileChanged();
     }
 
-    m_projectManager = new ProjectManager(this);
-    m_binWidget = new Bin(m_projectItemModel, m_mainWindow);
-    m_library = new LibraryWidget(m_projectManager, m_mainWindow);
-    m_subtitleWidget = new SubtitleEdit(m_mainWindow);
-    m_mixerWidget = new MixerManager(m_mainWindow);
+    {
+        StartupProfiler::Phase phase(QStringLiteral("Bin, library, subtitles and mixer"));
+        m_projectManager = new ProjectManager(this);
+        m_binWidget = new Bin(m_projectItemModel, m_mainWindow);
+        m_library = new LibraryWidget(m_projectManager, m_mainWindow);
+        m_subtitleWidget = new SubtitleEdit(m_mainWindow);
+        m_mixerWidget = new MixerManager(m_mainWindow);
+    }
     connect(m_library, SIGNAL(addProjectClips(QList<QUrl>)), m_binWidget, SLOT(droppedUrls(QList<QUrl>)));
     connect(this, &Core::updateLibraryPath, m_library, &LibraryWidget::slotUpdateLibraryPath);
     connect(m_capture.get(), &MediaCapture::recordStateChanged, m_mixerWidget, &MixerManager::recordStateChanged);
     connect(m_mixerWidget, &MixerManager::updateRecVolume, m_capture.get(), &MediaCapture::setAudioVolume);
-    m_monitorManager = new MonitorManager(this);
+    {
+        StartupProfiler::Phase phase(QStringLiteral("Monitor manager"));
+        m_monitorManager = new MonitorManager(this);
+    }
     connect(m_monitorManager, &MonitorManager::cleanMixer, m_mixerWidget, &MixerManager::clearMixers);
     connect(m_subtitleWidget, &SubtitleEdit::addSubtitle, [this]() {
         if (m_guiConstructed && m_mainWindow->getCurrentTimeline()->controller()) {
@@ -213,11 +236,17 @@ void Core::initGUI(const QUrl &Url, const QString &clipsToLoad)
     // TODO
     connect(m_producerQueue, SIGNAL(removeInvalidProxy(QString,bool)), m_binWidget, SLOT(slotRemoveInvalidProxy(QString,bool)));*/
 
-    m_mainWindow->init();
+    {
+        StartupProfiler::Phase phase(QStringLiteral("Main window"));
+        m_mainWindow->init();
+    }
     if (!Url.isEmpty()) {
         emit loadingMessageUpdated(i18n("Loading project..."));
     }
-    projectManager()->init(Url, clipsToLoad);
+    {
+        StartupProfiler::Phase phase(QStringLiteral("Project manager"));
+        projectManager()->init(Url, clipsToLoad);
+    }
     if (qApp->isSessionRestored()) {
         // NOTE: we are restoring only one window, because Kdenlive only uses one MainWindow
         m_mainWindow->restore(1, false);
@@ -225,6 +254,8 @@ void Core::initGUI(const QUrl &Url, const QString &clipsToLoad)
     QMetaObject::invokeMethod(pCore->projectManager(), "slotLoadOnOpen", Qt::QueuedConnection);
     m_mainWindow->show();
     QThreadPool::globalInstance()->setMaxThreadCount(qMin(4, QThreadPool::globalInstance()->maxThreadCount()));
+    // Posted after the project opening, so this runs once the window is shown and the project loaded
+    QTimer::singleShot(0, this, []() { StartupProfiler::finish(); });
 }
 
 void Core::buildLumaThumbs(const QStringList &values)
@@ -743,6 +774,12 @@ void Core::invalidateRange(QPair<int, int> range)
     m_mainWindow->getCurrentTimeline()->controller()->invalidateZone(range.first, range.second);
 }
 
+void Core::invalidateTrackVisibility(int trackId)
+{
+    if (!m_guiConstructed || !m_mainWindow->getCurrentTimeline() || m_mainWindow->getCurrentTimeline()->loading) return;
+    m_mainWindow->getCurrentTimeline()->controller()->invalidateTrack(trackId, true);
+}
+
 void Core::invalidateItem(ObjectId itemId)
 {
     if (!m_guiConstructed || !m_mainWindow->getCurrentTimeline() || m_mainWindow->getCurrentTimeline()->loading) return;
@@ -186,6 +186,8 @@ public:
     double getClipSpeed(int id) const;
     /** @brief Mark an item as invalid for timeline preview */
     void invalidateItem(ObjectId itemId);
+    /** @brief A track was hidden or shown, invalidate timeline preview where it can be seen */
+    void invalidateTrackVisibility(int trackId);
     void invalidateRange(QPair<int, int>range);
     void prepareShutdown();
     /** the keyframe model changed (effect added, deleted, active effect changed), inform timeline */
@@ -24,6 +24,8 @@
 #include "kthumb.h"
 #include "titler/titlewidget.h"
 #include "bin/projectclip.h"
+#include "mediaindex.h"
+#include "projectsidecar.h"
 
 #include <KMessageBox>
 #include <KRecentDirs>
@@ -32,11 +34,16 @@
 
 #include "kdenlive_debug.h"
 #include <QCryptographicHash>
+#include <QEventLoop>
 #include <QFile>
 #include <QFileDialog>
 #include <QFontDatabase>
+#include <QFutureWatcher>
+#include <QSet>
 #include <QStandardPaths>
+#include <QTimer>
 #include <QTreeWidgetItem>
+#include <QtConcurrent>
 #include <utility>
 #include <kurlrequester.h>
 
@@ -60,9 +67,10 @@ const int LUMAPLACEHOLDER = 12;
 
 enum MISSINGTYPE { TITLE_IMAGE_ELEMENT = 20, TITLE_FONT_ELEMENT = 21 };
 
-DocumentChecker::DocumentChecker(QUrl url, const QDomDocument &doc)
+DocumentChecker::DocumentChecker(QUrl url, const QDomDocument &doc, const ProjectSidecar *sidecar)
     : m_url(std::move(url))
     , m_doc(doc)
+    , m_sidecar(sidecar)
     , m_dialog(nullptr)
     , m_abortSearch(false)
     , m_checkRunning(false)
@@ -336,16 +344,25 @@ bool DocumentChecker::hasErrorInClips()
         } else if (service.startsWith(QLatin1String("avformat")) || slideshow) {
             // Check if file changed
             const QByteArray hash = Xml::getXmlProperty(e, "kdenlive:file_hash").toLatin1();
-            if (!hash.isEmpty()) {
-                const QByteArray fileData = slideshow ? ProjectClip::getFolderHash(QDir(resource), slidePattern).toHex() : ProjectClip::calculateHash(resource).first.toHex();
-                if (hash != fileData) {
-                    // For slideshow clips, silently upgrade hash
-                    if (slideshow) {
+            if (!hash.isEmpty() && (slideshow || m_sidecar == nullptr || !m_sidecar->isUnchanged(resource, hash))) {
+                if (slideshow) {
+                    const QByteArray fileData = ProjectClip::getFolderHash(QDir(resource), slidePattern).toHex();
+                    if (hash != fileData) {
+                        // Silently upgrade hash
                         Xml::setXmlProperty(e, "kdenlive:file_hash", fileData);
-                    } else {
+                    }
+                } else {
+                    // Read the modification time before hashing, like ProjectClip::getFileHash
+                    const qint64 modified = QFileInfo(resource).lastModified().toMSecsSinceEpoch();
+                    const QPair<QByteArray, qint64> hashData = ProjectClip::calculateHash(resource);
+                    if (hash != hashData.first.toHex()) {
                         // Clip was changed, notify and trigger clip reload
                         Xml::removeXmlProperty(e, "kdenlive:file_hash");
                         m_changedClips.append(resource);
+                    } else {
+                        // Remember what the verified file looked like for the project sidecar
+                        Xml::setXmlProperty(e, "kdenlive:file_size", QString::number(hashData.second));
+                        Xml::setXmlProperty(e, "kdenlive:file_modified", QString::number(modified));
                     }
                 }
             }
@@ -846,16 +863,89 @@ void DocumentChecker::slotSearchClips(const QString &newpath)
     QTreeWidgetItem *child = m_ui.treeWidget->topLevelItem(ix);
     QDir searchDir(newpath);
     QDomNodeList producers = m_doc.elementsByTagName(QStringLiteral("producer"));
+    // Collect all missing files first so that the folder is walked once and each candidate file is hashed once
+    QList<QPair<qint64, QString>> hashRequests;
+    QSet<QString> hashKeys;
+    QStringList nameRequests;
+    auto addRequest = [&hashRequests, &hashKeys, &nameRequests](QTreeWidgetItem *item) {
+        const QString matchSize = item->data(0, sizeRole).toString();
+        const QString matchHash = item->data(0, hashRole).toString();
+        if (matchSize.isEmpty() && matchHash.isEmpty()) {
+            nameRequests << QUrl::fromLocalFile(item->text(1)).fileName();
+            return;
+        }
+        const QString key = MediaIndex::requestKey(matchSize.toLongLong(), matchHash);
+        if (!hashKeys.contains(key)) {
+            hashKeys.insert(key);
+            hashRequests << qMakePair(matchSize.toLongLong(), matchHash);
+        }
+    };
+    while (child != nullptr) {
+        int status = child->data(0, statusRole).toInt();
+        if (status == SOURCEMISSING) {
+            for (int j = 0; j < child->childCount(); ++j) {
+                addRequest(child->child(j));
+            }
+        } else if (status == CLIPMISSING && child->data(0, clipTypeRole).toInt() != ClipType::SlideShow) {
+            addRequest(child);
+        } else if (child->data(0, typeRole).toInt() == TITLE_IMAGE_ELEMENT && status == CLIPPLACEHOLDER) {
+            nameRequests << QUrl::fromLocalFile(child->text(1)).fileName();
+        }
+        ix++;
+        child = m_ui.treeWidget->topLevelItem(ix);
+    }
+    MediaIndex index(newpath);
+    QHash<QString, QString> found;
+    if (!hashRequests.isEmpty() || !nameRequests.isEmpty()) {
+        QFuture<void> future = QtConcurrent::run([&index, &found, &hashRequests, &nameRequests]() {
+            // Reuse the index of a previous search in this folder, only walk it again if something is still missing
+            bool complete = false;
+            if (index.load()) {
+                found = index.findByHash(hashRequests);
+                complete = found.count() == hashRequests.count();
+                for (int i = 0; complete && i < nameRequests.count(); ++i) {
+                    complete = !index.findByName(nameRequests.at(i)).isEmpty();
+                }
+            }
+            if (!complete && !index.isCancelled() && index.scan()) {
+                index.save();
+                found = index.findByHash(hashRequests);
+            }
+        });
+        QFutureWatcher<void> watcher;
+        QEventLoop loop;
+        connect(&watcher, &QFutureWatcher<void>::finished, &loop, &QEventLoop::quit);
+        QTimer progress;
+        progress.setInterval(200);
+        connect(&progress, &QTimer::timeout, this, [this, &index]() {
+            if (m_abortSearch) {
+                index.cancel();
+            }
+            emit showScanning(i18n("Scanning: %1 folders, %2 files indexed, %3 files compared", index.scannedFolders(), index.indexedFiles(),
+                                   index.hashedFiles()));
+        });
+        watcher.setFuture(future);
+        progress.start();
+        loop.exec();
+        progress.stop();
+    }
+    ix = 0;
+    child = m_ui.treeWidget->topLevelItem(ix);
     while (child != nullptr) {
         if (m_abortSearch) {
             break;
         }
-        qApp->processEvents();
         if (child->data(0, statusRole).toInt() == SOURCEMISSING) {
             for (int j = 0; j < child->childCount(); ++j) {
                 QTreeWidgetItem *subchild = child->child(j);
-                QString clipPath =
-                    searchFileRecursively(searchDir, subchild->data(0, sizeRole).toString(), subchild->data(0, hashRole).toString(), subchild->text(1));
+                QString clipPath;
+                const QString matchSize = subchild->data(0, sizeRole).toString();
+                const QString matchHash = subchild->data(0, hashRole).toString();
+                if (matchSize.isEmpty() && matchHash.isEmpty()) {
+                    clipPath = index.findByName(QUrl::fromLocalFile(subchild->text(1)).fileName());
+                } else {
+                    clipPath = found.value(MediaIndex::requestKey(matchSize.toLongLong(), matchHash));
+                }
                 if (!clipPath.isEmpty()) {
                     fixed = true;
                     subchild->setText(1, clipPath);
@@ -873,14 +963,19 @@ void DocumentChecker::slotSearchClips(const QString &newpath)
             QString clipPath;
             if (type != ClipType::SlideShow) {
                 // Slideshows cannot be found with hash / size
-                clipPath = searchFileRecursively(searchDir, child->data(0, sizeRole).toString(), child->data(0, hashRole).toString(), child->text(1));
+                const QString matchSize = child->data(0, sizeRole).toString();
+                const QString matchHash = child->data(0, hashRole).toString();
+                if (!matchSize.isEmpty() || !matchHash.isEmpty()) {
+                    clipPath = found.value(MediaIndex::requestKey(matchSize.toLongLong(), matchHash));
+                }
+                if (clipPath.isEmpty()) {
+                    clipPath = index.findByName(QUrl::fromLocalFile(child->text(1)).fileName());
+                    perfectMatch = matchSize.isEmpty() && matchHash.isEmpty();
+                }
             } else {
+                qApp->processEvents();
                 clipPath = searchDirRecursively(searchDir, child->data(0, hashRole).toString(), child->text(1));
             }
-            if (clipPath.isEmpty() && type != ClipType::SlideShow) {
-                clipPath = searchPathRecursively(searchDir, QUrl::fromLocalFile(child->text(1)).fileName(), type);
-                perfectMatch = false;
-            }
             if (!clipPath.isEmpty()) {
                 fixed = true;
                 child->setText(1, clipPath);
@@ -900,7 +995,7 @@ void DocumentChecker::slotSearchClips(const QString &newpath)
         } else if (child->data(0, typeRole).toInt() == TITLE_IMAGE_ELEMENT && child->data(0, statusRole).toInt() == CLIPPLACEHOLDER) {
             // Search missing title images
             QString missingFileName = QUrl::fromLocalFile(child->text(1)).fileName();
-            QString newPath = searchPathRecursively(searchDir, missingFileName);
+            QString newPath = index.findByName(missingFileName);
             if (!newPath.isEmpty()) {
                 // File found
                 fixed = true;
@@ -1056,54 +1151,6 @@ QString DocumentChecker::searchDirRecursively(const QDir &dir, const QString &ma
 }
 
 
-QString DocumentChecker::searchFileRecursively(const QDir &dir, const QString &matchSize, const QString &matchHash, const QString &fileName)
-{
-    if (matchSize.isEmpty() && matchHash.isEmpty()) {
-        return searchPathRecursively(dir, QUrl::fromLocalFile(fileName).fileName());
-    }
-    QString foundFileName;
-    QByteArray fileData;
-    QByteArray fileHash;
-    QStringList filesAndDirs = dir.entryList(QDir::Files | QDir::Readable);
-    for (int i = 0; i < filesAndDirs.size() && foundFileName.isEmpty(); ++i) {
-        qApp->processEvents();
-        if (m_abortSearch) {
-            return QString();
-        }
-        QFile file(dir.absoluteFilePath(filesAndDirs.at(i)));
-        if (QString::number(file.size()) == matchSize) {
-            if (file.open(QIODevice::ReadOnly)) {
-                /*
-                 * 1 MB = 1 second per 450 files (or faster)
-                 * 10 MB = 9 seconds per 450 files (or faster)
-                 */
-                if (file.size() > 1000000 * 2) {
-                    fileData = file.read(1000000);
-                    if (file.seek(file.size() - 1000000)) {
-                        fileData.append(file.readAll());
-                    }
-                } else {
-                    fileData = file.readAll();
-                }
-                file.close();
-                fileHash = QCryptographicHash::hash(fileData, QCryptographicHash::Md5);
-                if (QString::fromLatin1(fileHash.toHex()) == matchHash) {
-                    return file.fileName();
-                }
-            }
-        }
-        ////qCDebug(KDENLIVE_LOG) << filesAndDirs.at(i) << file.size() << fileHash.toHex();
-    }
-    filesAndDirs = dir.entryList(QDir::Dirs | QDir::Readable | QDir::Executable | QDir::NoDotAndDotDot);
-    for (int i = 0; i < filesAndDirs.size() && foundFileName.isEmpty(); ++i) {
-        foundFileName = searchFileRecursively(dir.absoluteFilePath(filesAndDirs.at(i)), matchSize, matchHash, fileName);
-        if (!foundFileName.isEmpty()) {
-            break;
-        }
-    }
-    return foundFileName;
-}
-
 void DocumentChecker::slotEditItem(QTreeWidgetItem *item, int)
 {
     if (!item) {
@@ -27,12 +27,15 @@
 #include <QDomElement>
 #include <QUrl>
 
+class ProjectSidecar;
+
 class DocumentChecker : public QObject
 {
     Q_OBJECT
 
 public:
-    explicit DocumentChecker(QUrl url, const QDomDocument &doc);
+    /** @param sidecar if not null, source clips that did not change since the sidecar was written are not hashed again */
+    explicit DocumentChecker(QUrl url, const QDomDocument &doc, const ProjectSidecar *sidecar = nullptr);
     ~DocumentChecker() override;
     /**
      * @brief checks for problems with the clips in the project
@@ -61,11 +64,11 @@ private slots:
 private:
     QUrl m_url;
     QDomDocument m_doc;
+    const ProjectSidecar *m_sidecar;
     Ui::MissingClips_UI m_ui;
     QDialog *m_dialog;
     QPair<QString, QString> m_rootReplacement;
     QString searchPathRecursively(const QDir &dir, const QString &fileName, ClipType::ProducerType type = ClipType::Unknown);
-    QString searchFileRecursively(const QDir &dir, const QString &matchSize, const QString &matchHash, const QString &fileName);
     QString searchDirRecursively(const QDir &dir, const QString &matchHash, const QString &fullName);
     void checkStatus();
     QMap<QString, QString> m_missingTitleImages;
@@ -30,9 +30,12 @@
 #include "dialogs/profilesdialog.h"
 #include "documentchecker.h"
 #include "documentvalidator.h"
+#include "mediaindex.h"
+#include "projectsidecar.h"
 #include "docundostack.hpp"
 #include "effects/effectsrepository.hpp"
 #include "jobs/jobmanager.h"
+#include "jobs/proxyscheduler.h"
 #include "kdenlivesettings.h"
 #include "mainwindow.h"
 #include "mltcontroller/clipcontroller.h"
@@ -145,7 +148,8 @@ KdenliveDoc::KdenliveDoc(const QUrl &url, QString projectFolder, QUndoGroup *und
             int line;
             int col;
             QDomImplementation::setInvalidDataPolicy(QDomImplementation::DropInvalidChars);
-            success = m_document.setContent(&file, false, &errorMsg, &line, &col);
+            const QByteArray projectData = file.readAll();
+            success = m_document.setContent(projectData, false, &errorMsg, &line, &col);
             file.close();
 
             if (!success) {
@@ -222,7 +226,9 @@ KdenliveDoc::KdenliveDoc(const QUrl &url, QString projectFolder, QUndoGroup *und
                         qCDebug(KDENLIVE_LOG) << " // / processing file validate ok";
                         pCore->displayMessage(i18n("Check missing clips"), InformationMessage, 300);
                         qApp->processEvents();
-                        DocumentChecker d(m_url, m_document);
+                        ProjectSidecar sidecar(m_url.toLocalFile());
+                        bool useSidecar = KdenliveSettings::projectsidecar() && sidecar.load(projectData);
+                        DocumentChecker d(m_url, m_document, useSidecar ? &sidecar : nullptr);
                         success = !d.hasErrorInClips();
                         if (success) {
                             loadDocumentProperties();
@@ -622,6 +628,9 @@ bool KdenliveDoc::saveSceneList(const QString &path, const QString &scene)
         KMessageBox::error(QApplication::activeWindow(), i18n("Cannot write to file %1", path));
         return false;
     }
+    if (KdenliveSettings::projectsidecar()) {
+        ProjectSidecar(path).save(sceneData, sceneList);
+    }
     cleanupBackupFiles();
     QFileInfo info(path);
     QString fileName = QUrl::fromLocalFile(path).fileName().section(QLatin1Char('.'), 0, -2);
@@ -802,44 +811,12 @@ const QString KdenliveDoc::description() const
 
 QString KdenliveDoc::searchFileRecursively(const QDir &dir, const QString &matchSize, const QString &matchHash) const
 {
-    QString foundFileName;
-    QByteArray fileData;
-    QByteArray fileHash;
-    QStringList filesAndDirs = dir.entryList(QDir::Files | QDir::Readable);
-    for (int i = 0; i < filesAndDirs.size() && foundFileName.isEmpty(); ++i) {
-        QFile file(dir.absoluteFilePath(filesAndDirs.at(i)));
-        if (file.open(QIODevice::ReadOnly)) {
-            if (QString::number(file.size()) == matchSize) {
-                /*
-                 * 1 MB = 1 second per 450 files (or faster)
-                 * 10 MB = 9 seconds per 450 files (or faster)
-                 */
-                if (file.size() > 1000000 * 2) {
-                    fileData = file.read(1000000);
-                    if (file.seek(file.size() - 1000000)) {
-                        fileData.append(file.readAll());
-                    }
-                } else {
-                    fileData = file.readAll();
-                }
-                file.close();
-                fileHash = QCryptographicHash::hash(fileData, QCryptographicHash::Md5);
-                if (QString::fromLatin1(fileHash.toHex()) == matchHash) {
-                    return file.fileName();
-                }
-                qCDebug(KDENLIVE_LOG) << filesAndDirs.at(i) << "size match but not hash";
-            }
-        }
-        ////qCDebug(KDENLIVE_LOG) << filesAndDirs.at(i) << file.size() << fileHash.toHex();
+    MediaIndex index(dir.absolutePath());
+    if (!index.scan()) {
+        return QString();
     }
-    filesAndDirs = dir.entryList(QDir::Dirs | QDir::Readable | QDir::Executable | QDir::NoDotAndDotDot);
-    for (int i = 0; i < filesAndDirs.size() && foundFileName.isEmpty(); ++i) {
-        foundFileName = searchFileRecursively(dir.absoluteFilePath(filesAndDirs.at(i)), matchSize, matchHash);
-        if (!foundFileName.isEmpty()) {
-            break;
-        }
-    }
-    return foundFileName;
+    qint64 size = matchSize.toLongLong();
+    return index.findByHash({qMakePair(size, matchHash)}).value(MediaIndex::requestKey(size, matchHash));
 }
 
 
@@ -1164,6 +1141,10 @@ void KdenliveDoc::slotProxyCurrentItem(bool doProxy, QList<std::shared_ptr<Proje
     if (clipList.isEmpty()) {
         clipList = pCore->bin()->selectedClips();
     }
+    if (doProxy) {
+        // Jobs are started in this order, create the most useful proxies first
+        ProxyScheduler::sortByPriority(clipList);
+    }
     bool hasParent = true;
     if (masterCommand == nullptr) {
         masterCommand = new QUndoCommand();
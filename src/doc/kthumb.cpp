@@ -122,6 +122,27 @@ QImage KThumb::getFrame(Mlt::Frame *frame, int width, int height, int scaledWidt
     return QImage();
 }
 
+// static
+QImage KThumb::getThumbnail(Mlt::Frame *frame, int width, int height, int scaledWidth)
+{
+    if (frame == nullptr || !frame->is_valid()) {
+        return QImage();
+    }
+    int ow = width;
+    int oh = height;
+    mlt_image_format format = mlt_image_rgb24a;
+    const uchar *imagedata = frame->get_image(format, ow, oh);
+    if (imagedata == nullptr) {
+        return QImage();
+    }
+    // MLT's rgb24a byte order is the one of QImage::Format_RGBA8888, no swapping needed
+    QImage wrapper(imagedata, ow, oh, QImage::Format_RGBA8888);
+    if (scaledWidth == 0 || scaledWidth == ow) {
+        return wrapper.copy();
+    }
+    return wrapper.scaled(scaledWidth, oh, Qt::IgnoreAspectRatio, Qt::FastTransformation);
+}
+
 // static
 int KThumb::imageVariance(const QImage &image)
 {
@@ -36,6 +36,9 @@ QPixmap getImage(const QUrl &url, int frame, int width, int height = -1);
 QImage getFrame(Mlt::Producer *producer, int framepos, int displayWidth, int height);
 QImage getFrame(Mlt::Producer &producer, int framepos, int displayWidth, int height);
 QImage getFrame(Mlt::Frame *frame, int width = 0, int height = 0, int scaledWidth = 0);
+/** @brief Same as getFrame, but wraps MLT's rgba buffer in a RGBA8888 image so that only one copy is made.
+ *  Meant for small timeline thumbnails, scaling uses a fast transformation. */
+QImage getThumbnail(Mlt::Frame *frame, int width, int height, int scaledWidth = 0);
 /** @brief Calculates image variance, useful to know if a thumbnail is interesting.
  *  @return an integer between 0 and 100. 0 means no variance, eg. black image while bigger values mean contrasted image
  * */
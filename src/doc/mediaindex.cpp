@@ -0,0 +1,244 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by agent <agent@local>                             *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "mediaindex.h"
+#include "bin/projectclip.h"
+#include "kdenlive_debug.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QSet>
+#include <QStandardPaths>
+#include <QtConcurrent>
+#include <functional>
+
+namespace {
+struct FolderListing
+{
+    QStringList folders;
+    QList<QPair<QString, qint64>> files;
+};
+} // namespace
+
+MediaIndex::MediaIndex(const QString &root)
+    : m_root(QDir(root).absolutePath())
+    , m_abort(false)
+    , m_folders(0)
+    , m_files(0)
+    , m_hashed(0)
+{
+}
+
+void MediaIndex::cancel()
+{
+    m_abort = true;
+}
+
+bool MediaIndex::isCancelled() const
+{
+    return m_abort;
+}
+
+int MediaIndex::scannedFolders() const
+{
+    return m_folders;
+}
+
+int MediaIndex::indexedFiles() const
+{
+    return m_files;
+}
+
+int MediaIndex::hashedFiles() const
+{
+    return m_hashed;
+}
+
+QString MediaIndex::requestKey(qint64 size, const QString &hash)
+{
+    return QStringLiteral("%1:%2").arg(size).arg(hash);
+}
+
+void MediaIndex::addFile(const QString &path, qint64 size)
+{
+    m_bySize[size] << path;
+    m_byName[QFileInfo(path).fileName()] << path;
+    m_files++;
+}
+
+bool MediaIndex::scan()
+{
+    m_bySize.clear();
+    m_byName.clear();
+    m_files = 0;
+    m_folders = 0;
+    std::function<FolderListing(const QString &)> listFolder = [this](const QString &path) {
+        FolderListing result;
+        if (m_abort) {
+            return result;
+        }
+        const QFileInfoList entries = QDir(path).entryInfoList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot | QDir::Readable, QDir::Name);
+        for (const QFileInfo &entry : entries) {
+            if (entry.isDir()) {
+                // Do not follow links to folders, they may loop
+                if (!entry.isSymLink() && entry.isExecutable()) {
+                    result.folders << entry.absoluteFilePath();
+                }
+            } else {
+                result.files << qMakePair(entry.absoluteFilePath(), entry.size());
+            }
+        }
+        m_folders++;
+        return result;
+    };
+    // Breadth first: all folders of a same depth are listed in parallel, results keep the folder order
+    QStringList level = {m_root};
+    while (!level.isEmpty() && !m_abort) {
+        const QList<FolderListing> listings = QtConcurrent::blockingMapped<QList<FolderListing>>(level, listFolder);
+        level.clear();
+        for (const FolderListing &listing : listings) {
+            for (const auto &file : listing.files) {
+                addFile(file.first, file.second);
+            }
+            level << listing.folders;
+        }
+    }
+    qCDebug(KDENLIVE_LOG) << "Indexed" << m_files << "files in" << m_folders << "folders below" << m_root;
+    return !m_abort;
+}
+
+QHash<QString, QString> MediaIndex::findByHash(const QList<QPair<qint64, QString>> &requests)
+{
+    QHash<QString, QString> results;
+    // Only files having the size of a missing clip are read, each of them once
+    QStringList candidates;
+    QSet<QString> seen;
+    QHash<QString, QString> wanted;
+    for (const auto &request : requests) {
+        wanted.insert(request.second, requestKey(request.first, request.second));
+        for (const QString &path : m_bySize.value(request.first)) {
+            if (!seen.contains(path)) {
+                seen.insert(path);
+                candidates << path;
+            }
+        }
+    }
+    std::function<QString(const QString &)> hashFile = [this](const QString &path) {
+        if (m_abort) {
+            return QString();
+        }
+        {
+            QMutexLocker lk(&m_hashMutex);
+            auto cached = m_hashes.constFind(path);
+            if (cached != m_hashes.constEnd()) {
+                return cached.value();
+            }
+        }
+        QString hash = QString::fromLatin1(ProjectClip::calculateHash(path).first.toHex());
+        m_hashed++;
+        QMutexLocker lk(&m_hashMutex);
+        m_hashes.insert(path, hash);
+        return hash;
+    };
+    const QStringList hashes = QtConcurrent::blockingMapped<QStringList>(candidates, hashFile);
+    for (int i = 0; i < candidates.count() && i < hashes.count(); ++i) {
+        const QString &hash = hashes.at(i);
+        if (hash.isEmpty() || !wanted.contains(hash)) {
+            continue;
+        }
+        const QString key = wanted.value(hash);
+        // A saved index may be outdated, make sure the file still has the expected size
+        if (!results.contains(key) && QString::number(QFileInfo(candidates.at(i)).size()) == key.section(QLatin1Char(':'), 0, 0)) {
+            results.insert(key, candidates.at(i));
+        }
+    }
+    return results;
+}
+
+QString MediaIndex::findByName(const QString &fileName) const
+{
+    for (const QString &path : m_byName.value(fileName)) {
+        if (QFileInfo::exists(path)) {
+            return path;
+        }
+    }
+    return QString();
+}
+
+QString MediaIndex::cachePath() const
+{
+    const QByteArray key = QCryptographicHash::hash(m_root.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/mediaindex/") + QString::fromLatin1(key);
+}
+
+bool MediaIndex::load()
+{
+    QFile file(cachePath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_9);
+    quint32 version;
+    QString root;
+    quint32 count;
+    stream >> version >> root >> count;
+    if (version != 1 || root != m_root) {
+        return false;
+    }
+    m_bySize.clear();
+    m_byName.clear();
+    m_files = 0;
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        QString path;
+        qint64 size;
+        stream >> path >> size;
+        addFile(path, size);
+    }
+    return stream.status() == QDataStream::Ok;
+}
+
+void MediaIndex::save() const
+{
+    QString path = cachePath();
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(KDENLIVE_LOG) << "Cannot save media index" << path;
+        return;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_9);
+    quint32 count = 0;
+    for (const QStringList &paths : m_bySize) {
+        count += quint32(paths.count());
+    }
+    stream << quint32(1) << m_root << count;
+    for (auto it = m_bySize.constBegin(); it != m_bySize.constEnd(); ++it) {
+        for (const QString &p : it.value()) {
+            stream << p << it.key();
+        }
+    }
+    file.commit();
+}
@@ -0,0 +1,93 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by agent <agent@local>                             *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef MEDIAINDEX_H
+#define MEDIAINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QPair>
+#include <QStringList>
+#include <atomic>
+
+/**
+ * @class MediaIndex
+ * @brief An index of all files below a folder, used to relink missing clips.
+ * The folder tree is walked once, listing all folders of a same depth in parallel,
+ * and files are bucketed by size and by name. Looking for a clip by size and hash then
+ * only reads the files that have the right size, and all candidates of all missing clips
+ * are hashed concurrently. The index can be saved to the cache folder so that a later
+ * search in the same folder does not need to walk it again. Since files may have changed
+ * in the meantime, results from a saved index are always checked against the disk.
+ * All lookups can be cancelled from another thread.
+ */
+class MediaIndex
+{
+
+public:
+    explicit MediaIndex(const QString &root);
+
+    /** @brief Walk the root folder and index all files
+     *  @return false if the scan was cancelled */
+    bool scan();
+    /** @brief Load the index saved by a previous scan of the same folder
+     *  @return false if there is no saved index */
+    bool load();
+    /** @brief Save the index in the cache folder */
+    void save() const;
+    /** @brief Stop the running scan or hash lookup */
+    void cancel();
+    bool isCancelled() const;
+
+    /** @brief Returns the key identifying a size / hash request in findByHash results */
+    static QString requestKey(qint64 size, const QString &hash);
+    /** @brief Find files for several clips at once
+     *  @param requests a list of file size and hex encoded hash (as computed by ProjectClip::calculateHash)
+     *  @return the path of the matching file for each found request, by requestKey()
+     */
+    QHash<QString, QString> findByHash(const QList<QPair<qint64, QString>> &requests);
+    /** @brief Returns the least deep existing file with this name, or an empty string */
+    QString findByName(const QString &fileName) const;
+
+    /** @brief Progress information, can be read from any thread */
+    int scannedFolders() const;
+    int indexedFiles() const;
+    int hashedFiles() const;
+
+private:
+    QString m_root;
+    /** @brief Paths by file size and by file name, least deep first */
+    QHash<qint64, QStringList> m_bySize;
+    QHash<QString, QStringList> m_byName;
+    /** @brief Hashes computed during this session, by path */
+    QHash<QString, QString> m_hashes;
+    QMutex m_hashMutex;
+    std::atomic<bool> m_abort;
+    std::atomic<int> m_folders;
+    std::atomic<int> m_files;
+    std::atomic<int> m_hashed;
+
+    void addFile(const QString &path, qint64 size);
+    QString cachePath() const;
+};
+
+#endif
@@ -0,0 +1,158 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by agent <agent@local>                             *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "projectsidecar.h"
+#include "kdenlive_debug.h"
+#include "xml/xml.hpp"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QDomDocument>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+// Increase when the content of the sidecar changes, older sidecars are then ignored
+static const quint32 sidecarVersion = 1;
+static const quint32 sidecarMagic = 0x4b445343; // KDSC
+
+ProjectSidecar::ProjectSidecar(const QString &projectPath)
+    : m_projectPath(QFileInfo(projectPath).absoluteFilePath())
+{
+}
+
+QString ProjectSidecar::cachePath() const
+{
+    const QByteArray key = QCryptographicHash::hash(m_projectPath.toUtf8(), QCryptographicHash::Sha1).toHex();
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/sidecar/") + QString::fromLatin1(key);
+}
+
+bool ProjectSidecar::load(const QByteArray &projectData)
+{
+    m_media.clear();
+    QFile file(cachePath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_9);
+    quint32 magic;
+    quint32 version;
+    QByteArray projectHash;
+    QByteArray payload;
+    stream >> magic >> version >> projectHash >> payload;
+    if (stream.status() != QDataStream::Ok || magic != sidecarMagic || version != sidecarVersion) {
+        return false;
+    }
+    if (projectHash != QCryptographicHash::hash(projectData, QCryptographicHash::Sha1)) {
+        // The project was modified outside of Kdenlive, or saved by another version
+        return false;
+    }
+    payload = qUncompress(payload);
+    QDataStream data(payload);
+    data.setVersion(QDataStream::Qt_5_9);
+    quint32 count;
+    data >> count;
+    for (quint32 i = 0; i < count && data.status() == QDataStream::Ok; ++i) {
+        QString path;
+        MediaSignature signature;
+        data >> path >> signature.size >> signature.modified >> signature.hash;
+        m_media.insert(path, signature);
+    }
+    if (data.status() != QDataStream::Ok) {
+        m_media.clear();
+        return false;
+    }
+    return true;
+}
+
+void ProjectSidecar::save(const QByteArray &projectData, const QDomDocument &doc) const
+{
+    QString root = doc.documentElement().attribute(QStringLiteral("root"));
+    if (!root.isEmpty()) {
+        root = QDir::cleanPath(root) + QDir::separator();
+    }
+    QHash<QString, MediaSignature> media;
+    QDomNodeList producers = doc.elementsByTagName(QStringLiteral("producer"));
+    for (int i = 0; i < producers.count(); ++i) {
+        QDomElement e = producers.item(i).toElement();
+        if (!Xml::getXmlProperty(e, QStringLiteral("mlt_service")).startsWith(QLatin1String("avformat")) ||
+            Xml::getXmlProperty(e, QStringLiteral("kdenlive:proxy")).length() > 1) {
+            // Only clips hashed by DocumentChecker are recorded
+            continue;
+        }
+        const QByteArray hash = Xml::getXmlProperty(e, QStringLiteral("kdenlive:file_hash")).toLatin1();
+        QString resource = Xml::getXmlProperty(e, QStringLiteral("resource"));
+        if (hash.isEmpty() || resource.isEmpty()) {
+            continue;
+        }
+        if (QFileInfo(resource).isRelative()) {
+            resource.prepend(root);
+        }
+        if (media.contains(resource)) {
+            continue;
+        }
+        // Size and modification time are recorded when the hash is computed, the file may have changed since then
+        bool ok = false;
+        const qint64 size = Xml::getXmlProperty(e, QStringLiteral("kdenlive:file_size")).toLongLong(&ok);
+        if (!ok) {
+            continue;
+        }
+        const qint64 modified = Xml::getXmlProperty(e, QStringLiteral("kdenlive:file_modified")).toLongLong(&ok);
+        if (!ok) {
+            continue;
+        }
+        media.insert(resource, {size, modified, hash});
+    }
+
+    QByteArray payload;
+    QDataStream data(&payload, QIODevice::WriteOnly);
+    data.setVersion(QDataStream::Qt_5_9);
+    data << quint32(media.count());
+    for (auto it = media.constBegin(); it != media.constEnd(); ++it) {
+        data << it.key() << it.value().size << it.value().modified << it.value().hash;
+    }
+
+    QString path = cachePath();
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(KDENLIVE_LOG) << "Cannot save project sidecar" << path;
+        return;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_9);
+    stream << sidecarMagic << sidecarVersion << QCryptographicHash::hash(projectData, QCryptographicHash::Sha1) << qCompress(payload);
+    file.commit();
+}
+
+bool ProjectSidecar::isUnchanged(const QString &path, const QByteArray &hash) const
+{
+    auto it = m_media.constFind(path);
+    if (it == m_media.constEnd() || it.value().hash != hash) {
+        return false;
+    }
+    QFileInfo info(path);
+    return info.size() == it.value().size && info.lastModified().toMSecsSinceEpoch() == it.value().modified;
+}
@@ -0,0 +1,70 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by agent <agent@local>                             *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef PROJECTSIDECAR_H
+#define PROJECTSIDECAR_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+
+class QDomDocument;
+
+/**
+ * @class ProjectSidecar
+ * @brief A binary file written in the cache folder each time a project is saved, that speeds up reopening it.
+ * On opening, DocumentChecker reads a part of every source clip to check that it did not change since the project
+ * was saved, which is slow for large projects or network storage. The sidecar records the hash of every source clip
+ * with the size and modification time the file had when that hash was computed, so clips whose size and modification
+ * time did not change are not read again. The sidecar is only used if it was written for the exact project file content that is being opened,
+ * otherwise the project is fully checked as before.
+ */
+class ProjectSidecar
+{
+
+public:
+    explicit ProjectSidecar(const QString &projectPath);
+
+    /** @brief Load the sidecar written when the project was saved
+     *  @param projectData the content of the project file
+     *  @return false if there is no sidecar matching this content */
+    bool load(const QByteArray &projectData);
+    /** @brief Write the sidecar for a project that was just saved
+     *  @param projectData the content written to the project file
+     *  @param doc the saved scene */
+    void save(const QByteArray &projectData, const QDomDocument &doc) const;
+    /** @brief Returns true if the file at @param path still has the size and modification time it had when its @param hash (hex encoded) was computed */
+    bool isUnchanged(const QString &path, const QByteArray &hash) const;
+
+private:
+    struct MediaSignature
+    {
+        qint64 size;
+        qint64 modified;
+        QByteArray hash;
+    };
+    QString m_projectPath;
+    QHash<QString, MediaSignature> m_media;
+
+    QString cachePath() const;
+};
+
+#endif
@@ -23,6 +23,7 @@
 #include "core.h"
 #include "kdenlivesettings.h"
 #include "profiles/profilemodel.hpp"
+#include "utils/startupprofiler.hpp"
 #include "xml/xml.hpp"
 
 #include <KLocalizedString>
@@ -35,11 +36,23 @@
 std::unique_ptr<EffectsRepository> EffectsRepository::instance;
 std::once_flag EffectsRepository::m_onceFlag;
 
+// File name of the catalog cache, in the application cache directory
+static const QString catalogName = QStringLiteral("effects.catalog");
+
 EffectsRepository::EffectsRepository()
     : AbstractAssetsRepository<AssetListType::AssetType>()
 {
+    StartupProfiler::Phase phase(QStringLiteral("Effects repository"));
     init();
-    // Check that our favorite effects are valid
+}
+
+void EffectsRepository::prefetch()
+{
+    prefetchCatalog(catalogName);
+}
+
+void EffectsRepository::checkFavorites()
+{
     QStringList invalidEffect;
     for (const QString &effect : KdenliveSettings::favorite_effects()) {
         if (!exists(effect)) {
@@ -203,6 +216,11 @@ QString EffectsRepository::assetPreferredListPath() const
     return QStringLiteral(":data/preferred_effects.txt");
 }
 
+QString EffectsRepository::assetCatalogName() const
+{
+    return catalogName;
+}
+
 bool EffectsRepository::isPreferred(const QString &effectId) const
 {
     return m_preferred_list.contains(effectId);
@@ -40,6 +40,9 @@ public:
     // Returns the instance of the Singleton
     static std::unique_ptr<EffectsRepository> &get();
 
+    /* @brief Starts reading the effects' catalog cache from disk, so that building the repository does not wait for it */
+    static void prefetch();
+
     /* @brief returns a fresh instance of the given effect */
     std::unique_ptr<Mlt::Filter> getEffect(const QString &effectId) const;
     /* @brief returns true if an effect exists in MLT (bypasses the blacklist/metadata parsing) */
@@ -58,6 +61,10 @@ public:
     void deleteEffect(const QString &id);
     bool isAudioEffect(const QString &assetId) const;
 
+    /** @brief Removes the favorite effects that don't exist anymore.
+     *  This writes the settings, so it must run in the GUI thread once the repository is loaded. */
+    void checkFavorites();
+
 protected:
     // Constructor is protected because class is a Singleton
     EffectsRepository();
@@ -76,6 +83,9 @@ protected:
     /* @brief Returns the path to the effects' preferred list*/
     QString assetPreferredListPath() const override;
 
+    /* @brief Returns the file name of the effects' catalog cache*/
+    QString assetCatalogName() const override;
+
     QStringList assetDirs() const override;
 
     void parseType(QScopedPointer<Mlt::Properties> &metadata, Info &res) override;
@@ -322,17 +322,76 @@ QDomElement EffectStackModel::rowToXml(int row, QDomDocument &document)
     return container;
 }
 
-bool EffectStackModel::fromXml(const QDomElement &effectsXml, Fun &undo, Fun &redo)
+std::vector<std::shared_ptr<Mlt::Properties>> EffectStackModel::toProperties()
+{
+    std::vector<std::shared_ptr<Mlt::Properties>> effects;
+    for (int i = 0; i < rootItem->childCount(); ++i) {
+        std::shared_ptr<EffectItemModel> sourceEffect = std::static_pointer_cast<EffectItemModel>(rootItem->child(i));
+        auto props = std::make_shared<Mlt::Properties>();
+        props->set("kdenlive_id", sourceEffect->getAssetId().toUtf8().constData());
+        int filterIn = sourceEffect->filter().get_int("in");
+        int filterOut = sourceEffect->filter().get_int("out");
+        if (filterOut > filterIn) {
+            props->set("in", filterIn);
+            props->set("out", filterOut);
+        }
+        QStringList passProps {QStringLiteral("disable"), QStringLiteral("kdenlive:collapsed")};
+        for (const QString &param : passProps) {
+            int paramVal = sourceEffect->filter().get_int(param.toUtf8().constData());
+            if (paramVal > 0) {
+                props->set(param.toUtf8().constData(), paramVal);
+            }
+        }
+        QVector<QPair<QString, QVariant>> params = sourceEffect->getAllParameters();
+        for (const auto &param : qAsConst(params)) {
+            props->set(param.first.toUtf8().constData(), param.second.toString().toUtf8().constData());
+        }
+        effects.push_back(props);
+    }
+    return effects;
+}
+
+std::vector<std::shared_ptr<Mlt::Properties>> EffectStackModel::propertiesFromXml(const QDomElement &effectsXml)
 {
+    std::vector<std::shared_ptr<Mlt::Properties>> effects;
     QDomNodeList nodeList = effectsXml.elementsByTagName(QStringLiteral("effect"));
+    for (int i = 0; i < nodeList.count(); ++i) {
+        QDomElement node = nodeList.item(i).toElement();
+        auto props = std::make_shared<Mlt::Properties>();
+        props->set("kdenlive_id", node.attribute(QStringLiteral("id")).toUtf8().constData());
+        const QString out = node.attribute(QStringLiteral("out"));
+        if (!out.isEmpty()) {
+            props->set("in", node.attribute(QStringLiteral("in")).toUtf8().constData());
+            props->set("out", out.toUtf8().constData());
+        }
+        QDomNodeList params = node.elementsByTagName(QStringLiteral("property"));
+        for (int j = 0; j < params.count(); j++) {
+            QDomElement pnode = params.item(j).toElement();
+            const QString pName = pnode.attribute(QStringLiteral("name"));
+            if (pName == QLatin1String("in") || pName == QLatin1String("out")) {
+                continue;
+            }
+            props->set(pName.toUtf8().constData(), pnode.text().toUtf8().constData());
+        }
+        effects.push_back(props);
+    }
+    return effects;
+}
+
+bool EffectStackModel::fromXml(const QDomElement &effectsXml, Fun &undo, Fun &redo)
+{
     int parentIn = effectsXml.attribute(QStringLiteral("parentIn")).toInt();
     qDebug()<<"// GOT PREVIOUS PARENTIN: "<<parentIn<<"\n\n=======\n=======\n\n";
+    return fromProperties(propertiesFromXml(effectsXml), parentIn, undo, redo);
+}
+
+bool EffectStackModel::fromProperties(const std::vector<std::shared_ptr<Mlt::Properties>> &effects, int parentIn, Fun &undo, Fun &redo)
+{
     int currentIn = pCore->getItemIn(m_ownerId);
     PlaylistState::ClipState state = pCore->getItemState(m_ownerId);
     bool effectAdded = false;
-    for (int i = 0; i < nodeList.count(); ++i) {
-        QDomElement node = nodeList.item(i).toElement();
-        const QString effectId = node.attribute(QStringLiteral("id"));
+    for (const auto &props : effects) {
+        const QString effectId = props->get("kdenlive_id");
         AssetListType::AssetType type = EffectsRepository::get()->getType(effectId);
         bool isAudioEffect = type == AssetListType::AssetType::Audio || type == AssetListType::AssetType::CustomAudio;
         if (isAudioEffect) {
@@ -347,31 +406,27 @@ bool EffectStackModel::fromXml(const QDomElement &effectsXml, Fun &undo, Fun &re
             return false;
         }
         bool effectEnabled = true;
-        if (Xml::hasXmlProperty(node, QLatin1String("disable"))) {
-            effectEnabled = Xml::getXmlProperty(node, QLatin1String("disable")).toInt() != 1;
+        if (props->property_exists("disable")) {
+            effectEnabled = props->get_int("disable") != 1;
         }
         auto effect = EffectItemModel::construct(effectId, shared_from_this(), effectEnabled);
-        const QString in = node.attribute(QStringLiteral("in"));
-        const QString out = node.attribute(QStringLiteral("out"));
-        if (!out.isEmpty()) {
-            effect->filter().set("in", in.toUtf8().constData());
-            effect->filter().set("out", out.toUtf8().constData());
+        if (props->property_exists("out")) {
+            effect->filter().set("in", props->get("in"));
+            effect->filter().set("out", props->get("out"));
         }
         QStringList keyframeParams = effect->getKeyframableParameters();
         QVector<QPair<QString, QVariant>> parameters;
-        QDomNodeList params = node.elementsByTagName(QStringLiteral("property"));
-        for (int j = 0; j < params.count(); j++) {
-            QDomElement pnode = params.item(j).toElement();
-            const QString pName = pnode.attribute(QStringLiteral("name"));
-            if (pName == QLatin1String("in") || pName == QLatin1String("out")) {
+        for (int j = 0; j < props->count(); j++) {
+            const QString pName = props->get_name(j);
+            if (pName == QLatin1String("kdenlive_id") || pName == QLatin1String("in") || pName == QLatin1String("out")) {
                 continue;
             }
+            const QString pValue = props->get(j);
             if (keyframeParams.contains(pName)) {
                 // This is a keyframable parameter, fix offset
-                QString pValue = KeyframeModel::getAnimationStringWithOffset(effect, pnode.text(), currentIn - parentIn);
-                parameters.append(QPair<QString, QVariant>(pName, QVariant(pValue)));
+                parameters.append(QPair<QString, QVariant>(pName, QVariant(KeyframeModel::getAnimationStringWithOffset(effect, pValue, currentIn - parentIn))));
             } else {
-                parameters.append(QPair<QString, QVariant>(pName, QVariant(pnode.text())));
+                parameters.append(QPair<QString, QVariant>(pName, QVariant(pValue)));
             }
         }
         effect->setParameters(parameters);
@@ -879,7 +934,10 @@ void EffectStackModel::registerItem(const std::shared_ptr<TreeItem> &item)
         ix = getIndexFromItem(effectItem);
         if (!effectItem->isAudio() && !m_loadingExisting) {
             pCore->refreshProjectItem(m_ownerId);
-            pCore->invalidateItem(m_ownerId);
+            // A disabled effect does not change the timeline preview
+            if (effectItem->filter().get_int("disable") == 0) {
+                pCore->invalidateItem(m_ownerId);
+            }
         }
     }
     AbstractTreeModel::registerItem(item);
@@ -890,13 +948,17 @@ void EffectStackModel::deregisterItem(int id, TreeItem *item)
     QWriteLocker locker(&m_lock);
     if (!item->isRoot()) {
         auto effectItem = static_cast<AbstractEffectItem *>(item);
+        // A disabled effect does not change the timeline preview
+        bool disabled = effectItem->effectItemType() == EffectItemType::Effect && static_cast<EffectItemModel *>(effectItem)->filter().get_int("disable") != 0;
         effectItem->unplant(m_masterService);
         for (const auto &service : m_childServices) {
             effectItem->unplantClone(service);
         }
         if (!effectItem->isAudio()) {
             pCore->refreshProjectItem(m_ownerId);
-            pCore->invalidateItem(m_ownerId);
+            if (!disabled) {
+                pCore->invalidateItem(m_ownerId);
+            }
         }
     }
     AbstractTreeModel::deregisterItem(id, item);
@@ -1209,6 +1271,19 @@ bool EffectStackModel::hasFilter(const QString &effectId) const
     });
 }
 
+bool EffectStackModel::hasEnabledVideoEffect() const
+{
+    READ_LOCK();
+    return rootItem->accumulate_const(false, [](bool b, std::shared_ptr<const TreeItem> it) {
+        if (b) return true;
+        auto item = std::static_pointer_cast<const AbstractEffectItem>(it);
+        if (item->effectItemType() == EffectItemType::Group) {
+            return false;
+        }
+        return item->isEnabled() && !item->isAudio();
+    });
+}
+
 double EffectStackModel::getFilterParam(const QString &effectId, const QString &paramName)
 {
     READ_LOCK();
@@ -136,6 +136,13 @@ public:
     QDomElement rowToXml(int row, QDomDocument &document);
     /* @brief Load an effect stack from an XML representation */
     bool fromXml(const QDomElement &effectsXml, Fun &undo, Fun &redo);
+    /* @brief Returns a copy of the effects with all parameters, one set of properties per effect, holding the same data as toXml() */
+    std::vector<std::shared_ptr<Mlt::Properties>> toProperties();
+    /* @brief Converts an XML representation created by toXml() to the format of toProperties() */
+    static std::vector<std::shared_ptr<Mlt::Properties>> propertiesFromXml(const QDomElement &effectsXml);
+    /* @brief Append effects copied with toProperties()
+       @param parentIn the in point of the item the effects were copied from, used to offset keyframes */
+    bool fromProperties(const std::vector<std::shared_ptr<Mlt::Properties>> &effects, int parentIn, Fun &undo, Fun &redo);
     /* @brief Delete active effect from stack */
     void removeCurrentEffect();
 
@@ -144,6 +151,8 @@ public:
 
     /* @brief Return true if an asset id is already added to this effect stack */
     bool hasEffect(const QString &assetId) const;
+    /* @brief Return true if an enabled effect of the stack processes video */
+    bool hasEnabledVideoEffect() const;
     
     /* @brief Remove all effects for this stack */
     void removeAllEffects(Fun &undo, Fun & redo);
@@ -51,7 +51,8 @@ public:
         LOADJOB = 8,
         AUDIOTHUMBJOB = 9,
         SPEEDJOB = 10,
-        CACHEJOB = 11
+        CACHEJOB = 11,
+        LOUDNESSJOB = 12
     };
     AbstractClipJob(JOBTYPE type, QString id, QObject *parent = nullptr);
     ~AbstractClipJob() override;
@@ -28,6 +28,7 @@
 #include "kdenlivesettings.h"
 #include "klocalizedstring.h"
 #include "lib/audio/audioStreamInfo.h"
+#include "loudnessjob.hpp"
 #include "macros.hpp"
 #include "utils/thumbnailcache.hpp"
 
@@ -71,6 +72,16 @@ bool AudioThumbJob::computeWithMlt()
     audioProducer->attach(chans);
     audioProducer->attach(converter);
     audioProducer->attach(levels);
+    // This pass decodes the whole audio, measure its loudness at the same time. We don't select a stream, so only do it if there is a single one
+    std::unique_ptr<LoudnessMeter> meter;
+    if (m_binClip->audioInfo()->streams().count() == 1) {
+        meter.reset(new LoudnessMeter(*m_prod->profile()));
+        if (meter->isValid()) {
+            meter->attach(*audioProducer.data());
+        } else {
+            meter.reset();
+        }
+    }
 
     int last_val = 0;
     double framesPerSecond = audioProducer->get_fps();
@@ -97,6 +108,9 @@ bool AudioThumbJob::computeWithMlt()
                 mltLevels << lev;
                 maxLevel = qMax(lev, maxLevel);
             }
+            if (meter) {
+                meter->frameProcessed();
+            }
         } else if (!mltLevels.isEmpty()) {
             for (int channel = 0; channel < m_channels; channel++) {
                 mltLevels << mltLevels.last();
@@ -107,6 +121,9 @@ bool AudioThumbJob::computeWithMlt()
     for (double &v : mltLevels) {
         m_audioLevels << 255 * v / maxLevel;
     }
+    if (meter) {
+        LoudnessJob::storeResult(m_binClip, m_audioStream, meter->result());
+    }
 
     m_done = true;
     return true;
@@ -107,8 +107,10 @@ bool CacheJob::startJob()
             m_semaphore.release();
             break;
         }
+        QMutexLocker seekLock(m_binClip->thumbSeekMutex());
         m_prod->seek(i);
         QScopedPointer<Mlt::Frame> frame(m_prod->get_frame());
+        seekLock.unlock();
         frame->set("deinterlace_method", "onefield");
         frame->set("top_field_first", -1);
         frame->set("rescale.interp", "nearest");
@@ -26,6 +26,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "bin/projectitemmodel.h"
 #include "core.h"
 #include "macros.hpp"
+#include "proxyscheduler.h"
 #include "undohelper.hpp"
 
 #include <KMessageWidget>
@@ -239,7 +240,12 @@ void JobManager::createJob(const std::shared_ptr<Job_t> &job)
     connect(&job->m_future, &QFutureWatcher<bool>::started, this, &JobManager::updateJobCount);
     connect(&job->m_future, &QFutureWatcher<bool>::finished, this, [this, id = job->m_id]() { if (m_jobs.count(id)> 0) slotManageFinishedJob(id); });
     connect(&job->m_future, &QFutureWatcher<bool>::canceled, this, [this, id = job->m_id]() { slotManageCanceledJob(id); });
-    job->m_actualFuture = QtConcurrent::mapped(job->m_job, AbstractClipJob::execute);
+    if (job->m_type == AbstractClipJob::PROXYJOB) {
+        // Proxy jobs wait for an encode slot, keep them away from the global pool
+        job->m_actualFuture = ProxyScheduler::get()->run(job->m_job);
+    } else {
+        job->m_actualFuture = QtConcurrent::mapped(job->m_job, AbstractClipJob::execute);
+    }
     job->m_future.setFuture(job->m_actualFuture);
 }
 
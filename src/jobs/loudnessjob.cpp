@@ -0,0 +1,339 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by agent <agent@local>                             *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+
+#include "loudnessjob.hpp"
+#include "bin/projectclip.h"
+#include "bin/projectitemmodel.h"
+#include "core.h"
+#include "doc/kdenlivedoc.h"
+#include "klocalizedstring.h"
+#include "lib/audio/audioStreamInfo.h"
+#include "macros.hpp"
+#include "profiles/profilemodel.hpp"
+
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QtMath>
+#include <cmath>
+#include <mlt++/Mlt.h>
+
+// Short-term loudness below the EBU R128 absolute gate is silence
+static const double absoluteGate = -70.;
+
+QString LoudnessInfo::toString() const
+{
+    return QStringLiteral("%1;%2;%3").arg(integrated, 0, 'f', 2).arg(shortTermMax, 0, 'f', 2).arg(truePeak, 0, 'f', 2);
+}
+
+LoudnessInfo LoudnessInfo::fromString(const QString &data)
+{
+    LoudnessInfo info;
+    const QStringList values = data.split(QLatin1Char(';'));
+    if (values.count() != 3) {
+        return info;
+    }
+    bool ok1, ok2, ok3;
+    info.integrated = values.at(0).toDouble(&ok1);
+    info.shortTermMax = values.at(1).toDouble(&ok2);
+    info.truePeak = values.at(2).toDouble(&ok3);
+    info.valid = ok1 && ok2 && ok3;
+    return info;
+}
+
+int LoudnessInfo::normalizationGain(double target, double maxPeak) const
+{
+    if (!valid) {
+        return 0;
+    }
+    return qMin(qRound(target - integrated), qFloor(maxPeak - truePeak));
+}
+
+LoudnessMeter::LoudnessMeter(Mlt::Profile &profile)
+    : m_filter(new Mlt::Filter(profile, "loudness_meter"))
+    , m_shortTermMax(absoluteGate)
+{
+    if (m_filter->is_valid()) {
+        // Momentary loudness and loudness range are not needed
+        m_filter->set("calc_program", 1);
+        m_filter->set("calc_shortterm", 1);
+        m_filter->set("calc_momentary", 0);
+        m_filter->set("calc_range", 0);
+        m_filter->set("calc_peak", 0);
+        m_filter->set("calc_true_peak", 1);
+    }
+}
+
+LoudnessMeter::~LoudnessMeter() = default;
+
+bool LoudnessMeter::isValid() const
+{
+    return m_filter->is_valid();
+}
+
+void LoudnessMeter::attach(Mlt::Producer &producer)
+{
+    producer.attach(*m_filter.get());
+}
+
+void LoudnessMeter::frameProcessed()
+{
+    double shortTerm = m_filter->get_double("shortterm");
+    if (std::isfinite(shortTerm)) {
+        m_shortTermMax = qMax(m_shortTermMax, shortTerm);
+    }
+}
+
+bool LoudnessMeter::process(Mlt::Producer &producer, int length, int frequency, int channels, const std::function<bool(int)> &progress)
+{
+    double framesPerSecond = producer.get_fps();
+    mlt_audio_format audioFormat = mlt_audio_float;
+    for (int z = 0; z < length; ++z) {
+        if (!progress(z)) {
+            return false;
+        }
+        std::unique_ptr<Mlt::Frame> mltFrame(producer.get_frame());
+        if ((mltFrame != nullptr) && mltFrame->is_valid() && (mltFrame->get_int("test_audio") == 0)) {
+            int samples = mlt_sample_calculator(float(framesPerSecond), frequency, z);
+            mltFrame->get_audio(audioFormat, frequency, channels, samples);
+            frameProcessed();
+        }
+    }
+    return true;
+}
+
+LoudnessInfo LoudnessMeter::result() const
+{
+    LoudnessInfo info;
+    info.integrated = m_filter->get_double("program");
+    info.shortTermMax = m_shortTermMax;
+    info.truePeak = m_filter->get_double("max_true_peak");
+    // Only silence was measured
+    info.valid = std::isfinite(info.integrated) && std::isfinite(info.truePeak) && info.integrated > absoluteGate;
+    return info;
+}
+
+LoudnessJob::LoudnessJob(const QString &binId)
+    : AbstractClipJob(LOUDNESSJOB, binId)
+{
+}
+
+const QString LoudnessJob::getDescription() const
+{
+    return i18n("Measuring loudness of clip %1", m_clipId);
+}
+
+QString LoudnessJob::propertyName(int stream)
+{
+    return QStringLiteral("kdenlive:loudness.%1").arg(stream);
+}
+
+QString LoudnessJob::cachePath(const std::shared_ptr<ProjectClip> &clip, int stream)
+{
+    bool ok = false;
+    QDir thumbFolder = pCore->currentDoc()->getCacheDir(CacheAudio, &ok);
+    if (!ok) {
+        return QString();
+    }
+    const QString clipHash = clip->hash();
+    if (clipHash.isEmpty()) {
+        return QString();
+    }
+    return thumbFolder.absoluteFilePath(QStringLiteral("%1_%2_loudness.txt").arg(clipHash).arg(stream));
+}
+
+bool LoudnessJob::storeResult(const std::shared_ptr<ProjectClip> &clip, int stream, const LoudnessInfo &info)
+{
+    const QString path = cachePath(clip, stream);
+    if (path.isEmpty() || !info.valid) {
+        return false;
+    }
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(info.toString().toUtf8());
+    return file.commit();
+}
+
+LoudnessInfo LoudnessJob::measureTimeline(const QString &scene, int channels, const std::atomic_bool &canceled)
+{
+    Mlt::Profile &profile = pCore->getCurrentProfile()->profile();
+    Mlt::Producer producer(profile, "xml-string", scene.toUtf8().constData());
+    LoudnessMeter meter(profile);
+    if (!producer.is_valid() || !meter.isValid()) {
+        return LoudnessInfo();
+    }
+    meter.attach(producer);
+    // Measure at the usual render frequency
+    if (!meter.process(producer, producer.get_length(), 48000, channels, [&canceled](int) { return !canceled; })) {
+        return LoudnessInfo();
+    }
+    return meter.result();
+}
+
+bool LoudnessJob::measureStream(int stream, int channels, int streamIndex, int streamCount, LoudnessInfo &info)
+{
+    QString service = m_prod->get("mlt_service");
+    if (service == QLatin1String("avformat-novalidate")) {
+        service = QStringLiteral("avformat");
+    } else if (service.startsWith(QLatin1String("xml"))) {
+        service = QStringLiteral("xml-nogl");
+    }
+    std::unique_ptr<Mlt::Producer> audioProducer(new Mlt::Producer(*m_prod->profile(), service.toUtf8().constData(), m_prod->get("resource")));
+    if (!audioProducer->is_valid()) {
+        m_errorMessage.append(i18n("Loudness: cannot open file %1", m_prod->get("resource")));
+        return false;
+    }
+    audioProducer->set("video_index", "-1");
+    if (stream >= 0 && stream != INT_MAX) {
+        audioProducer->set("audio_index", stream);
+    }
+    LoudnessMeter meter(*m_prod->profile());
+    if (!meter.isValid()) {
+        m_errorMessage.append(i18n("Loudness: cannot create filter loudness_meter"));
+        return false;
+    }
+    meter.attach(*audioProducer.get());
+
+    int lastProgress = 0;
+    bool completed = meter.process(*audioProducer.get(), m_lengthInFrames, m_frequency, channels, [&](int z) {
+        if (m_canceled) {
+            return false;
+        }
+        int progress = (int)(100.0 * (streamIndex * m_lengthInFrames + z) / (streamCount * m_lengthInFrames));
+        if (progress != lastProgress) {
+            emit jobProgress(progress);
+            lastProgress = progress;
+        }
+        return true;
+    });
+    if (!completed) {
+        return false;
+    }
+    info = meter.result();
+    return true;
+}
+
+bool LoudnessJob::startJob()
+{
+    if (m_done) {
+        return true;
+    }
+    m_binClip = pCore->projectItemModel()->getClipByBinID(m_clipId);
+    if (m_binClip == nullptr) {
+        // Clip was deleted
+        return false;
+    }
+    m_successful = true;
+    if (m_binClip->audioChannels() == 0 || m_binClip->audioInfo() == nullptr) {
+        // nothing to do
+        m_done = true;
+        return true;
+    }
+    m_prod = m_binClip->originalProducer();
+    if ((m_prod == nullptr) || !m_prod->is_valid()) {
+        m_errorMessage.append(i18n("Loudness: cannot open project file %1", m_binClip->url()));
+        m_done = true;
+        m_successful = false;
+        return false;
+    }
+    m_lengthInFrames = m_prod->get_length();
+    if (m_lengthInFrames == INT_MAX) {
+        // This is a broken file or live feed
+        m_done = true;
+        m_successful = false;
+        return false;
+    }
+    m_frequency = m_binClip->audioInfo()->samplingRate();
+    m_frequency = m_frequency <= 0 ? 48000 : m_frequency;
+    int defaultChannels = m_binClip->audioInfo()->channels();
+    defaultChannels = defaultChannels <= 0 ? 2 : defaultChannels;
+
+    connect(this, &LoudnessJob::jobCanceled, [&]() { m_canceled = true; });
+    const QList<int> streams = m_binClip->audioInfo()->streams().keys();
+    const QMap<int, int> audioChannels = m_binClip->audioInfo()->streamChannels();
+    int ix = 0;
+    for (int stream : streams) {
+        LoudnessInfo info;
+        // The audio thumbnail pass may already have measured this stream
+        QFile cache(cachePath(m_binClip, stream));
+        if (cache.open(QIODevice::ReadOnly)) {
+            info = LoudnessInfo::fromString(QString::fromUtf8(cache.readAll()));
+            cache.close();
+        }
+        if (!info.valid) {
+            int channels = audioChannels.value(stream, defaultChannels);
+            if (!measureStream(stream, channels, ix, streams.count(), info)) {
+                m_done = true;
+                m_successful = false;
+                return false;
+            }
+            storeResult(m_binClip, stream, info);
+        }
+        if (info.valid) {
+            m_results.insert(stream, info);
+        }
+        ix++;
+    }
+    m_done = true;
+    return true;
+}
+
+bool LoudnessJob::commitResult(Fun &undo, Fun &redo)
+{
+    Q_ASSERT(!m_resultConsumed);
+    if (!m_done) {
+        qDebug() << "ERROR: Trying to consume invalid results";
+        return false;
+    }
+    m_resultConsumed = true;
+    if (!m_successful) {
+        return false;
+    }
+    if (m_results.isEmpty()) {
+        m_errorMessage.append(i18n("No data returned from clip analysis"));
+        return false;
+    }
+    QMap<QString, QString> properties;
+    QMap<QString, QString> oldProperties;
+    QMapIterator<int, LoudnessInfo> i(m_results);
+    while (i.hasNext()) {
+        i.next();
+        const QString key = propertyName(i.key());
+        properties.insert(key, i.value().toString());
+        oldProperties.insert(key, m_binClip->getProducerProperty(key));
+    }
+    auto operation = [clip = m_binClip, properties]() {
+        clip->setProperties(properties, true);
+        return true;
+    };
+    auto reverse = [clip = m_binClip, oldProperties]() {
+        clip->setProperties(oldProperties, true);
+        return true;
+    };
+    bool ok = operation();
+    if (ok) {
+        UPDATE_UNDO_REDO_NOLOCK(operation, reverse, undo, redo);
+    }
+    return ok;
+}
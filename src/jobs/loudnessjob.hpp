@@ -0,0 +1,118 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by agent <agent@local>                             *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+
+#pragma once
+
+#include "abstractclipjob.h"
+
+#include <QMap>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+class ProjectClip;
+namespace Mlt {
+class Filter;
+class Producer;
+class Profile;
+} // namespace Mlt
+
+/* @brief Loudness of an audio stream, measured with the EBU R128 algorithm
+ */
+struct LoudnessInfo
+{
+    // Integrated loudness, in LUFS
+    double integrated{0.};
+    // Highest short-term (3 seconds) loudness, in LUFS
+    double shortTermMax{0.};
+    // Highest true peak, in dBTP
+    double truePeak{0.};
+    bool valid{false};
+
+    /* @brief Serialize as "integrated;shortterm;truepeak", used for the clip property and the cache file */
+    QString toString() const;
+    static LoudnessInfo fromString(const QString &data);
+    /* @brief Gain in whole dB, as used by the volume stream effect, bringing the integrated loudness to @param target
+       without pushing the true peak above @param maxPeak */
+    int normalizationGain(double target, double maxPeak = -1.) const;
+};
+
+/* @brief Wraps a loudness_meter filter, so that any audio decode pass can measure loudness
+ */
+class LoudnessMeter
+{
+public:
+    explicit LoudnessMeter(Mlt::Profile &profile);
+    ~LoudnessMeter();
+    bool isValid() const;
+    void attach(Mlt::Producer &producer);
+    /* @brief Call once the audio of each frame was fetched */
+    void frameProcessed();
+    /* @brief Fetch the audio of the first @param length frames of @param producer, which the meter must be attached to.
+       @param progress is called with each frame number and returns false to stop */
+    bool process(Mlt::Producer &producer, int length, int frequency, int channels, const std::function<bool(int)> &progress);
+    LoudnessInfo result() const;
+
+private:
+    std::unique_ptr<Mlt::Filter> m_filter;
+    double m_shortTermMax;
+};
+
+/* @brief This class represents the job that measures the loudness of each audio stream of a clip
+ */
+class LoudnessJob : public AbstractClipJob
+{
+    Q_OBJECT
+
+public:
+    LoudnessJob(const QString &binId);
+
+    const QString getDescription() const override;
+
+    bool startJob() override;
+
+    /** @brief This is to be called after the job finished.
+        By design, the job should store the result of the computation but not share it with the rest of the code. This happens when we call commitResult */
+    bool commitResult(Fun &undo, Fun &redo) override;
+
+    /* @brief The clip property holding the loudness of an audio stream */
+    static QString propertyName(int stream);
+    /* @brief Results are cached next to the audio thumbnails, so they survive a project reload or a reuse of the clip in another project */
+    static QString cachePath(const std::shared_ptr<ProjectClip> &clip, int stream);
+    static bool storeResult(const std::shared_ptr<ProjectClip> &clip, int stream, const LoudnessInfo &info);
+    /* @brief Measure the mixed audio of a timeline, as it would be rendered. Not a clip job, as the result belongs to no bin clip
+       @param scene the timeline playlist, as returned by ProjectManager::projectSceneList
+       @param channels the project audio channels
+       @param canceled set it to stop the measure, an invalid result is then returned */
+    static LoudnessInfo measureTimeline(const QString &scene, int channels, const std::atomic_bool &canceled);
+
+protected:
+    bool measureStream(int stream, int channels, int streamIndex, int streamCount, LoudnessInfo &info);
+
+private:
+    std::shared_ptr<ProjectClip> m_binClip;
+    std::shared_ptr<Mlt::Producer> m_prod;
+    std::atomic_bool m_canceled{false};
+    bool m_done{false}, m_successful{false};
+    int m_frequency, m_lengthInFrames;
+    QMap<int, LoudnessInfo> m_results;
+};
@@ -30,13 +30,47 @@
 
 #include <klocalizedstring.h>
 
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <atomic>
 #include <memory>
 #include <mlt++/Mlt.h>
+
+// Decoders are opened once per segment, shorter segments would spend more time seeking than analysing
+static const int minSegmentSeconds = 120;
+
+namespace {
+struct AnalysisSegment
+{
+    MeltJob *job;
+    std::atomic<int> *processed;
+    const std::atomic_bool *canceled;
+    int offset, start, end;
+    int lastPosition{0};
+    std::unique_ptr<Mlt::Producer> source;
+    std::unique_ptr<Mlt::Producer> producer;
+    std::unique_ptr<Mlt::Tractor> tractor;
+    std::unique_ptr<Mlt::Filter> filter;
+    std::unique_ptr<Mlt::Consumer> consumer;
+    std::unique_ptr<Mlt::Event> showFrameEvent;
+};
+} // namespace
+
 static void consumer_frame_render(mlt_consumer, MeltJob *self, mlt_frame frame_ptr)
 {
     emit self->jobProgress((int)(100 * mlt_frame_get_position(frame_ptr) / self->length));
 }
 
+static void segment_frame_render(mlt_consumer, AnalysisSegment *segment, mlt_frame frame_ptr)
+{
+    // Segments run concurrently, progress is the sum of the frames processed by all of them
+    int pos = mlt_frame_get_position(frame_ptr);
+    int done = segment->processed->fetch_add(pos - segment->lastPosition) + pos - segment->lastPosition;
+    segment->lastPosition = pos;
+    emit segment->job->jobProgress((int)(100 * done / segment->job->length));
+}
+
 MeltJob::MeltJob(const QString &binId, JOBTYPE type, bool useProducerProfile, int in, int out)
     : AbstractClipJob(type, binId)
     , m_useProducerProfile(useProducerProfile)
@@ -130,6 +164,10 @@ bool MeltJob::startJob()
         return false;
     }
 
+    if (canAnalyseSegments() && !m_url.isEmpty()) {
+        return analyseSegments();
+    }
+
     // Build consumer
     configureConsumer();
     /*
@@ -221,3 +259,116 @@ bool MeltJob::startJob()
     m_successful = m_done = true;
     return true;
 }
+
+bool MeltJob::analyseSegments()
+{
+    const int total = length;
+    int maxSegments = qBound(1, QThread::idealThreadCount() / 2, 8);
+    int minLength = qMax(1, int(m_profile->fps() * minSegmentSeconds));
+    int count = qBound(1, total / minLength, maxSegments);
+    int overlap = segmentOverlap();
+    std::atomic<int> processed(0);
+    std::atomic_bool canceled(false);
+    std::vector<std::unique_ptr<AnalysisSegment>> segments;
+    for (int i = 0; i < count; ++i) {
+        auto segment = std::make_unique<AnalysisSegment>();
+        segment->job = this;
+        segment->processed = &processed;
+        segment->canceled = &canceled;
+        segment->start = int(qint64(total) * i / count);
+        segment->end = int(qint64(total) * (i + 1) / count) - 1;
+        segment->offset = qMax(0, segment->start - overlap);
+        if (i == 0) {
+            // Cut positions are always relative to the parent producer
+            Mlt::Producer *parent = m_wholeProducer ? m_wholeProducer.get() : m_producer.get();
+            segment->producer.reset(parent->cut(m_in + segment->offset, m_in + segment->end));
+        } else {
+            // Each segment needs its own decoder, cuts of the same producer cannot be read from several threads
+            if (KdenliveSettings::gpu_accel()) {
+                auto binClip = pCore->projectItemModel()->getClipByBinID(m_clipId);
+                if (binClip) {
+                    segment->source = binClip->getClone();
+                    Mlt::Filter converter(*m_profile.get(), "avcolor_space");
+                    segment->source->attach(converter);
+                }
+            } else {
+                segment->source = std::make_unique<Mlt::Producer>(*m_profile.get(), m_url.toUtf8().constData());
+            }
+            if (segment->source && segment->source->is_valid()) {
+                segment->producer.reset(segment->source->cut(m_in + segment->offset, m_in + segment->end));
+            }
+        }
+        if (!segment->producer || !segment->producer->is_valid()) {
+            m_errorMessage.append(i18n("Invalid clip"));
+            m_successful = false;
+            m_done = true;
+            length = total;
+            return false;
+        }
+        // Let the job configure a consumer and filter for this segment
+        length = segment->end - segment->offset + 1;
+        configureConsumer();
+        configureFilter();
+        segment->consumer = std::move(m_consumer);
+        segment->filter = std::move(m_filter);
+        if ((segment->consumer == nullptr) || !segment->consumer->is_valid()) {
+            m_errorMessage.append(i18n("Cannot create consumer."));
+            m_successful = false;
+            m_done = true;
+            length = total;
+            return false;
+        }
+        if (m_requiresFilter && (segment->filter == nullptr || !segment->filter->is_valid())) {
+            m_errorMessage.append(i18n("Cannot create filter."));
+            m_successful = false;
+            m_done = true;
+            length = total;
+            return false;
+        }
+        segment->tractor = std::make_unique<Mlt::Tractor>(*m_profile.get());
+        segment->tractor->set_track(*segment->producer.get(), 0);
+        segment->consumer->connect(*segment->tractor.get());
+        segment->producer->set_speed(0);
+        segment->producer->seek(0);
+        if (segment->filter) {
+            segment->producer->attach(*segment->filter.get());
+        }
+        segment->showFrameEvent.reset(segment->consumer->listen("consumer-frame-show", segment.get(), (mlt_listener)segment_frame_render));
+        segments.push_back(std::move(segment));
+    }
+    length = total;
+
+    // The consumers are stopped by the threads running them, the cancel signal only raises the flag
+    QMetaObject::Connection cancelConnection = connect(this, &MeltJob::jobCanceled, [&canceled]() { canceled = true; });
+    // Use a private pool, the job itself already occupies a thread of the global one
+    QThreadPool pool;
+    pool.setMaxThreadCount(count);
+    for (auto &segment : segments) {
+        AnalysisSegment *current = segment.get();
+        QtConcurrent::run(&pool, [current]() {
+            current->consumer->start();
+            while (!current->consumer->is_stopped()) {
+                if (*current->canceled) {
+                    current->showFrameEvent.reset();
+                    current->consumer->stop();
+                    break;
+                }
+                QThread::msleep(50);
+            }
+        });
+    }
+    pool.waitForDone();
+    disconnect(cancelConnection);
+    if (canceled) {
+        m_successful = false;
+        m_done = true;
+        return false;
+    }
+    for (auto &segment : segments) {
+        if (segment->filter) {
+            mergeSegment(*segment->filter.get(), segment->offset, segment->start, segment->end);
+        }
+    }
+    m_successful = m_done = true;
+    return true;
+}
@@ -68,6 +68,31 @@ protected:
     // @brief create and configure filter
     virtual void configureFilter() = 0;
 
+    /** @brief Return true if the results of the filter on separate parts of the clip can be merged.
+        The clip is then split in segments that are analysed in parallel, each with its own producer, filter and consumer */
+    virtual bool canAnalyseSegments() const { return false; }
+
+    /** @brief Number of frames analysed before each segment (except the first one) for filters that compare a frame with the previous ones.
+        Results falling in this overlap belong to the previous segment and must be dropped */
+    virtual int segmentOverlap() const { return 0; }
+
+    /** @brief Collect the results of a segment. Called in segment order once all segments are processed, so merging is deterministic
+        @param filter the filter that analysed the segment
+        @param offset the clip frame corresponding to the first frame of the segment producer
+        @param start first clip frame that belongs to this segment
+        @param end last clip frame that belongs to this segment */
+    virtual void mergeSegment(Mlt::Filter &filter, int offset, int start, int end)
+    {
+        Q_UNUSED(filter)
+        Q_UNUSED(offset)
+        Q_UNUSED(start)
+        Q_UNUSED(end)
+    }
+
+private:
+    // @brief run the analysis of a clip in parallel segments, see canAnalyseSegments()
+    bool analyseSegments();
+
 protected:
     std::unique_ptr<Mlt::Consumer> m_consumer;
     std::unique_ptr<Mlt::Producer> m_producer;
@@ -27,10 +27,10 @@
 #include "kdenlive_debug.h"
 #include "kdenlivesettings.h"
 #include "macros.hpp"
+#include "proxyscheduler.h"
 
 #include <QProcess>
 #include <QTemporaryFile>
-#include <QThread>
 
 #include <klocalizedstring.h>
 
@@ -40,7 +40,20 @@ ProxyJob::ProxyJob(const QString &binId)
     , m_isFfmpegJob(true)
     , m_jobProcess(nullptr)
     , m_done(false)
+    , m_priority(0)
+    , m_canceled(false)
 {
+    auto binClip = pCore->projectItemModel()->getClipByBinID(binId);
+    if (binClip) {
+        m_priority = ProxyScheduler::priority(binClip);
+    }
+    connect(this, &ProxyJob::jobCanceled, this, [this]() { m_canceled = true; }, Qt::DirectConnection);
+}
+
+static bool usesHardwareEncoder(const QString &params)
+{
+    return params.contains(QLatin1String("nvenc")) || params.contains(QLatin1String("vaapi")) || params.contains(QLatin1String("_qsv")) ||
+           params.contains(QLatin1String("_amf"));
 }
 
 const QString ProxyJob::getDescription() const
@@ -58,8 +71,15 @@ bool ProxyJob::startJob()
         m_done = true;
         return true;
     }
+    // Encodes write to a temporary file that is renamed once complete. A leftover one means an encode was interrupted, start it over
+    const QString partial = ProxyScheduler::partialPath(dest);
+    if (QFile::exists(partial)) {
+        qCDebug(KDENLIVE_LOG) << "Restarting interrupted proxy encode:" << dest;
+        QFile::remove(partial);
+    }
     ClipType::ProducerType type = binClip->clipType();
     bool result;
+    bool hardware = false;
     QString source = binClip->getProducerProperty(QStringLiteral("kdenlive:originalurl"));
     int exif = binClip->getProducerIntProperty(QStringLiteral("_exif_orientation"));
     if (type == ClipType::Playlist || type == ClipType::SlideShow) {
@@ -87,7 +107,7 @@ bool ProxyJob::startJob()
         }
         mltParameters << source;
         // set destination
-        mltParameters << QStringLiteral("-consumer") << QStringLiteral("avformat:") + dest;
+        mltParameters << QStringLiteral("-consumer") << QStringLiteral("avformat:") + partial;
         QString parameter = pCore->currentDoc()->getDocumentProperty(QStringLiteral("proxyparams")).simplified();
         if (parameter.isEmpty()) {
             // Automatic setting, decide based on hw support
@@ -100,6 +120,7 @@ bool ProxyJob::startJob()
                 parameter.prepend(QStringLiteral("-pix_fmt yuv420p"));
             }
         }
+        hardware = usesHardwareEncoder(parameter);
 #if QT_VERSION < QT_VERSION_CHECK(5, 15, 0)
         QStringList params = parameter.split(QLatin1Char('-'), QString::SkipEmptyParts);
 #else
@@ -144,12 +165,7 @@ bool ProxyJob::startJob()
             }
             mltParameters << t;
         }
-        int threadCount = QThread::idealThreadCount();
-        if (threadCount > 2) {
-            threadCount = qMin(threadCount - 1, 4);
-        } else {
-            threadCount = 1;
-        }
+        int threadCount = ProxyScheduler::get()->threadsPerEncode();
         mltParameters.append(QStringLiteral("real_time=-%1").arg(threadCount));
         mltParameters.append(QStringLiteral("threads=%1").arg(threadCount));
         mltParameters.append(QStringLiteral("terminate_on_pause=1"));
@@ -160,12 +176,19 @@ bool ProxyJob::startJob()
         // Ask for progress reporting
         mltParameters << QStringLiteral("progress=1");
 
+        if (!ProxyScheduler::get()->acquire(m_priority, hardware, m_canceled)) {
+            // Canceled while waiting for our turn
+            delete playlist;
+            m_done = false;
+            return false;
+        }
         m_jobProcess = new QProcess;
         // m_jobProcess->setProcessChannelMode(QProcess::MergedChannels);
         connect(this, &ProxyJob::jobCanceled, m_jobProcess, &QProcess::kill, Qt::DirectConnection);
         connect(m_jobProcess, &QProcess::readyReadStandardError, this, &ProxyJob::processLogInfo);
         m_jobProcess->start(KdenliveSettings::rendererpath(), mltParameters);
         m_jobProcess->waitForFinished(-1);
+        ProxyScheduler::get()->release(hardware);
         result = m_jobProcess->exitStatus() == QProcess::NormalExit;
         delete playlist;
     } else if (type == ClipType::Image) {
@@ -233,6 +256,9 @@ bool ProxyJob::startJob()
         }
         // Only output error data, make sure we don't block when proxy file already exists
         QStringList parameters = {QStringLiteral("-hide_banner"), QStringLiteral("-y"), QStringLiteral("-stats"), QStringLiteral("-v"), QStringLiteral("error")};
+        // Placed before the input, this limits the decoding threads
+        const QString threads = QString::number(ProxyScheduler::get()->threadsPerEncode());
+        parameters << QStringLiteral("-threads") << threads;
         m_jobDuration = (int)binClip->duration().seconds();
         QString proxyParams = pCore->currentDoc()->getDocumentProperty(QStringLiteral("proxyparams")).simplified();
         if (proxyParams.isEmpty()) {
@@ -290,29 +316,46 @@ bool ProxyJob::startJob()
 
         // Make sure we keep the stream order
         parameters << QStringLiteral("-sn") << QStringLiteral("-dn") << QStringLiteral("-map") << QStringLiteral("0");
-        parameters << dest;
+        if (!proxyParams.contains(QLatin1String("-threads "))) {
+            // Encoding threads
+            parameters << QStringLiteral("-threads") << threads;
+        }
+        parameters << partial;
         qDebug()<<"/// FULL PROXY PARAMS:\n"<<parameters<<"\n------";
+        hardware = usesHardwareEncoder(proxyParams);
+        if (!ProxyScheduler::get()->acquire(m_priority, hardware, m_canceled)) {
+            // Canceled while waiting for our turn
+            m_done = false;
+            return false;
+        }
         m_jobProcess = new QProcess;
         // m_jobProcess->setProcessChannelMode(QProcess::MergedChannels);
         connect(m_jobProcess, &QProcess::readyReadStandardError, this, &ProxyJob::processLogInfo);
         connect(this, &ProxyJob::jobCanceled, m_jobProcess, &QProcess::kill, Qt::DirectConnection);
         m_jobProcess->start(KdenliveSettings::ffmpegpath(), parameters, QIODevice::ReadOnly);
         m_jobProcess->waitForFinished(-1);
+        ProxyScheduler::get()->release(hardware);
         result = m_jobProcess->exitStatus() == QProcess::NormalExit;
     }
     // remove temporary playlist if it exists
     if (result) {
-        if (QFileInfo(dest).size() == 0) {
-            QFile::remove(dest);
+        if (QFileInfo(partial).size() == 0) {
+            QFile::remove(partial);
             // File was not created
             m_done = false;
             m_errorMessage.append(i18n("Failed to create proxy clip."));
         } else {
-            m_done = true;
+            // Replace a previous proxy when overwriting
+            QFile::remove(dest);
+            m_done = QFile::rename(partial, dest);
+            if (!m_done) {
+                QFile::remove(partial);
+                m_errorMessage.append(i18n("Failed to create proxy clip."));
+            }
         }
     } else {
         // Proxy process crashed
-        QFile::remove(dest);
+        QFile::remove(partial);
         m_done = false;
         m_errorMessage.append(QString::fromUtf8(m_jobProcess->readAll()));
     }
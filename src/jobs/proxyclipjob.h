@@ -23,6 +23,8 @@
 
 #include "abstractclipjob.h"
 
+#include <atomic>
+
 class QProcess;
 
 class ProxyJob : public AbstractClipJob
@@ -45,6 +47,9 @@ private:
     bool m_isFfmpegJob;
     QProcess *m_jobProcess;
     bool m_done;
+    /** @brief Order of this job in the proxy queue, see ProxyScheduler::priority() */
+    qint64 m_priority;
+    std::atomic_bool m_canceled;
 };
 
 #endif
@@ -0,0 +1,169 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by agent <agent@local>                             *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "proxyscheduler.h"
+#include "abstractclipjob.h"
+#include "bin/projectclip.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QFutureInterface>
+#include <QThread>
+#include <QtConcurrent>
+#include <algorithm>
+
+// Consumer graphics cards only accept a few concurrent encoding sessions
+static const int maxHardwareEncodes = 2;
+// Clips not used in the timeline are always processed after the used ones
+static const qint64 unusedClipPenalty = qint64(1) << 40;
+
+std::unique_ptr<ProxyScheduler> ProxyScheduler::instance;
+std::once_flag ProxyScheduler::m_onceFlag;
+
+ProxyScheduler::ProxyScheduler()
+    : m_nextTicket(0)
+    , m_running(0)
+    , m_runningHardware(0)
+{
+    int cores = qMax(1, QThread::idealThreadCount());
+    // Encoders scale poorly beyond a few threads at proxy resolutions, running more encodes side by side is faster
+    m_threadsPerEncode = qBound(1, cores / 4, 4);
+    m_maxEncodes = qMax(1, cores / m_threadsPerEncode);
+    m_pool.setMaxThreadCount(m_maxEncodes + maxHardwareEncodes);
+}
+
+std::unique_ptr<ProxyScheduler> &ProxyScheduler::get()
+{
+    std::call_once(m_onceFlag, [] { instance.reset(new ProxyScheduler()); });
+    return instance;
+}
+
+int ProxyScheduler::threadsPerEncode() const
+{
+    return m_threadsPerEncode;
+}
+
+qint64 ProxyScheduler::priority(const std::shared_ptr<ProjectClip> &clip)
+{
+    qint64 value = qint64(clip->frameDuration());
+    if (clip->timelineInstances().isEmpty()) {
+        value += unusedClipPenalty;
+    }
+    return value;
+}
+
+void ProxyScheduler::sortByPriority(QList<std::shared_ptr<ProjectClip>> &clips)
+{
+    std::vector<std::pair<qint64, std::shared_ptr<ProjectClip>>> sorted;
+    sorted.reserve(size_t(clips.size()));
+    for (const auto &clip : qAsConst(clips)) {
+        sorted.emplace_back(priority(clip), clip);
+    }
+    std::stable_sort(sorted.begin(), sorted.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+    clips.clear();
+    for (const auto &s : sorted) {
+        clips << s.second;
+    }
+}
+
+QFuture<bool> ProxyScheduler::run(const std::vector<std::shared_ptr<AbstractClipJob>> &jobs)
+{
+    auto future = std::make_shared<QFutureInterface<bool>>();
+    future->reportStarted();
+    if (jobs.empty()) {
+        future->reportFinished();
+        return future->future();
+    }
+    auto remaining = std::make_shared<std::atomic_int>(int(jobs.size()));
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        QtConcurrent::run(&m_pool, [future, remaining, job = jobs[i], index = int(i)]() {
+            // Results of a canceled future are dropped, the job manager handles the cancelation
+            if (!future->isCanceled()) {
+                future->reportResult(AbstractClipJob::execute(job), index);
+            }
+            if (--(*remaining) == 0) {
+                future->reportFinished();
+            }
+        });
+    }
+    return future->future();
+}
+
+bool ProxyScheduler::isNext(quint64 ticket) const
+{
+    if (m_running >= m_maxEncodes) {
+        return false;
+    }
+    const Waiter *best = nullptr;
+    for (const Waiter &w : m_waiting) {
+        if (w.hardware && m_runningHardware >= maxHardwareEncodes) {
+            // This one cannot start yet, don't let it block the others
+            continue;
+        }
+        if (best == nullptr || w.priority < best->priority || (w.priority == best->priority && w.ticket < best->ticket)) {
+            best = &w;
+        }
+    }
+    return best != nullptr && best->ticket == ticket;
+}
+
+bool ProxyScheduler::acquire(qint64 priority, bool hardware, const std::atomic_bool &canceled)
+{
+    QMutexLocker lk(&m_mutex);
+    quint64 ticket = m_nextTicket++;
+    m_waiting.push_back({priority, ticket, hardware});
+    auto removeWaiter = [this, ticket]() {
+        m_waiting.erase(std::remove_if(m_waiting.begin(), m_waiting.end(), [ticket](const Waiter &w) { return w.ticket == ticket; }), m_waiting.end());
+    };
+    while (!isNext(ticket)) {
+        if (canceled) {
+            removeWaiter();
+            // We may have been the next in line
+            m_slotFreed.wakeAll();
+            return false;
+        }
+        m_slotFreed.wait(&m_mutex, 250);
+    }
+    removeWaiter();
+    m_running++;
+    if (hardware) {
+        m_runningHardware++;
+    }
+    return true;
+}
+
+void ProxyScheduler::release(bool hardware)
+{
+    QMutexLocker lk(&m_mutex);
+    m_running--;
+    if (hardware) {
+        m_runningHardware--;
+    }
+    m_slotFreed.wakeAll();
+}
+
+QString ProxyScheduler::partialPath(const QString &dest)
+{
+    // Keep the extension, encoders use it to select the output format
+    QFileInfo info(dest);
+    return info.absoluteDir().absoluteFilePath(info.completeBaseName() + QStringLiteral(".part.") + info.suffix());
+}
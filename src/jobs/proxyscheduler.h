@@ -0,0 +1,113 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by agent <agent@local>                             *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef PROXYSCHEDULER_H
+#define PROXYSCHEDULER_H
+
+#include <QFuture>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QThreadPool>
+#include <QWaitCondition>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class AbstractClipJob;
+class ProjectClip;
+
+/**
+ * @class ProxyScheduler
+ * @brief Decides how many proxy encodes run at once and how many threads each of them may use.
+ * The CPU is split into a fixed number of encode slots, each encoder process being told to use
+ * threadsPerEncode() threads. A proxy job blocks in acquire() until a slot is free, slots being
+ * handed out by priority: clips used in the timeline first, then the shortest clips. Proxy jobs
+ * run on their own thread pool, so that jobs waiting for a slot or for their encoder process never
+ * hold a thread of the global pool used by the other clip jobs.
+ * Note that this class is a Singleton
+ */
+
+class ProxyScheduler
+{
+
+public:
+    // Returns the instance of the Singleton
+    static std::unique_ptr<ProxyScheduler> &get();
+
+    /** @brief Number of threads passed to each encoder process */
+    int threadsPerEncode() const;
+
+    /** @brief Returns a priority for the proxy of this clip, lower values are processed first.
+     *  Must be called from the main thread
+     */
+    static qint64 priority(const std::shared_ptr<ProjectClip> &clip);
+    /** @brief Sort a list of clips in the order their proxies should be created */
+    static void sortByPriority(QList<std::shared_ptr<ProjectClip>> &clips);
+
+    /** @brief Run proxy jobs on the proxy thread pool, as QtConcurrent::mapped would do on the global pool.
+     *  @return a future with the result of AbstractClipJob::execute() for each job
+     */
+    QFuture<bool> run(const std::vector<std::shared_ptr<AbstractClipJob>> &jobs);
+
+    /** @brief Block until an encode slot is available.
+     *  @param priority the value returned by priority() for the clip
+     *  @param hardware true if the encode uses a hardware encoder, which only supports a few concurrent sessions
+     *  @param canceled checked while waiting, we give up as soon as it is set
+     *  @return false if the wait was canceled, otherwise release() must be called once the encode is finished
+     */
+    bool acquire(qint64 priority, bool hardware, const std::atomic_bool &canceled);
+    void release(bool hardware);
+
+    /** @brief The file an encode writes to before it is complete.
+     *  It is renamed to @param dest on success, so that an interrupted encode never leaves a truncated proxy behind
+     */
+    static QString partialPath(const QString &dest);
+
+private:
+    ProxyScheduler();
+    static std::unique_ptr<ProxyScheduler> instance;
+    static std::once_flag m_onceFlag; // flag to create the scheduler only once
+
+    struct Waiter
+    {
+        qint64 priority;
+        quint64 ticket;
+        bool hardware;
+    };
+    /** @brief Runs the proxy jobs, a few more threads than encode slots so that waiting jobs can be reordered by priority */
+    QThreadPool m_pool;
+    QMutex m_mutex;
+    QWaitCondition m_slotFreed;
+    /** @brief Jobs waiting for a slot, in arrival order */
+    std::vector<Waiter> m_waiting;
+    quint64 m_nextTicket;
+    int m_running;
+    int m_runningHardware;
+    int m_threadsPerEncode;
+    int m_maxEncodes;
+
+    /** @brief Returns true if @param ticket is the waiter that should get the next free slot */
+    bool isNext(quint64 ticket) const;
+};
+
+#endif
@@ -76,8 +76,40 @@ void SceneSplitJob::configureFilter()
 
 void SceneSplitJob::configureProfile()
 {
-    m_profile->set_height(160);
-    m_profile->set_width(m_profile->height() * m_profile->sar());
+    // Shot detection does not need details, analyse a small image with the clip's display ratio
+    int height = 160;
+    int width = int(height * m_profile->dar() / m_profile->sar() + 0.5);
+    width += width % 2;
+    m_profile->set_height(height);
+    m_profile->set_width(width);
+}
+
+bool SceneSplitJob::canAnalyseSegments() const
+{
+    return true;
+}
+
+int SceneSplitJob::segmentOverlap() const
+{
+    // One second is enough for the motion estimation to settle after the segment start
+    return qRound(m_profile->fps());
+}
+
+void SceneSplitJob::mergeSegment(Mlt::Filter &filter, int offset, int start, int end)
+{
+#if QT_VERSION < QT_VERSION_CHECK(5, 15, 0)
+    const QStringList changes = QString::fromLatin1(filter.get("shot_change_list")).split(QLatin1Char(';'), QString::SkipEmptyParts);
+#else
+    const QStringList changes = QString::fromLatin1(filter.get("shot_change_list")).split(QLatin1Char(';'), Qt::SkipEmptyParts);
+#endif
+    for (const QString &change : changes) {
+        int pos = offset + change.section(QLatin1Char('='), 0, 0).toInt();
+        if (pos < start || pos > end) {
+            // Detected in the overlap, already reported by the previous segment
+            continue;
+        }
+        m_shotChanges << QStringLiteral("%1=%2").arg(pos).arg(change.section(QLatin1Char('='), 1));
+    }
 }
 
 // static
@@ -118,7 +150,7 @@ bool SceneSplitJob::commitResult(Fun &undo, Fun &redo)
     if (!m_successful) {
         return false;
     }
-    QString result = QString::fromLatin1(m_filter->get("shot_change_list"));
+    QString result = m_shotChanges.join(QLatin1Char(';'));
     if (result.isEmpty()) {
         m_errorMessage.append(i18n("No data returned from clip analysis"));
         return false;
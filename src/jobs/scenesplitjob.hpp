@@ -63,8 +63,15 @@ protected:
     // @brief extra configuration of the profile (eg: resize the profile)
     void configureProfile() override;
 
+    // @brief shot changes only depend on the neighbouring frames, so the clip can be analysed in parallel segments
+    bool canAnalyseSegments() const override;
+    int segmentOverlap() const override;
+    void mergeSegment(Mlt::Filter &filter, int offset, int start, int end) override;
+
     bool m_subClips;
     int m_markersType;
     // @brief minimum scene duration.
     int m_minInterval;
+    // @brief detected shot changes, as pos=value entries sorted by position
+    QStringList m_shotChanges;
 };
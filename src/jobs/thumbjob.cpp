@@ -110,6 +110,7 @@ bool ThumbJob::startJob()
     int max = m_prod->get_length();
     m_frameNumber = m_binClip->clipType() == ClipType::Image ? 0 : qMin(m_frameNumber, max - 1);
 
+    QMutexLocker seekLock(m_binClip->thumbSeekMutex());
     if (m_frameNumber > 0) {
         m_prod->seek(m_frameNumber);
     }
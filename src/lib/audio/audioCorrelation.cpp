@@ -14,8 +14,14 @@ the Free Software Foundation, either version 3 of the License, or
 #include "kdenlive_debug.h"
 #include "klocalizedstring.h"
 #include <QElapsedTimer>
+#include <QtConcurrent>
 #include <cmath>
 #include <iostream>
+#include <vector>
+
+// Envelopes longer than this (in frames, about 20 minutes at 25fps) are correlated coarse to fine
+static const size_t coarseCorrelationThreshold = 30000;
+static const size_t coarseCorrelationFactor = 16;
 
 AudioCorrelation::AudioCorrelation(std::unique_ptr<AudioEnvelope> mainTrackEnvelope)
     : m_mainTrackEnvelope(std::move(mainTrackEnvelope))
@@ -27,6 +33,9 @@ AudioCorrelation::AudioCorrelation(std::unique_ptr<AudioEnvelope> mainTrackEnvel
 
 AudioCorrelation::~AudioCorrelation()
 {
+    for (QFuture<void> &future : m_pendingCorrelations) {
+        future.waitForFinished();
+    }
     for (AudioEnvelope *envelope : qAsConst(m_children)) {
         delete envelope;
     }
@@ -53,6 +62,17 @@ void AudioCorrelation::addChild(AudioEnvelope *envelope)
 }
 
 void AudioCorrelation::slotProcessChild(AudioEnvelope *envelope)
+{
+    // Forget the finished computations
+    for (int i = m_pendingCorrelations.size() - 1; i >= 0; --i) {
+        if (m_pendingCorrelations.at(i).isFinished()) {
+            m_pendingCorrelations.removeAt(i);
+        }
+    }
+    m_pendingCorrelations << QtConcurrent::run(this, &AudioCorrelation::processChild, envelope);
+}
+
+void AudioCorrelation::processChild(AudioEnvelope *envelope)
 {
     // Note that at this point the computation of the envelope of the
     // main track might not be finished. envelope() will block until
@@ -67,20 +87,25 @@ void AudioCorrelation::slotProcessChild(AudioEnvelope *envelope)
     const std::vector<qint64> &envSub = envelope->envelope();
     qint64 max = 0;
 
-    if (sizeSub > 200) {
+    if (sizeMain + sizeSub > coarseCorrelationThreshold && sizeSub > 200) {
+        correlateCoarseToFine(&envMain[0], sizeMain, &envSub[0], sizeSub, correlation, coarseCorrelationFactor);
+    } else if (sizeSub > 200) {
         FFTCorrelation::correlate(&envMain[0], sizeMain, &envSub[0], sizeSub, correlation);
     } else {
         correlate(&envMain[0], sizeMain, &envSub[0], sizeSub, correlation, &max);
         info->setMax(max);
     }
 
-    m_children.append(envelope);
-    m_correlations.append(info);
+    // Results are collected in the main thread
+    QMetaObject::invokeMethod(this, [this, envelope, info]() {
+        m_children.append(envelope);
+        m_correlations.append(info);
 
-    Q_ASSERT(m_correlations.size() == m_children.size());
-    int index = m_children.indexOf(envelope);
-    int shift = getShift(index);
-    emit gotAudioAlignData(envelope->clipId(), shift);
+        Q_ASSERT(m_correlations.size() == m_children.size());
+        int index = m_children.indexOf(envelope);
+        int shift = getShift(index);
+        emit gotAudioAlignData(envelope->clipId(), shift);
+    }, Qt::QueuedConnection);
 }
 
 int AudioCorrelation::getShift(int childIndex) const
@@ -160,3 +185,57 @@ void AudioCorrelation::correlate(const qint64 *envMain, size_t sizeMain, const q
         *out_max = max;
     }
 }
+
+qint64 AudioCorrelation::correlationAt(const qint64 *envMain, size_t sizeMain, const qint64 *envSub, size_t sizeSub, int shift)
+{
+    qint64 const *left;
+    qint64 const *right;
+    int size;
+    if (shift <= 0) {
+        left = envSub - shift;
+        right = envMain;
+        size = std::min((int)sizeSub + shift, (int)sizeMain);
+    } else {
+        left = envSub;
+        right = envMain + shift;
+        size = std::min((int)sizeSub, (int)sizeMain - shift);
+    }
+    qint64 sum = 0;
+    for (int i = 0; i < size; ++i) {
+        sum += left[i] * right[i];
+    }
+    return sum;
+}
+
+void AudioCorrelation::correlateCoarseToFine(const qint64 *envMain, size_t sizeMain, const qint64 *envSub, size_t sizeSub, qint64 *correlation, size_t factor)
+{
+    Q_ASSERT(correlation != nullptr);
+    QElapsedTimer t;
+    t.start();
+    std::fill(correlation, correlation + sizeMain + sizeSub + 1, 0);
+
+    // Decimate both envelopes by summing blocks of frames
+    const size_t coarseMain = (sizeMain + factor - 1) / factor;
+    const size_t coarseSub = (sizeSub + factor - 1) / factor;
+    std::vector<qint64> decimatedMain(coarseMain, 0);
+    std::vector<qint64> decimatedSub(coarseSub, 0);
+    for (size_t i = 0; i < sizeMain; ++i) {
+        decimatedMain[i / factor] += envMain[i];
+    }
+    for (size_t i = 0; i < sizeSub; ++i) {
+        decimatedSub[i / factor] += envSub[i];
+    }
+    std::vector<qint64> coarseCorrelation(coarseMain + coarseSub + 1);
+    FFTCorrelation::correlate(decimatedMain.data(), coarseMain, decimatedSub.data(), coarseSub, coarseCorrelation.data());
+    size_t coarseIndex = size_t(std::max_element(coarseCorrelation.begin(), coarseCorrelation.end()) - coarseCorrelation.begin());
+    const int coarseShift = (int)coarseIndex - (int)coarseSub;
+
+    // Refine at full resolution in a window of two blocks around the coarse result
+    const int window = 2 * (int)factor;
+    const int from = std::max(-(int)sizeSub, coarseShift * (int)factor - window);
+    const int to = std::min((int)sizeMain, coarseShift * (int)factor + window);
+    for (int shift = from; shift <= to; ++shift) {
+        correlation[sizeSub + (size_t)shift] = qAbs(correlationAt(envMain, sizeMain, envSub, sizeSub, shift));
+    }
+    qCDebug(KDENLIVE_LOG) << "Coarse to fine correlation calculated. Time taken: " << t.elapsed() << " ms.";
+}
@@ -14,6 +14,7 @@
 #include "audioCorrelationInfo.h"
 #include "audioEnvelope.h"
 #include "definitions.h"
+#include <QFuture>
 #include <QList>
 
 /**
@@ -62,17 +63,33 @@ public:
       */
     static void correlate(const qint64 *envMain, size_t sizeMain, const qint64 *envSub, size_t sizeSub, qint64 *correlation, qint64 *out_max = nullptr);
 
+    /**
+      Correlates long envelopes in two passes: a FFT correlation of
+      envelopes decimated by \c factor finds the approximate shift, which
+      is then refined at full resolution around that shift only.
+      Only the refined window of \c correlation is filled, other entries are 0.
+      \c correlation must be a pre-allocated vector of size sizeMain+sizeSub+1.
+      */
+    static void correlateCoarseToFine(const qint64 *envMain, size_t sizeMain, const qint64 *envSub, size_t sizeSub, qint64 *correlation, size_t factor);
+
 private:
     std::unique_ptr<AudioEnvelope> m_mainTrackEnvelope;
 
     QList<AudioEnvelope *> m_children;
     QList<AudioCorrelationInfo *> m_correlations;
+    /** @brief Running correlations, children are correlated in parallel */
+    QList<QFuture<void>> m_pendingCorrelations;
+
+    /** @brief Computes the correlation of a child with the reference envelope, runs in a worker thread. */
+    void processChild(AudioEnvelope *envelope);
+    /** @brief Returns the cross correlation value of the two envelopes for a given shift */
+    static qint64 correlationAt(const qint64 *envMain, size_t sizeMain, const qint64 *envSub, size_t sizeSub, int shift);
 
 private slots:
     /**
      This is invoked when the child envelope is computed. This
-     triggers the actual computations of the cross-correlation for
-     aligning the envelope to the reference envelope.
+     starts the actual computations of the cross-correlation for
+     aligning the envelope to the reference envelope in a worker thread.
 
      Takes ownership of @p envelope.
    */
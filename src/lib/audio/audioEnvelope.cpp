@@ -13,28 +13,53 @@
 #include "bin/bin.h"
 #include "bin/projectclip.h"
 #include "core.h"
+#include "doc/kdenlivedoc.h"
 #include "kdenlive_debug.h"
+#include <QCache>
+#include <QDataStream>
+#include <QFile>
 #include <QImage>
 #include <QElapsedTimer>
+#include <QMutex>
+#include <QSaveFile>
 #include <QtConcurrent>
 #include <KLocalizedString>
 #include <algorithm>
+#include <climits>
 #include <cmath>
 #include <memory>
 
+namespace {
+// Bump when the envelope computation changes
+const quint32 envelopeCacheVersion = 1;
+// Raw envelopes kept in memory, the cost is the number of frames
+QCache<QString, std::vector<qint64>> envelopeMemoryCache(2000000);
+QMutex envelopeCacheMutex;
+} // namespace
+
 AudioEnvelope::AudioEnvelope(const QString &binId, int clipId, size_t offset, size_t length, size_t startPos)
     : m_offset(offset)
     , m_clipId(clipId)
     , m_startpos(startPos)
+    , m_zoneIn(0)
+    , m_useZone(false)
 {
     std::shared_ptr<ProjectClip> clip = pCore->bin()->getBinClip(binId);
     m_producer = clip->cloneProducer();
     if (length > 2000) {
         // Analyse on timeline clip zone only
         m_offset = 0;
+        m_zoneIn = offset;
+        m_useZone = true;
         m_producer->set_in_and_out((int) offset, (int) (offset + length));
     }
     m_envelopeSize = (size_t)m_producer->get_playtime();
+    bool ok = false;
+    QDir cacheDir = pCore->currentDoc()->getCacheDir(CacheAudio, &ok);
+    if (ok) {
+        // Same naming scheme as the audio thumbnails
+        m_cacheFile = cacheDir.absoluteFilePath(QStringLiteral("%1_%2.envelope").arg(clip->hash()).arg(clip->getProducerIntProperty(QStringLiteral("audio_index"))));
+    }
 
     m_producer->set("set.test_image", 1);
     connect(&m_watcher, &QFutureWatcherBase::finished, this, [this] { emit envelopeReady(this); });
@@ -98,10 +123,44 @@ const std::vector<qint64> &AudioEnvelope::envelope()
 AudioEnvelope::AudioSummary AudioEnvelope::loadAndNormalizeEnvelope() const
 {
     qCDebug(KDENLIVE_LOG) << "Loading envelope ...";
-    AudioSummary summary(m_envelopeSize);
-    if (!m_info || m_info->size() < 1) {
+    AudioSummary summary;
+    std::vector<qint64> full;
+    if (loadCachedEnvelope(full)) {
+        // Reuse the envelope of the whole clip, only keeping our zone
+        size_t start = std::min(m_useZone ? m_zoneIn : 0, full.size());
+        size_t end = std::min(start + m_envelopeSize, full.size());
+        summary.audioAmplitudes.assign(full.begin() + (long)start, full.begin() + (long)end);
+        summary.audioAmplitudes.resize(m_envelopeSize, 0);
+    } else {
+        summary.audioAmplitudes = computeRawEnvelope();
+        if (!m_useZone) {
+            storeCachedEnvelope(summary.audioAmplitudes);
+        }
+    }
+    if (summary.audioAmplitudes.empty()) {
         return summary;
     }
+    qCDebug(KDENLIVE_LOG) << "Normalizing envelope ...";
+    const qint64 meanBeforeNormalization =
+        std::accumulate(summary.audioAmplitudes.begin(), summary.audioAmplitudes.end(), 0LL) / (qint64)summary.audioAmplitudes.size();
+
+    // Normalize the envelope.
+    summary.amplitudeMax = 0;
+    size_t max = summary.audioAmplitudes.size();
+    for (size_t i = 0; i < max; ++i) {
+        summary.audioAmplitudes[i] -= meanBeforeNormalization;
+        summary.amplitudeMax = std::max(summary.amplitudeMax, qAbs(summary.audioAmplitudes[i]));
+    }
+    pCore->displayMessage(i18n("Audio analysis finished"), OperationCompletedMessage, 300);
+    return summary;
+}
+
+std::vector<qint64> AudioEnvelope::computeRawEnvelope() const
+{
+    std::vector<qint64> envelope(m_envelopeSize, 0);
+    if (!m_info || m_info->size() < 1) {
+        return envelope;
+    }
     int samplingRate = m_info->info(0)->samplingRate();
     mlt_audio_format format_s16 = mlt_audio_s16;
     int channels = 1;
@@ -109,32 +168,79 @@ AudioEnvelope::AudioSummary AudioEnvelope::loadAndNormalizeEnvelope() const
     QElapsedTimer t;
     t.start();
     m_producer->seek(0);
-    size_t max = summary.audioAmplitudes.size();
+    size_t max = envelope.size();
+    int lastProgress = -1;
     for (size_t i = 0; i < max; ++i) {
         std::unique_ptr<Mlt::Frame> frame(m_producer->get_frame((int)i));
         qint64 position = mlt_frame_get_position(frame->get_frame());
         int samples = mlt_sample_calculator(m_producer->get_fps(), samplingRate, position);
         auto *data = static_cast<qint16 *>(frame->get_audio(format_s16, samplingRate, channels, samples));
 
-        summary.audioAmplitudes[i] = 0;
+        qint64 sum = 0;
         for (int k = 0; k < samples; ++k) {
-            summary.audioAmplitudes[i] += abs(data[k]);
+            sum += abs(data[k]);
+        }
+        envelope[i] = sum;
+        // Only notify on progress change, this is called for each frame of possibly very long clips
+        int progress = (int) (100 * i / max);
+        if (progress != lastProgress) {
+            lastProgress = progress;
+            pCore->displayMessage(i18n("Processing data analysis"), ProcessingJobMessage, progress);
         }
-        pCore->displayMessage(i18n("Processing data analysis"), ProcessingJobMessage, (int) (100 * i / max));
     }
     qCDebug(KDENLIVE_LOG) << "Calculating the envelope (" << m_envelopeSize << " frames) took " << t.elapsed() << " ms.";
-    qCDebug(KDENLIVE_LOG) << "Normalizing envelope ...";
-    const qint64 meanBeforeNormalization =
-        std::accumulate(summary.audioAmplitudes.begin(), summary.audioAmplitudes.end(), 0LL) / (qint64)summary.audioAmplitudes.size();
+    return envelope;
+}
 
-    // Normalize the envelope.
-    summary.amplitudeMax = 0;
-    for (size_t i = 0; i < max; ++i) {
-        summary.audioAmplitudes[i] -= meanBeforeNormalization;
-        summary.amplitudeMax = std::max(summary.amplitudeMax, qAbs(summary.audioAmplitudes[i]));
+bool AudioEnvelope::loadCachedEnvelope(std::vector<qint64> &envelope) const
+{
+    if (m_cacheFile.isEmpty()) {
+        return false;
+    }
+    QMutexLocker lock(&envelopeCacheMutex);
+    std::vector<qint64> *cached = envelopeMemoryCache.object(m_cacheFile);
+    if (cached) {
+        envelope = *cached;
+        return true;
+    }
+    QFile file(m_cacheFile);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream in(&file);
+    quint32 version;
+    double fps;
+    quint64 count;
+    in >> version >> fps >> count;
+    if (version != envelopeCacheVersion || !qFuzzyCompare(fps, m_producer->get_fps()) || count == 0) {
+        return false;
+    }
+    envelope.resize(count);
+    if (in.readRawData(reinterpret_cast<char *>(envelope.data()), int(count * sizeof(qint64))) != int(count * sizeof(qint64))) {
+        envelope.clear();
+        return false;
+    }
+    envelopeMemoryCache.insert(m_cacheFile, new std::vector<qint64>(envelope), int(qMin(count, quint64(INT_MAX))));
+    return true;
+}
+
+void AudioEnvelope::storeCachedEnvelope(const std::vector<qint64> &envelope) const
+{
+    if (m_cacheFile.isEmpty() || envelope.empty()) {
+        return;
+    }
+    QMutexLocker lock(&envelopeCacheMutex);
+    envelopeMemoryCache.insert(m_cacheFile, new std::vector<qint64>(envelope), int(qMin(quint64(envelope.size()), quint64(INT_MAX))));
+    QSaveFile file(m_cacheFile);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+    QDataStream out(&file);
+    out << envelopeCacheVersion << m_producer->get_fps() << quint64(envelope.size());
+    out.writeRawData(reinterpret_cast<const char *>(envelope.data()), int(envelope.size() * sizeof(qint64)));
+    if (!file.commit()) {
+        qCDebug(KDENLIVE_LOG) << "// Cannot write audio envelope cache: " << m_cacheFile;
     }
-    pCore->displayMessage(i18n("Audio analysis finished"), OperationCompletedMessage, 300);
-    return summary;
 }
 
 int AudioEnvelope::clipId() const
@@ -26,6 +26,9 @@ class QImage;
   of the absolute values of all samples in the current frame.
 
   See also: http://web.archive.org/web/20180626235917/http://bemasc.net/wordpress/2011/07/26/an-auto-aligner-for-pitivi/
+
+  The raw envelope of a full bin clip is stored next to the audio thumbnails,
+  so aligning several clips against the same reference only decodes it once.
   */
 class AudioEnvelope : public QObject
 {
@@ -89,6 +92,18 @@ private:
     */
     AudioSummary loadAndNormalizeEnvelope() const;
 
+    /**
+     Decodes the audio of our producer and returns the sum of absolute sample values for each frame.
+    */
+    std::vector<qint64> computeRawEnvelope() const;
+
+    /**
+     Reads the raw envelope of the full clip from the memory or disk cache.
+     Returns false if not cached.
+    */
+    bool loadCachedEnvelope(std::vector<qint64> &envelope) const;
+    void storeCachedEnvelope(const std::vector<qint64> &envelope) const;
+
     std::shared_ptr<Mlt::Producer> m_producer;
     std::unique_ptr<AudioInfo> m_info;
     QFutureWatcher<AudioSummary> m_watcher;
@@ -98,6 +113,11 @@ private:
     const int m_clipId;
     const size_t m_startpos;
     size_t m_envelopeSize;
+    /** @brief First frame of the analysed zone when only part of the clip is used */
+    size_t m_zoneIn;
+    bool m_useZone;
+    /** @brief Path of the raw envelope of the full clip, empty if the project has no cache folder */
+    QString m_cacheFile;
 
 signals:
     void envelopeReady(AudioEnvelope *envelope);
@@ -16,12 +16,59 @@ extern "C" {
 
 #include "kdenlive_debug.h"
 #include <algorithm>
+#include <map>
 #include <vector>
 
+namespace {
+/**
+  FFT configurations and work buffers, reused across correlations.
+  kiss_fftr writes to a scratch buffer inside its config, so a config
+  cannot be shared between threads: each thread gets its own cache.
+  */
+struct FFTWorkspace
+{
+    std::map<size_t, std::pair<kiss_fftr_cfg, kiss_fftr_cfg>> plans;
+    std::vector<float> leftF;
+    std::vector<float> rightF;
+    std::vector<float> correlated;
+    std::vector<float> leftData;
+    std::vector<float> rightData;
+    std::vector<float> convolved;
+    std::vector<kiss_fft_cpx> leftFFT;
+    std::vector<kiss_fft_cpx> rightFFT;
+    std::vector<kiss_fft_cpx> correlatedFFT;
+
+    ~FFTWorkspace()
+    {
+        for (auto &plan : plans) {
+            kiss_fftr_free(plan.second.first);
+            kiss_fftr_free(plan.second.second);
+        }
+    }
+
+    /** @brief Returns the forward and inverse configurations for a transform of the given size */
+    const std::pair<kiss_fftr_cfg, kiss_fftr_cfg> &plan(size_t size)
+    {
+        auto it = plans.find(size);
+        if (it == plans.end()) {
+            it = plans.emplace(size, std::make_pair(kiss_fftr_alloc((int)size, 0, nullptr, nullptr), kiss_fftr_alloc((int)size, 1, nullptr, nullptr))).first;
+        }
+        return it->second;
+    }
+};
+
+FFTWorkspace &workspace()
+{
+    static thread_local FFTWorkspace ws;
+    return ws;
+}
+} // namespace
+
 void FFTCorrelation::correlate(const qint64 *left, const size_t leftSize, const qint64 *right, const size_t rightSize, qint64 *out_correlated)
 {
-    auto *correlatedFloat = new float[leftSize + rightSize + 1];
-    correlate(left, leftSize, right, rightSize, correlatedFloat);
+    std::vector<float> &correlatedFloat = workspace().correlated;
+    correlatedFloat.resize(leftSize + rightSize + 1);
+    correlate(left, leftSize, right, rightSize, correlatedFloat.data());
 
     // The correlation vector will have entries up to N (number of entries
     // of the vector), so converting to integers will not lose that much
@@ -29,7 +76,6 @@ void FFTCorrelation::correlate(const qint64 *left, const size_t leftSize, const
     for (size_t i = 0; i < leftSize + rightSize + 1; ++i) {
         out_correlated[i] = correlatedFloat[i];
     }
-    delete[] correlatedFloat;
 }
 
 void FFTCorrelation::correlate(const qint64 *left, const size_t leftSize, const qint64 *right, const size_t rightSize, float *out_correlated)
@@ -37,8 +83,11 @@ void FFTCorrelation::correlate(const qint64 *left, const size_t leftSize, const
     QElapsedTimer t;
     t.start();
 
-    auto *leftF = new float[leftSize];
-    auto *rightF = new float[rightSize];
+    FFTWorkspace &ws = workspace();
+    std::vector<float> &leftF = ws.leftF;
+    std::vector<float> &rightF = ws.rightF;
+    leftF.resize(leftSize);
+    rightF.resize(rightSize);
 
     // First the qint64 values need to be normalized to floats
     // Dividing by the max value is maybe not the best solution, but the
@@ -67,11 +116,9 @@ void FFTCorrelation::correlate(const qint64 *left, const size_t leftSize, const
     }
 
     // Now we can convolve to get the correlation
-    convolve(leftF, leftSize, rightF, rightSize, out_correlated);
+    convolve(leftF.data(), leftSize, rightF.data(), rightSize, out_correlated);
 
     qCDebug(KDENLIVE_LOG) << "Correlation (FFT based) computed in " << t.elapsed() << " ms.";
-    delete[] leftF;
-    delete[] rightF;
 }
 
 void FFTCorrelation::convolve(const float *left, const size_t leftSize, const float *right, const size_t rightSize, float *out_convolved)
@@ -92,16 +139,24 @@ void FFTCorrelation::convolve(const float *left, const size_t leftSize, const fl
     }
 
     const size_t fft_size = size / 2 + 1;
-    kiss_fftr_cfg fftConfig = kiss_fftr_alloc((int)size, 0, nullptr, nullptr);
-    kiss_fftr_cfg ifftConfig = kiss_fftr_alloc((int)size, 1, nullptr, nullptr);
-    std::vector<kiss_fft_cpx> leftFFT(fft_size);
-    std::vector<kiss_fft_cpx> rightFFT(fft_size);
-    std::vector<kiss_fft_cpx> correlatedFFT(fft_size);
+    FFTWorkspace &ws = workspace();
+    const std::pair<kiss_fftr_cfg, kiss_fftr_cfg> &plan = ws.plan(size);
+    kiss_fftr_cfg fftConfig = plan.first;
+    kiss_fftr_cfg ifftConfig = plan.second;
+    std::vector<kiss_fft_cpx> &leftFFT = ws.leftFFT;
+    std::vector<kiss_fft_cpx> &rightFFT = ws.rightFFT;
+    std::vector<kiss_fft_cpx> &correlatedFFT = ws.correlatedFFT;
+    leftFFT.resize(fft_size);
+    rightFFT.resize(fft_size);
+    correlatedFFT.resize(fft_size);
 
     // Fill in the data into our new vectors with padding
-    std::vector<float> leftData(size, 0);
-    std::vector<float> rightData(size, 0);
-    std::vector<float> convolved(size);
+    std::vector<float> &leftData = ws.leftData;
+    std::vector<float> &rightData = ws.rightData;
+    std::vector<float> &convolved = ws.convolved;
+    leftData.assign(size, 0);
+    rightData.assign(size, 0);
+    convolved.resize(size);
 
     std::copy(left, left + leftSize, leftData.begin());
     std::copy(right, right + rightSize, rightData.begin());
@@ -125,9 +180,5 @@ void FFTCorrelation::convolve(const float *left, const size_t leftSize, const fl
     kiss_fftri(ifftConfig, &correlatedFFT[0], &convolved[0]);
     std::copy(convolved.begin(), convolved.begin() + (int)out_size - 1, out_convolved + 1);
 
-    // Finally some cleanup.
-    kiss_fftr_free(fftConfig);
-    kiss_fftr_free(ifftConfig);
-
     qCDebug(KDENLIVE_LOG) << "FFT convolution computed. Time taken: " << time.elapsed() << " ms";
 }
@@ -17,6 +17,8 @@ the Free Software Foundation, either version 3 of the License, or
   and correlation of two vectors by means of FFT, which
   is O(n log n) (convolution in spacial domain would be
   O(n²)).
+  The FFT configurations and work buffers are cached per thread
+  and reused between calls.
   */
 class FFTCorrelation
 {
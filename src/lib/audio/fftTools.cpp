@@ -12,8 +12,11 @@
 
 #include <cmath>
 #include <iostream>
+#include <map>
+#include <vector>
 
-#include <QString>
+#include <QHash>
+#include <QMutex>
 
 // Uncomment for debugging, like writing a GNU Octave .m file to /tmp
 //#define DEBUG_FFTTOOLS
@@ -24,26 +27,76 @@
 #include <fstream>
 #endif
 
-FFTTools::FFTTools()
-    : m_fftCfgs()
-    , m_windowFunctions()
+namespace {
+/**
+  FFT configurations and work buffers of the calling thread.
+  kiss_fftr writes to a scratch buffer inside its config, so a config
+  cannot be shared between threads.
+  */
+struct FFTWorkspace
 {
-}
-FFTTools::~FFTTools()
-{
-    QHash<QString, kiss_fftr_cfg>::iterator i;
-    for (i = m_fftCfgs.begin(); i != m_fftCfgs.end(); ++i) {
-        free(*i);
+    std::map<uint, kiss_fftr_cfg> cfgs;
+    std::vector<float> data;
+    std::vector<kiss_fft_cpx> freqData;
+
+    ~FFTWorkspace()
+    {
+        for (auto &cfg : cfgs) {
+            kiss_fftr_free(cfg.second);
+        }
+    }
+
+    kiss_fftr_cfg cfg(uint size)
+    {
+        auto it = cfgs.find(size);
+        if (it == cfgs.end()) {
+#ifdef DEBUG_FFTTOOLS
+            qCDebug(KDENLIVE_LOG) << "Creating FFT configuration with size " << size;
+#endif
+            it = cfgs.emplace(size, kiss_fftr_alloc((int)size, 0, nullptr, nullptr)).first;
+        }
+        return it->second;
     }
+};
+
+FFTWorkspace &workspace()
+{
+    static thread_local FFTWorkspace ws;
+    return ws;
 }
 
-const QString FFTTools::windowSignature(const WindowType windowType, const int size, const float param)
+QMutex windowMutex;
+QHash<quint64, QVector<float>> windowFunctions;
+} // namespace
+
+quint64 FFTTools::windowKey(const WindowType windowType, const int size, const float param)
 {
-    return QStringLiteral("s%1_t%2_p%3").arg(size).arg(windowType).arg(param, 0, 'f', 3);
+    // Same precision as the window parameter accepted by the scopes (3 decimals)
+    auto quantizedParam = quint64(qRound(param * 1000) & 0xffff);
+    return (quint64(uint(size)) << 24) | (quint64(windowType & 0xff) << 16) | quantizedParam;
 }
-const QString FFTTools::cfgSignature(const int size)
+
+const QVector<float> FFTTools::scaledWindow(const WindowType windowType, const int size, const float param)
 {
-    return QStringLiteral("s%1").arg(size);
+    const quint64 key = windowKey(windowType, size, param);
+    QMutexLocker lk(&windowMutex);
+    auto it = windowFunctions.constFind(key);
+    if (it != windowFunctions.constEnd()) {
+        return it.value();
+    }
+#ifdef DEBUG_FFTTOOLS
+    qCDebug(KDENLIVE_LOG) << "Building new window function with size " << size << " and type " << windowType;
+#endif
+    QVector<float> factors = FFTTools::window(windowType, size, param);
+    // Normalize signals to [0,1] to get correct dB values later on, and compensate
+    // the window area which scales the values in the frequency domain.
+    const float scale = 1.0f / 32767.0f / factors[size];
+    factors.resize(size);
+    for (float &f : factors) {
+        f *= scale;
+    }
+    windowFunctions.insert(key, factors);
+    return factors;
 }
 
 // https://cplusplus.syntaxerrors.info/index.php?title=Cannot_declare_member_function_%E2%80%98static_int_Foo::bar%28%29%E2%80%99_to_have_static_linkage
@@ -111,92 +164,33 @@ const QVector<float> FFTTools::window(const WindowType windowType, const int siz
     return QVector<float>();
 }
 
-void FFTTools::fftNormalized(const audioShortVector &audioFrame, const uint channel, const uint numChannels, float *freqSpectrum, const WindowType windowType,
-                             const uint windowSize, const float param)
+void FFTTools::transformChannel(const qint16 *samples, const uint numSamples, const uint stride, const float *factors, const uint windowSize,
+                                float *freqSpectrum)
 {
-#ifdef DEBUG_FFTTOOLS
-    QTime start = QTime::currentTime();
-#endif
-
-    const uint numSamples = (uint)audioFrame.size() / numChannels;
-
-    if (((windowSize & 1) != 0u) || windowSize < 2) {
-        return;
-    }
-
-    const QString cfgSig = cfgSignature((int)windowSize);
-    const QString winSig = windowSignature(windowType, (int)windowSize, param);
-
-    // Get the kiss_fft configuration from the config cache
-    // or build a new configuration if the requested one is not available.
-    kiss_fftr_cfg myCfg;
-    if (m_fftCfgs.contains(cfgSig)) {
-#ifdef DEBUG_FFTTOOLS
-        qCDebug(KDENLIVE_LOG) << "Re-using FFT configuration with size " << windowSize;
-#endif
-        myCfg = m_fftCfgs.value(cfgSig);
-    } else {
-#ifdef DEBUG_FFTTOOLS
-        qCDebug(KDENLIVE_LOG) << "Creating FFT configuration with size " << windowSize;
-#endif
-        myCfg = kiss_fftr_alloc((int)windowSize, 0, nullptr, nullptr);
-        m_fftCfgs.insert(cfgSig, myCfg);
-    }
-
-    // Get the window function from the cache
-    // (except for a rectangular window; nothing to do there).
-    QVector<float> window;
-    float windowScaleFactor = 1;
-    if (windowType != FFTTools::Window_Rect) {
-
-        if (m_windowFunctions.contains(winSig)) {
-#ifdef DEBUG_FFTTOOLS
-            qCDebug(KDENLIVE_LOG) << "Re-using window function with signature " << winSig;
-#endif
-            window = m_windowFunctions.value(winSig);
-        } else {
-#ifdef DEBUG_FFTTOOLS
-            qCDebug(KDENLIVE_LOG) << "Building new window function with signature " << winSig;
-#endif
-            window = FFTTools::window(windowType, (int)windowSize, 0);
-            m_windowFunctions.insert(winSig, window);
-        }
-        windowScaleFactor = 1.0 / window[(int)windowSize];
-    }
-
-    // Prepare frequency space vector. The resulting FFT vector is only half as long.
-    auto *freqData = new kiss_fft_cpx[int(windowSize) / 2];
-    auto *data = new float[(int)windowSize];
-
-    // Copy the first channel's audio into a vector for the FFT display;
-    // Fill the data vector indices that cannot be covered with sample data with 0
-    if (numSamples < windowSize) {
-        std::fill(&data[numSamples], &data[windowSize - 1], 0);
-    }
-    // Normalize signals to [0,1] to get correct dB values later on
-    for (uint i = 0; i < numSamples && i < windowSize; ++i) {
-        // Performance note: Benchmarking has shown that using the if/else inside the loop
-        // does not do noticeable worse than keeping it outside (perhaps the branch predictor
-        // is good enough), so it remains in there for better readability.
-        if (windowType != FFTTools::Window_Rect) {
-            data[i] = (float)audioFrame.data()[i * numChannels + channel] / 32767.0f * window[(int)i];
-        } else {
-            data[i] = (float)audioFrame.data()[i * numChannels + channel] / 32767.0f;
-        }
+    FFTWorkspace &ws = workspace();
+    kiss_fftr_cfg myCfg = ws.cfg(windowSize);
+    ws.data.resize(windowSize);
+    ws.freqData.resize(windowSize / 2 + 1);
+    float *data = ws.data.data();
+
+    // Apply the window to the first channel's audio; fill the data vector
+    // indices that cannot be covered with sample data with 0.
+    const uint count = qMin(numSamples, windowSize);
+    for (uint i = 0; i < count; ++i) {
+        data[i] = (float)samples[i * stride] * factors[i];
     }
+    std::fill(data + count, data + windowSize, 0.f);
 
     // Calculate the Fast Fourier Transform for the input data
-    kiss_fftr(myCfg, data, freqData);
+    kiss_fftr(myCfg, data, ws.freqData.data());
 
-    // Logarithmic scale: 20 * log ( 2 * magnitude / N ) with magnitude = sqrt(r² + i²)
-    // with N = FFT size (after FFT, 1/2 window size)
+    // Logarithmic scale: 20 * log10 ( 2 * magnitude / N ) with magnitude = sqrt(r² + i²)
+    // and N = window size, computed as 10 * log10 (r² + i²) - 20 * log10 (N / 2)
+    // to avoid the square root and keep a single logarithm per bin.
+    const float offset = 20.0f * std::log10((float)windowSize / 2.0f);
+    const kiss_fft_cpx *freqData = ws.freqData.data();
     for (uint i = 0; i < windowSize / 2; ++i) {
-        // Logarithmic scale: 20 * log ( 2 * magnitude / N ) with magnitude = sqrt(r² + i²)
-        // with N = FFT size (after FFT, 1/2 window size)
-        freqSpectrum[i] =
-            20 * log(pow(pow(fabs(freqData[i].r * windowScaleFactor), 2) + pow(fabs(freqData[i].i * windowScaleFactor), 2), .5) / ((float)windowSize / 2.0f)) /
-            log(10);
-        ;
+        freqSpectrum[i] = 10.0f * std::log10(freqData[i].r * freqData[i].r + freqData[i].i * freqData[i].i) - offset;
     }
 
 #ifdef DEBUG_FFTTOOLS
@@ -207,13 +201,13 @@ void FFTTools::fftNormalized(const audioShortVector &audioFrame, const uint chan
     } else {
         mFile << "val = [ ";
 
-        for (int sample = 0; sample < 256; ++sample) {
+        for (uint sample = 0; sample < 256 && sample < windowSize; ++sample) {
             mFile << data[sample] << ' ';
         }
         mFile << " ];\n";
 
         mFile << "freq = [ ";
-        for (int sample = 0; sample < 256; ++sample) {
+        for (uint sample = 0; sample < 256 && sample < windowSize / 2; ++sample) {
             mFile << freqData[sample].r << '+' << freqData[sample].i << "*i ";
         }
         mFile << " ];\n";
@@ -222,12 +216,25 @@ void FFTTools::fftNormalized(const audioShortVector &audioFrame, const uint chan
         qCDebug(KDENLIVE_LOG) << "File written.";
     }
 #endif
+}
+
+void FFTTools::fftNormalized(const audioShortVector &audioFrame, const uint channel, const uint numChannels, float *freqSpectrum, const WindowType windowType,
+                             const uint windowSize, const float param)
+{
+#ifdef DEBUG_FFTTOOLS
+    QTime start = QTime::currentTime();
+#endif
+
+    if (((windowSize & 1) != 0u) || windowSize < 2 || numChannels == 0 || channel >= numChannels) {
+        return;
+    }
+    const uint numSamples = (uint)audioFrame.size() / numChannels;
+    const QVector<float> factors = scaledWindow(windowType, (int)windowSize, param);
+    transformChannel(audioFrame.constData() + channel, numSamples, numChannels, factors.constData(), windowSize, freqSpectrum);
 
 #ifdef DEBUG_FFTTOOLS
     qCDebug(KDENLIVE_LOG) << "Calculated FFT in " << start.elapsed() << " ms.";
 #endif
-    delete[] freqData;
-    delete[] data;
 }
 
 const QVector<float> FFTTools::interpolatePeakPreserving(const QVector<float> &in, const uint targetSize, uint left, uint right, float fill)
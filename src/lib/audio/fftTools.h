@@ -13,15 +13,17 @@
 
 #include "../../definitions.h"
 #include "../external/kiss_fft/tools/kiss_fftr.h"
-#include <QHash>
 #include <QVector>
 
+/**
+  FFT helpers shared by the audio scopes.
+  All functions are static and thread-safe: window functions are cached globally,
+  kiss_fft configurations and work buffers are cached per thread since a kiss_fftr
+  configuration holds a scratch buffer and cannot be used by two threads at once.
+  */
 class FFTTools
 {
 public:
-    FFTTools();
-    ~FFTTools();
-
     enum WindowType { Window_Rect, Window_Triangle, Window_Hamming };
 
     /** Creates a vector containing the factors for the selected window functions.
@@ -39,11 +41,8 @@ public:
     */
     static const QVector<float> window(const WindowType windowType, const int size, const float param = 0);
 
-    static const QString windowSignature(const WindowType windowType, const int size, const float param = 0);
-
-    /** Returns a signature for a kiss_fft configuration
-        used as a hash in the cache */
-    static const QString cfgSignature(const int size);
+    /** Returns the key used to cache a window function */
+    static quint64 windowKey(const WindowType windowType, const int size, const float param = 0);
 
     /** Calculates the Fourier Transformation of the input audio frame.
         The resulting values will be given in relative decibel: The maximum power is 0 dB, lower powers have
@@ -54,8 +53,8 @@ public:
         * freqSpectrum has to be of size windowSize/2
         For windowType and param see the FFTTools::window() function above.
     */
-    void fftNormalized(const audioShortVector &audioFrame, const uint channel, const uint numChannels, float *freqSpectrum, const WindowType windowType,
-                       const uint windowSize, const float param = 0);
+    static void fftNormalized(const audioShortVector &audioFrame, const uint channel, const uint numChannels, float *freqSpectrum,
+                              const WindowType windowType, const uint windowSize, const float param = 0);
 
     /** This is linear interpolation with the special property that it preserves peaks, which is required
         for e.g. showing correct Decibel values (where the peak values are of interest because of clipping which
@@ -74,8 +73,11 @@ public:
     static const QVector<float> interpolatePeakPreserving(const QVector<float> &in, const uint targetSize, uint left = 0, uint right = 0, float fill = 0.0);
 
 private:
-    QHash<QString, kiss_fftr_cfg> m_fftCfgs;          // FFT cfg cache
-    QHash<QString, QVector<float>> m_windowFunctions; // Window function cache
+    /** Returns the cached window function multiplied by the sample normalization factor and the
+        window area correction, so that a single multiplication per sample prepares the FFT input. */
+    static const QVector<float> scaledWindow(const WindowType windowType, const int size, const float param);
+    static void transformChannel(const qint16 *samples, const uint numSamples, const uint stride, const float *factors, const uint windowSize,
+                                 float *freqSpectrum);
 };
 
 #endif // FFTTOOLS_H
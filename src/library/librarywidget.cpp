@@ -216,12 +216,20 @@ LibraryWidget::LibraryWidget(ProjectManager *manager, QWidget *parent)
     connect(m_coreLister, &KCoreDirLister::itemsAdded, this, &LibraryWidget::slotItemsAdded);
     connect(m_coreLister, &KCoreDirLister::itemsDeleted, this, &LibraryWidget::slotItemsDeleted);
     connect(m_coreLister, SIGNAL(clear()), this, SLOT(slotClearAll()));
-    m_coreLister->openUrl(QUrl::fromLocalFile(m_directory.absolutePath()));
     m_libraryTree->setSortingEnabled(true);
     m_libraryTree->sortByColumn(0, Qt::AscendingOrder);
     connect(m_libraryTree, &LibraryTree::itemChanged, this, &LibraryWidget::slotItemEdited, Qt::UniqueConnection);
 }
 
+void LibraryWidget::showEvent(QShowEvent *event)
+{
+    if (!m_listed && isEnabled()) {
+        m_listed = true;
+        m_coreLister->openUrl(QUrl::fromLocalFile(m_directory.absolutePath()));
+    }
+    QWidget::showEvent(event);
+}
+
 void LibraryWidget::setupActions(const QList<QAction *> &list)
 {
     QList<QAction *> menuList;
@@ -493,8 +501,11 @@ void LibraryWidget::slotUpdateLibraryPath()
         showMessage(i18n("Check your settings, Library path is invalid: %1", m_directory.absolutePath()), KMessageWidget::Warning);
         setEnabled(false);
     } else {
-        m_coreLister->openUrl(QUrl::fromLocalFile(m_directory.absolutePath()));
         setEnabled(true);
+        if (m_listed || isVisible()) {
+            m_listed = true;
+            m_coreLister->openUrl(QUrl::fromLocalFile(m_directory.absolutePath()));
+        }
     }
     m_libraryTree->blockSignals(false);
 }
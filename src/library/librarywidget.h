@@ -174,6 +174,9 @@ public slots:
     void slotAddToLibrary();
     void slotUpdateLibraryPath();
 
+protected:
+    void showEvent(QShowEvent *event) override;
+
 private slots:
     void slotAddToProject();
     void slotDeleteFromLibrary();
@@ -204,6 +207,8 @@ private:
     KCoreDirLister *m_coreLister;
     QMutex m_treeMutex;
     QDir m_directory;
+    /** @brief True once the library folder was listed. Listing creates a preview job for each file, so we wait until the library is shown */
+    bool m_listed{false};
     void showMessage(const QString &text, KMessageWidget::MessageType type = KMessageWidget::Warning);
 
 signals:
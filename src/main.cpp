@@ -21,6 +21,7 @@
 #include "core.h"
 #include "logger.hpp"
 #include "dialogs/splash.hpp"
+#include "utils/startupprofiler.hpp"
 #include <config-kdenlive.h>
 
 #include <mlt++/Mlt.h>
@@ -71,6 +72,7 @@ int main(int argc, char *argv[])
 #ifdef USE_DRMINGW
     ExcHndlInit();
 #endif
+    StartupProfiler::start();
     // Force QDomDocument to use a deterministic XML attribute order
     qSetGlobalQHashSeed(0);
 
@@ -204,6 +206,8 @@ int main(int argc, char *argv[])
     parser.addOption(QCommandLineOption(QStringList() << QStringLiteral("mlt-path"), i18n("Set the path for MLT environment"), QStringLiteral("mlt-path")));
     parser.addOption(QCommandLineOption(QStringList() << QStringLiteral("mlt-log"), i18n("MLT log level"), QStringLiteral("verbose/debug")));
     parser.addOption(QCommandLineOption(QStringList() << QStringLiteral("i"), i18n("Comma separated list of clips to add"), QStringLiteral("clips")));
+    parser.addOption(QCommandLineOption(QStringList() << QStringLiteral("startup-profile"),
+                                        i18n("Write the duration of each startup phase to a JSON file, or to the standard output if file is -"), QStringLiteral("file")));
     parser.addPositionalArgument(QStringLiteral("file"), i18n("Document to open"));
 
     // Parse command line
@@ -211,6 +215,10 @@ int main(int argc, char *argv[])
     aboutData.processCommandLine(&parser);
 
     qApp->processEvents(QEventLoop::AllEvents);
+    if (parser.isSet(QStringLiteral("startup-profile"))) {
+        StartupProfiler::setOutput(parser.value(QStringLiteral("startup-profile")));
+    }
+    StartupProfiler::record(QStringLiteral("Application setup"), 0, StartupProfiler::elapsed(), StartupProfiler::threadCpuTime());
 
 #ifdef USE_DRMINGW
     ExcHndlInit();
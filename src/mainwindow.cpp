@@ -38,6 +38,7 @@
 #include "effectslist/effectbasket.h"
 #include "hidetitlebars.h"
 #include "jobs/jobmanager.h"
+#include "jobs/loudnessjob.hpp"
 #include "jobs/scenesplitjob.hpp"
 #include "jobs/speedjob.hpp"
 #include "jobs/stabilizejob.hpp"
@@ -114,6 +115,7 @@
 #include <QScreen>
 #include <QStandardPaths>
 #include <QVBoxLayout>
+#include <QtConcurrent>
 
 static const char version[] = KDENLIVE_VERSION;
 namespace Mlt {
@@ -859,6 +861,10 @@ void MainWindow::updateActionsToolTip()
 
 MainWindow::~MainWindow()
 {
+    if (m_timelineLoudness) {
+        m_cancelTimelineLoudness = true;
+        m_timelineLoudness->waitForFinished();
+    }
     pCore->prepareShutdown();
     delete m_timelineTabs;
     delete m_audioSpectrum;
@@ -1399,6 +1405,11 @@ void MainWindow::setupActions()
     overlayFpsInfo->setCheckable(true);
     overlayFpsInfo->setData(0x20);
 
+    QAction *overlayStatsInfo = new QAction(QIcon::fromTheme(QStringLiteral("help-hint")), i18n("Monitor Overlay Playback Statistics"), this);
+    addAction(QStringLiteral("monitor_overlay_stats"), overlayStatsInfo);
+    overlayStatsInfo->setCheckable(true);
+    overlayStatsInfo->setData(0x40);
+
     QAction *overlayMarkerInfo = new QAction(QIcon::fromTheme(QStringLiteral("help-hint")), i18n("Monitor Overlay Markers"), this);
     addAction(QStringLiteral("monitor_overlay_markers"), overlayMarkerInfo);
     overlayMarkerInfo->setCheckable(true);
@@ -1409,9 +1420,10 @@ void MainWindow::setupActions()
     overlayAudioInfo->setCheckable(true);
     overlayAudioInfo->setData(0x10);
 
-    connect(overlayInfo, &QAction::toggled, this, [&, overlayTCInfo, overlayFpsInfo, overlayMarkerInfo, overlayAudioInfo](bool toggled) {
+    connect(overlayInfo, &QAction::toggled, this, [&, overlayTCInfo, overlayFpsInfo, overlayStatsInfo, overlayMarkerInfo, overlayAudioInfo](bool toggled) {
         overlayTCInfo->setEnabled(toggled);
         overlayFpsInfo->setEnabled(toggled);
+        overlayStatsInfo->setEnabled(toggled);
         overlayMarkerInfo->setEnabled(toggled);
         overlayAudioInfo->setEnabled(toggled);
     });
@@ -1467,6 +1479,15 @@ void MainWindow::setupActions()
         // Clear timeline selection so that any qml monitor scene is reset
         emit pCore->monitorManager()->updatePreviewScaling();
     });
+    QAction *adaptiveScale = new QAction(i18n("Adapt Resolution During Playback"), this);
+    adaptiveScale->setToolTip(i18n("Lower the preview resolution while playing when the monitor cannot keep up"));
+    adaptiveScale->setCheckable(true);
+    adaptiveScale->setChecked(KdenliveSettings::adaptivepreview());
+    addAction(QStringLiteral("scale_adaptive_preview"), adaptiveScale);
+    connect(adaptiveScale, &QAction::toggled, this, [] (bool enable) {
+        KdenliveSettings::setAdaptivepreview(enable);
+        emit pCore->monitorManager()->updatePreviewScaling();
+    });
 #endif
 
     QAction *dropFrames = new QAction(QIcon(), i18n("Real Time (drop frames)"), this);
@@ -1671,6 +1692,7 @@ void MainWindow::setupActions()
     addAction(QStringLiteral("insert_space"), i18n("Insert Space"), this, SLOT(slotInsertSpace()));
     addAction(QStringLiteral("delete_space"), i18n("Remove Space"), this, SLOT(slotRemoveSpace()));
     addAction(QStringLiteral("delete_space_all_tracks"), i18n("Remove Space In All Tracks"), this, SLOT(slotRemoveAllSpace()));
+    addAction(QStringLiteral("measure_timeline_loudness"), i18n("Measure Timeline Loudness"), this, SLOT(slotMeasureTimelineLoudness()));
 
     KActionCategory *timelineActions = new KActionCategory(i18n("Tracks"), actionCollection());
     QAction *insertTrack = new QAction(QIcon(), i18n("Insert Track"), this);
@@ -2205,6 +2227,7 @@ void MainWindow::connectDocument()
     m_projectMonitor->slotLoadClipZone(project->zone());
     connect(m_projectMonitor, &Monitor::multitrackView, getMainTimeline()->controller(), &TimelineController::slotMultitrackView, Qt::UniqueConnection);
     connect(m_projectMonitor, &Monitor::activateTrack, getMainTimeline()->controller(), &TimelineController::activateTrackAndSelect, Qt::UniqueConnection);
+    connect(m_projectMonitor, &Monitor::renderPreviewZone, getMainTimeline()->controller(), &TimelineController::renderPreviewZone, Qt::UniqueConnection);
     connect(getMainTimeline()->controller(), &TimelineController::timelineClipSelected, this, [&] (bool selected) {
         m_loopClip->setEnabled(selected);
         emit pCore->library()->enableAddSelection(selected);
@@ -2670,6 +2693,39 @@ void MainWindow::slotRemoveAllSpace()
     getMainTimeline()->controller()->removeSpace(-1, -1, true);
 }
 
+void MainWindow::slotMeasureTimelineLoudness()
+{
+    if (m_timelineLoudness) {
+        m_messageLabel->setMessage(i18n("Timeline loudness is already being measured"), InformationMessage);
+        return;
+    }
+    KdenliveDoc *doc = pCore->currentDoc();
+    QString sceneData = pCore->projectManager()->projectSceneList(doc->url().adjusted(QUrl::RemoveFilename | QUrl::StripTrailingSlash).toLocalFile());
+    if (sceneData.isEmpty()) {
+        return;
+    }
+    int channels = pCore->audioChannels();
+    m_cancelTimelineLoudness = false;
+    m_timelineLoudness = new QFutureWatcher<LoudnessInfo>(this);
+    connect(m_timelineLoudness, &QFutureWatcher<LoudnessInfo>::finished, this, [this]() {
+        LoudnessInfo info = m_timelineLoudness->result();
+        m_timelineLoudness->deleteLater();
+        m_timelineLoudness = nullptr;
+        if (!info.valid) {
+            m_messageLabel->setMessage(i18n("Cannot measure timeline loudness"), ErrorMessage);
+            return;
+        }
+        KMessageBox::information(this, i18n("Integrated loudness: %1 LUFS\nMaximum short-term loudness: %2 LUFS\nTrue peak: %3 dBTP",
+                                            QString::number(info.integrated, 'f', 1), QString::number(info.shortTermMax, 'f', 1),
+                                            QString::number(info.truePeak, 'f', 1)),
+                                 i18n("Timeline Loudness"));
+    });
+    m_timelineLoudness->setFuture(QtConcurrent::run([this, sceneData, channels]() {
+        return LoudnessJob::measureTimeline(sceneData, channels, m_cancelTimelineLoudness);
+    }));
+    m_messageLabel->setMessage(i18n("Measuring timeline loudness"), ProcessingJobMessage);
+}
+
 void MainWindow::slotSeparateAudioChannel()
 {
     KdenliveSettings::setDisplayallchannels(!KdenliveSettings::displayallchannels());
@@ -3449,6 +3505,15 @@ void MainWindow::buildDynamicActions()
                     [&]() { emit pCore->jobManager()->startJob<SceneSplitJob>(pCore->bin()->selectedClipsIds(true), {}, i18n("Scene detection")); });
         }
     }
+    filter = std::make_unique<Mlt::Filter>(profile, "loudness_meter");
+    if (filter) {
+        if (filter->is_valid()) {
+            QAction *action = new QAction(i18n("Measure loudness (EBU R128)"), m_extraFactory->actionCollection());
+            ts->addAction(action->text(), action);
+            connect(action, &QAction::triggered,
+                    [&]() { emit pCore->jobManager()->startJob<LoudnessJob>(pCore->bin()->selectedClipsIds(true), {}, i18n("Measure loudness")); });
+        }
+    }
     if (true /* TODO: check if timewarp producer is available */) {
         QAction *action = new QAction(i18n("Duplicate clip with speed change"), m_extraFactory->actionCollection());
         ts->addAction(action->text(), action);
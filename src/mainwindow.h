@@ -24,6 +24,7 @@
 #include <QDBusAbstractAdaptor>
 #include <QDockWidget>
 #include <QEvent>
+#include <QFutureWatcher>
 #include <QImage>
 #include <QMap>
 #include <QShortcut>
@@ -35,6 +36,7 @@
 #include <KSelectAction>
 #include <KXmlGuiWindow>
 #include <kautosavefile.h>
+#include <atomic>
 #include <utility>
 
 #include "bin/bin.h"
@@ -53,6 +55,7 @@ class EffectListWidget;
 class TransitionListWidget;
 class KIconLoader;
 class KdenliveDoc;
+struct LoudnessInfo;
 class Monitor;
 class Render;
 class RenderWidget;
@@ -205,6 +208,9 @@ private:
     QMenu *m_timelineContextMenu;
     QList<QAction *> m_timelineClipActions;
     KDualAction *m_useTimelineZone;
+    /** @brief Watches the timeline loudness measure, running in a worker thread */
+    QFutureWatcher<LoudnessInfo> *m_timelineLoudness{nullptr};
+    std::atomic_bool m_cancelTimelineLoudness{false};
 
     /** Action names that can be used in the slotDoAction() slot, with their i18n() names */
     QStringList m_actionNames;
@@ -386,6 +392,8 @@ private slots:
     void slotInsertSpace();
     void slotRemoveSpace();
     void slotRemoveAllSpace();
+    /** @brief Measure the EBU R128 loudness of the whole timeline mix. */
+    void slotMeasureTimelineLoudness();
     void slotAddGuide();
     void slotEditGuide();
     void slotDeleteGuide();
@@ -25,6 +25,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "core.h"
 #include "dialogs/profilesdialog.h"
 #include "doc/kdenlivedoc.h"
+#include "jobs/loudnessjob.hpp"
 #include "kdenlivesettings.h"
 #include "profiles/profilerepository.hpp"
 #include "project/projectmanager.h"
@@ -63,6 +64,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QScrollArea>
 #include <QTextEdit>
 #include <QToolBar>
+#include <QToolButton>
 #include <QUrl>
 #include <QListWidgetItem>
 #include <QButtonGroup>
@@ -742,6 +744,7 @@ ClipPropertiesController::ClipPropertiesController(ClipController *controller, Q
                     }
                     QSignalBlocker bk3(m_gain);
                     m_gain->setValue(gain);
+                    updateLoudnessInfo();
                 } else {
                     m_activeAudioStreams = -1;
                     m_audioEffectGroup->setEnabled(false);
@@ -902,6 +905,24 @@ ClipPropertiesController::ClipPropertiesController(ClipController *controller, Q
             gainLay->addWidget(m_gain);
             gainLay->addStretch(1);
             vbox->addLayout(gainLay);
+            // Loudness measured by the loudness job, the gain above can match it to the delivery target
+            QHBoxLayout *loudnessLay = new QHBoxLayout;
+            m_loudnessLabel = new QLabel(this);
+            m_loudnessLabel->setWordWrap(true);
+            loudnessLay->addWidget(m_loudnessLabel, 1);
+            m_matchLoudness = new QToolButton(this);
+            m_matchLoudness->setText(i18n("Normalize to %1 LUFS", KdenliveSettings::loudnesstarget()));
+            m_matchLoudness->setToolTip(i18n("Set the gain so that the integrated loudness matches the target, keeping the true peak below -1 dBTP"));
+            connect(m_matchLoudness, &QToolButton::clicked, this, [this]() {
+                LoudnessInfo info = LoudnessInfo::fromString(m_controller->getProducerProperty(LoudnessJob::propertyName(m_activeAudioStreams)));
+                if (m_activeAudioStreams == -1 || !info.valid) {
+                    return;
+                }
+                int gain = qBound(m_gain->minimum(), info.normalizationGain(KdenliveSettings::loudnesstarget()), m_gain->maximum());
+                m_gain->setValue(gain);
+            });
+            loudnessLay->addWidget(m_matchLoudness);
+            vbox->addLayout(loudnessLay);
 
             vbox->addStretch(1);
             m_audioEffectGroup->setLayout(vbox);
@@ -1723,5 +1744,18 @@ void ClipPropertiesController::updateStreamInfo(int streamIndex)
         }
         QSignalBlocker bk3(m_gain);
         m_gain->setValue(gain);
+        updateLoudnessInfo();
+    }
+}
+
+void ClipPropertiesController::updateLoudnessInfo()
+{
+    LoudnessInfo info = LoudnessInfo::fromString(m_controller->getProducerProperty(LoudnessJob::propertyName(m_activeAudioStreams)));
+    m_matchLoudness->setEnabled(info.valid);
+    if (!info.valid) {
+        m_loudnessLabel->setText(i18n("Loudness not analysed"));
+        return;
     }
+    m_loudnessLabel->setText(i18n("Loudness %1 LUFS, short-term max %2 LUFS, true peak %3 dBTP", QString::number(info.integrated, 'f', 1),
+                                  QString::number(info.shortTermMax, 'f', 1), QString::number(info.truePeak, 'f', 1)));
 }
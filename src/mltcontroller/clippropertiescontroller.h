@@ -40,6 +40,7 @@ class QGroupBox;
 class QCheckBox;
 class QButtonGroup;
 class QSpinBox;
+class QToolButton;
 
 class ElidedLinkLabel : public QLabel
 {
@@ -147,11 +148,15 @@ private:
     QCheckBox *m_copyChannel1;
     QCheckBox *m_copyChannel2;
     QSpinBox *m_gain;
+    QLabel *m_loudnessLabel;
+    QToolButton *m_matchLoudness;
     /** @brief The selected audio stream. */
     int m_activeAudioStreams;
     void fillProperties();
     /** @brief Add/remove icon beside audio stream to indicate effects. */
     void updateStreamIcon(int row, int streamIndex);
+    /** @brief Display the measured loudness of the selected audio stream. */
+    void updateLoudnessInfo();
 
 signals:
     void updateClipProperties(const QString &, const QMap<QString, QString> &, const QMap<QString, QString> &);
@@ -0,0 +1,142 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by agent <agent@local>                             *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+
+#include "adaptivepreview.h"
+
+#include <QtGlobal>
+#include <array>
+
+// Same steps as the preview resolution menu: full, 720p, 540p, 360p and 270p
+static const std::array<int, 5> scalingSteps{{0, 2, 4, 8, 16}};
+// Slow windows in a row before lowering the resolution
+static const int lowerAfter = 2;
+// Smooth windows in a row before trying a higher resolution, doubled after each failed attempt
+static const int raiseAfter = 5;
+static const int maxRaiseAfter = 40;
+// A drop this soon after raising the resolution means the raise failed
+static const int failedRaiseWindow = 3;
+// Slow windows at the lowest resolution before we report that scaling is not enough
+static const int saturatedAfter = 3;
+
+static int levelForScaling(int scaling)
+{
+    for (size_t i = scalingSteps.size() - 1; i > 0; --i) {
+        if (scaling >= scalingSteps[i]) {
+            return int(i);
+        }
+    }
+    return 0;
+}
+
+AdaptivePreview::AdaptivePreview()
+    : m_level(0)
+    , m_slowWindows(0)
+    , m_smoothWindows(0)
+    , m_settleWindows(0)
+    , m_windowsSinceRaise(-1)
+    , m_requiredSmoothWindows(raiseAfter)
+    , m_lastSlow(false)
+    , m_atLowest(false)
+{
+}
+
+void AdaptivePreview::reset()
+{
+    m_level = 0;
+    m_slowWindows = 0;
+    m_smoothWindows = 0;
+    m_settleWindows = 0;
+    m_windowsSinceRaise = -1;
+    m_requiredSmoothWindows = raiseAfter;
+    m_lastSlow = false;
+    m_atLowest = false;
+}
+
+int AdaptivePreview::scaling() const
+{
+    return scalingSteps.at(size_t(m_level));
+}
+
+bool AdaptivePreview::isSaturated() const
+{
+    return m_atLowest && m_slowWindows >= saturatedAfter;
+}
+
+bool AdaptivePreview::update(const PlaybackMetrics::Window &window, double fps, int baseScaling)
+{
+    if (window.duration <= 0 || fps <= 0.) {
+        return false;
+    }
+    const double seconds = window.duration / 1000.;
+    const double expected = fps * seconds;
+    // Frames that reached the screen, this also catches slow playback when frame dropping is disabled
+    const double achieved = window.stages[PlaybackMetrics::Display].count;
+    const int dropped = window.consumerDrops + window.rendererDrops;
+    m_lastSlow = achieved < expected * 0.95 || dropped > expected * 0.03;
+    if (m_windowsSinceRaise >= 0) {
+        m_windowsSinceRaise++;
+    }
+    if (m_settleWindows > 0) {
+        // The consumer buffers were refilled at the new resolution during this window, ignore it
+        m_settleWindows--;
+        return false;
+    }
+    int level = qMax(m_level, levelForScaling(baseScaling));
+    m_atLowest = level == int(scalingSteps.size()) - 1;
+    if (m_lastSlow) {
+        m_smoothWindows = 0;
+        m_slowWindows++;
+        if (m_slowWindows < lowerAfter || m_atLowest) {
+            return false;
+        }
+        if (m_windowsSinceRaise >= 0 && m_windowsSinceRaise <= failedRaiseWindow) {
+            m_requiredSmoothWindows = qMin(maxRaiseAfter, m_requiredSmoothWindows * 2);
+        }
+        m_windowsSinceRaise = -1;
+        level++;
+    } else {
+        m_slowWindows = 0;
+        if (achieved < expected * 0.99 || dropped > 0) {
+            // Not slow enough to lower, not smooth enough to raise
+            m_smoothWindows = 0;
+            return false;
+        }
+        m_smoothWindows++;
+        if (m_smoothWindows < m_requiredSmoothWindows || m_level == 0 || m_level <= levelForScaling(baseScaling)) {
+            return false;
+        }
+        level = m_level - 1;
+        m_windowsSinceRaise = 0;
+    }
+    m_slowWindows = 0;
+    m_smoothWindows = 0;
+    m_settleWindows = 1;
+    if (level <= levelForScaling(baseScaling)) {
+        // Back to what the user selected
+        level = 0;
+    }
+    if (level == m_level) {
+        return false;
+    }
+    m_level = level;
+    return true;
+}
@@ -0,0 +1,66 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by agent <agent@local>                             *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+
+#ifndef ADAPTIVEPREVIEW_H
+#define ADAPTIVEPREVIEW_H
+
+#include "playbackmetrics.h"
+
+/**
+ * @class AdaptivePreview
+ * @brief Chooses the monitor preview scaling from the achieved playback rate.
+ * It is fed one PlaybackMetrics window per second while playing. When playback cannot keep up,
+ * the preview resolution is lowered one step at a time, and raised again after a stretch of
+ * smooth playback. A raise that is quickly followed by a new drop doubles the time we wait
+ * before trying again, so that the resolution does not oscillate.
+ */
+class AdaptivePreview
+{
+public:
+    AdaptivePreview();
+    /** @brief Forget the playback history and go back to the user's scaling */
+    void reset();
+    /** @brief Process one statistics window.
+     *  @param fps the project frame rate
+     *  @param baseScaling the preview scaling selected by the user, we never go above this resolution
+     *  @return true if scaling() changed
+     */
+    bool update(const PlaybackMetrics::Window &window, double fps, int baseScaling);
+    /** @brief The preview scaling to apply, in KdenliveSettings::previewScaling() units. 0 means no adaptive scaling */
+    int scaling() const;
+    /** @brief True if playback still cannot keep up at the lowest preview resolution */
+    bool isSaturated() const;
+    /** @brief True if the last window was not played in real time */
+    bool lastWindowSlow() const { return m_lastSlow; }
+
+private:
+    int m_level;
+    int m_slowWindows;
+    int m_smoothWindows;
+    int m_settleWindows;
+    int m_windowsSinceRaise;
+    int m_requiredSmoothWindows;
+    bool m_lastSlow;
+    bool m_atLowest;
+};
+
+#endif
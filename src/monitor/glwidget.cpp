@@ -23,6 +23,7 @@
 #include <KDeclarative/KDeclarative>
 #include <KMessageBox>
 #include <QApplication>
+#include <QOpenGLExtraFunctions>
 #include <QOpenGLFunctions_3_2_Core>
 #include <QPainter>
 #include <QQmlContext>
@@ -80,6 +81,7 @@ GLWidget::GLWidget(int id, QObject *parent)
     , m_threadCreateEvent(nullptr)
     , m_threadJoinEvent(nullptr)
     , m_displayEvent(nullptr)
+    , m_renderEvent(nullptr)
     , m_frameRenderer(nullptr)
     , m_projectionLocation(0)
     , m_modelViewLocation(0)
@@ -95,6 +97,8 @@ GLWidget::GLWidget(int id, QObject *parent)
     , m_isLoopMode(false)
     , m_loopIn(0)
     , m_offset(QPoint(0, 0))
+    , m_adaptiveScaling(0)
+    , m_textureFence(nullptr)
     , m_fbo(nullptr)
     , m_shareContext(nullptr)
     , m_openGLSync(false)
@@ -153,6 +157,7 @@ GLWidget::~GLWidget()
     delete m_threadCreateEvent;
     delete m_threadJoinEvent;
     delete m_displayEvent;
+    delete m_renderEvent;
     if (m_frameRenderer) {
         if (m_frameRenderer->isRunning()) {
             QMetaObject::invokeMethod(m_frameRenderer, "cleanup");
@@ -208,6 +213,7 @@ void GLWidget::initializeGL()
     m_frameRenderer = new FrameRenderer(openglContext(), &m_offscreenSurface, m_ClientWaitSync);
 
     m_frameRenderer->sendAudioForAnalysis = KdenliveSettings::monitor_audio();
+    m_frameRenderer->metrics = &m_metrics;
 
     openglContext()->makeCurrent(this);
     connect(m_frameRenderer, &FrameRenderer::textureReady, this, &GLWidget::updateTexture, Qt::DirectConnection);
@@ -332,64 +338,6 @@ void GLWidget::createYUVTextureProjectFragmentProg()
     m_colorspaceLocation = m_shader->uniformLocation("colorspace");
 }
 
-static void uploadTextures(QOpenGLContext *context, const SharedFrame &frame, GLuint texture[])
-{
-    int width = frame.get_image_width();
-    int height = frame.get_image_height();
-    const uint8_t *image = frame.get_image(mlt_image_yuv420p);
-    QOpenGLFunctions *f = context->functions();
-
-    // The planes of pixel data may not be a multiple of the default 4 bytes.
-    f->glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-
-    // Upload each plane of YUV to a texture.
-    if (texture[0] != 0u) {
-        f->glDeleteTextures(3, texture);
-    }
-    check_error(f);
-    f->glGenTextures(3, texture);
-    check_error(f);
-
-    f->glBindTexture(GL_TEXTURE_2D, texture[0]);
-    check_error(f);
-    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    check_error(f);
-    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    check_error(f);
-    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    check_error(f);
-    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    check_error(f);
-    f->glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE, width, height, 0, GL_LUMINANCE, GL_UNSIGNED_BYTE, image);
-    check_error(f);
-
-    f->glBindTexture(GL_TEXTURE_2D, texture[1]);
-    check_error(f);
-    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    check_error(f);
-    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    check_error(f);
-    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    check_error(f);
-    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    check_error(f);
-    f->glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE, width / 2, height / 2, 0, GL_LUMINANCE, GL_UNSIGNED_BYTE, image + width * height);
-    check_error(f);
-
-    f->glBindTexture(GL_TEXTURE_2D, texture[2]);
-    check_error(f);
-    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    check_error(f);
-    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    check_error(f);
-    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    check_error(f);
-    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    check_error(f);
-    f->glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE, width / 2, height / 2, 0, GL_LUMINANCE, GL_UNSIGNED_BYTE, image + width * height + width / 2 * height / 2);
-    check_error(f);
-}
-
 void GLWidget::clear()
 {
     stopGlsl();
@@ -409,13 +357,32 @@ bool GLWidget::acquireSharedFrameTextures()
         if (!m_sharedFrame.is_valid()) {
             return false;
         }
-        uploadTextures(openglContext(), m_sharedFrame, m_texture);
+        if (!m_uploader.isInitialized()) {
+            // Uploads happen in the drawing context, no need for asynchronous transfers
+            m_uploader.initialize(openglContext(), false);
+        }
+        const uint8_t *image = m_sharedFrame.get_image(mlt_image_yuv420p);
+        m_uploader.upload(image, m_sharedFrame.get_image_width(), m_sharedFrame.get_image_height(), m_texture);
     } else if (m_glslManager) {
         // C & D
         m_contextSharedAccess.lock();
         if (m_sharedFrame.is_valid()) {
             m_texture[0] = *((const GLuint *)m_sharedFrame.get_image(mlt_image_glsl_texture));
         }
+    } else {
+        // B
+        QMutexLocker locker(&m_contextSharedAccess);
+        if (m_textureFence != nullptr) {
+            // Let the GPU wait for the frame renderer's transfer without blocking this thread
+            QOpenGLExtraFunctions *ef = openglContext()->extraFunctions();
+            ef->glWaitSync(m_textureFence, 0, GL_TIMEOUT_IGNORED);
+            ef->glDeleteSync(m_textureFence);
+            m_textureFence = nullptr;
+        }
+        if (m_texture[0] && m_frameRenderer) {
+            // The frame renderer must not upload into the textures we draw
+            m_frameRenderer->uploader()->beginRead(m_texture[0]);
+        }
     }
 
     if (!m_texture[0]) {
@@ -449,6 +416,16 @@ void GLWidget::releaseSharedFrameTextures()
     if (m_glslManager) {
         glFinish();
         m_contextSharedAccess.unlock();
+    } else if (m_frameRenderer && openglContext()->supportsThreadedOpenGL()) {
+        // B: the textures can be reused for another frame once the GPU is done drawing them
+        if (TextureUploader::supportsSync(openglContext())) {
+            m_frameRenderer->uploader()->endRead(openglContext()->extraFunctions()->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+            // Fences are only visible to other contexts once submitted
+            glFlush();
+        } else {
+            glFinish();
+            m_frameRenderer->uploader()->endRead(nullptr);
+        }
     }
 }
 
@@ -1029,20 +1006,7 @@ int GLWidget::reconfigureMulti(const QString &params, const QString &path, Mlt::
             m_consumer->set(key.toUtf8().constData(), value.toUtf8().constData());
         }
         // Connect the producer to the consumer - tell it to "run" later
-        delete m_displayEvent;
-        // C & D
-        if (m_glslManager) {
-            // D
-            if (m_openGLSync) {
-                m_displayEvent = m_consumer->listen("consumer-frame-show", this, (mlt_listener)on_gl_frame_show);
-            } else {
-                // C
-                m_displayEvent = m_consumer->listen("consumer-frame-show", this, (mlt_listener)on_gl_nosync_frame_show);
-            }
-        } else {
-            // A & B
-            m_displayEvent = m_consumer->listen("consumer-frame-show", this, (mlt_listener)on_frame_show);
-        }
+        connectFrameEvents(m_glslManager != nullptr, m_openGLSync);
         m_consumer->connect(*m_producer.get());
         m_consumer->start();
         return 0;
@@ -1148,14 +1112,7 @@ int GLWidget::reconfigure()
             m_consumer->set("mlt_image_format", "yuv422");
         }
 
-        delete m_displayEvent;
-        // C & D
-        if (m_glslManager) {
-            m_displayEvent = m_consumer->listen("consumer-frame-show", this, (mlt_listener)on_gl_frame_show);
-        } else {
-            // A & B
-            m_displayEvent = m_consumer->listen("consumer-frame-show", this, (mlt_listener)on_frame_show);
-        }
+        connectFrameEvents(m_glslManager != nullptr, true);
 
         int volume = KdenliveSettings::volume();
         if (serviceName.startsWith(QLatin1String("sdl"))) {
@@ -1257,6 +1214,12 @@ void GLWidget::setZoom(float zoom)
 
 void GLWidget::onFrameDisplayed(const SharedFrame &frame)
 {
+    if (m_metrics.isEnabled()) {
+        int64_t shown = frame.get_int64(PlaybackMetrics::showTimeProperty);
+        if (shown > 0) {
+            m_metrics.addSample(PlaybackMetrics::Display, PlaybackMetrics::timestamp() - shown);
+        }
+    }
     m_contextSharedAccess.lock();
     m_sharedFrame = frame;
     m_sendFrame = sendFrameForAnalysis;
@@ -1368,21 +1331,75 @@ const QString GLWidget::sceneList(const QString &root, const QString &fullPath,
     return playlist;
 }
 
-void GLWidget::updateTexture(GLuint yName, GLuint uName, GLuint vName)
+void GLWidget::updateTexture(GLuint yName, GLuint uName, GLuint vName, GLsync fence)
 {
+    QMutexLocker locker(&m_contextSharedAccess);
+    if (m_textureFence != nullptr) {
+        // The previous frame was never painted. We are called from the frame renderer, whose context is current
+        QOpenGLContext::currentContext()->extraFunctions()->glDeleteSync(m_textureFence);
+    }
+    m_textureFence = fence;
     m_texture[0] = yName;
     m_texture[1] = uName;
     m_texture[2] = vName;
 }
 
+void GLWidget::connectFrameEvents(bool glsl, bool sync)
+{
+    delete m_displayEvent;
+    delete m_renderEvent;
+    // C & D
+    if (glsl) {
+        // D
+        if (sync) {
+            m_displayEvent = m_consumer->listen("consumer-frame-show", this, (mlt_listener)on_gl_frame_show);
+        } else {
+            // C
+            m_displayEvent = m_consumer->listen("consumer-frame-show", this, (mlt_listener)on_gl_nosync_frame_show);
+        }
+    } else {
+        // A & B
+        m_displayEvent = m_consumer->listen("consumer-frame-show", this, (mlt_listener)on_frame_show);
+    }
+    m_renderEvent = m_consumer->listen("consumer-frame-render", this, (mlt_listener)on_frame_render);
+}
+
+void GLWidget::on_frame_render(mlt_consumer, void *self, mlt_frame frame_ptr)
+{
+    auto *widget = static_cast<GLWidget *>(self);
+    if (widget->m_metrics.isEnabled()) {
+        mlt_properties_set_int64(MLT_FRAME_PROPERTIES(frame_ptr), PlaybackMetrics::renderStartProperty, PlaybackMetrics::timestamp());
+    }
+}
+
+void GLWidget::recordFrameShow(GLWidget *widget, Mlt::Frame &frame)
+{
+    if (!widget->m_metrics.isEnabled()) {
+        return;
+    }
+    qint64 now = PlaybackMetrics::timestamp();
+    int64_t start = frame.get_int64(PlaybackMetrics::renderStartProperty);
+    if (start > 0) {
+        widget->m_metrics.addSample(PlaybackMetrics::Decode, now - start);
+    }
+    frame.set(PlaybackMetrics::showTimeProperty, int64_t(now));
+    if (widget->m_frameRenderer != nullptr) {
+        // Frames handed to the renderer and not yet displayed
+        widget->m_metrics.addQueueDepth(3 - widget->m_frameRenderer->semaphore()->available());
+    }
+}
+
 void GLWidget::on_frame_show(mlt_consumer, void *self, mlt_frame frame_ptr)
 {
     Mlt::Frame frame(frame_ptr);
     if (frame.get_int("rendered") != 0) {
         auto *widget = static_cast<GLWidget *>(self);
+        recordFrameShow(widget, frame);
         int timeout = (widget->consumer()->get_int("real_time") > 0) ? 0 : 1000;
         if ((widget->m_frameRenderer != nullptr) && widget->m_frameRenderer->semaphore()->tryAcquire(1, timeout)) {
             QMetaObject::invokeMethod(widget->m_frameRenderer, "showFrame", Qt::QueuedConnection, Q_ARG(Mlt::Frame, frame));
+        } else {
+            widget->m_metrics.addRendererDrop();
         }
     }
 }
@@ -1392,9 +1409,12 @@ void GLWidget::on_gl_nosync_frame_show(mlt_consumer, void *self, mlt_frame frame
     Mlt::Frame frame(frame_ptr);
     if (frame.get_int("rendered") != 0) {
         auto *widget = static_cast<GLWidget *>(self);
+        recordFrameShow(widget, frame);
         int timeout = (widget->consumer()->get_int("real_time") > 0) ? 0 : 1000;
         if ((widget->m_frameRenderer != nullptr) && widget->m_frameRenderer->semaphore()->tryAcquire(1, timeout)) {
             QMetaObject::invokeMethod(widget->m_frameRenderer, "showGLNoSyncFrame", Qt::QueuedConnection, Q_ARG(Mlt::Frame, frame));
+        } else {
+            widget->m_metrics.addRendererDrop();
         }
     }
 }
@@ -1404,9 +1424,12 @@ void GLWidget::on_gl_frame_show(mlt_consumer, void *self, mlt_frame frame_ptr)
     Mlt::Frame frame(frame_ptr);
     if (frame.get_int("rendered") != 0) {
         auto *widget = static_cast<GLWidget *>(self);
+        recordFrameShow(widget, frame);
         int timeout = (widget->consumer()->get_int("real_time") > 0) ? 0 : 1000;
         if ((widget->m_frameRenderer != nullptr) && widget->m_frameRenderer->semaphore()->tryAcquire(1, timeout)) {
             QMetaObject::invokeMethod(widget->m_frameRenderer, "showGLFrame", Qt::QueuedConnection, Q_ARG(Mlt::Frame, frame));
+        } else {
+            widget->m_metrics.addRendererDrop();
         }
     }
 }
@@ -1456,10 +1479,9 @@ FrameRenderer::FrameRenderer(QOpenGLContext *shareContext, QSurface *surface, GL
     , m_ClientWaitSync(clientWaitSync)
     , m_gl32(nullptr)
     , sendAudioForAnalysis(false)
+    , metrics(nullptr)
 {
     Q_ASSERT(shareContext);
-    m_renderTexture[0] = m_renderTexture[1] = m_renderTexture[2] = 0;
-    m_displayTexture[0] = m_displayTexture[1] = m_displayTexture[2] = 0;
     // B & C & D
     if (KdenliveSettings::gpu_accel() || shareContext->supportsThreadedOpenGL()) {
         m_context = new QOpenGLContext;
@@ -1479,24 +1501,44 @@ FrameRenderer::~FrameRenderer()
     delete m_gl32;
 }
 
+qint64 FrameRenderer::startMeasure(Mlt::Frame &frame)
+{
+    if (metrics == nullptr || !metrics->isEnabled()) {
+        return 0;
+    }
+    qint64 now = PlaybackMetrics::timestamp();
+    int64_t shown = frame.get_int64(PlaybackMetrics::showTimeProperty);
+    if (shown > 0) {
+        metrics->addSample(PlaybackMetrics::Queue, now - shown);
+    }
+    return now;
+}
+
 void FrameRenderer::showFrame(Mlt::Frame frame)
 {
+    qint64 start = startMeasure(frame);
     // Save this frame for future use and to keep a reference to the GL Texture.
     m_displayFrame = SharedFrame(frame);
 
     if ((m_context != nullptr) && m_context->isValid()) {
         m_context->makeCurrent(m_surface);
+        if (!m_uploader.isInitialized()) {
+            m_uploader.initialize(m_context);
+        }
         // Upload each plane of YUV to a texture.
         QOpenGLFunctions *f = m_context->functions();
-        uploadTextures(m_context, m_displayFrame, m_renderTexture);
-        f->glBindTexture(GL_TEXTURE_2D, 0);
+        GLuint textures[3];
+        const uint8_t *image = m_displayFrame.get_image(mlt_image_yuv420p);
+        GLsync fence = m_uploader.upload(image, m_displayFrame.get_image_width(), m_displayFrame.get_image_height(), textures);
         check_error(f);
-        f->glFinish();
-
-        for (int i = 0; i < 3; ++i) {
-            std::swap(m_renderTexture[i], m_displayTexture[i]);
+        if (fence == nullptr) {
+            // Direct upload, the monitor's context has no other way to know when it is done
+            f->glFinish();
+        }
+        if (start > 0) {
+            metrics->addSample(PlaybackMetrics::Upload, PlaybackMetrics::timestamp() - start);
         }
-        emit textureReady(m_displayTexture[0], m_displayTexture[1], m_displayTexture[2]);
+        emit textureReady(textures[0], textures[1], textures[2], fence);
         m_context->doneCurrent();
     }
     // The frame is now done being modified and can be shared with the rest
@@ -1507,11 +1549,15 @@ void FrameRenderer::showFrame(Mlt::Frame frame)
 
 void FrameRenderer::showGLFrame(Mlt::Frame frame)
 {
+    qint64 start = startMeasure(frame);
     if ((m_context != nullptr) && m_context->isValid()) {
         m_context->makeCurrent(m_surface);
         pipelineSyncToFrame(frame);
 
         m_context->functions()->glFinish();
+        if (start > 0) {
+            metrics->addSample(PlaybackMetrics::Upload, PlaybackMetrics::timestamp() - start);
+        }
         m_context->doneCurrent();
 
         // Save this frame for future use and to keep a reference to the GL Texture.
@@ -1525,11 +1571,15 @@ void FrameRenderer::showGLFrame(Mlt::Frame frame)
 
 void FrameRenderer::showGLNoSyncFrame(Mlt::Frame frame)
 {
+    qint64 start = startMeasure(frame);
     if ((m_context != nullptr) && m_context->isValid()) {
 
         frame.set("movit.convert.use_texture", 1);
         m_context->makeCurrent(m_surface);
         m_context->functions()->glFinish();
+        if (start > 0) {
+            metrics->addSample(PlaybackMetrics::Upload, PlaybackMetrics::timestamp() - start);
+        }
 
         m_context->doneCurrent();
 
@@ -1544,15 +1594,10 @@ void FrameRenderer::showGLNoSyncFrame(Mlt::Frame frame)
 
 void FrameRenderer::cleanup()
 {
-    if ((m_renderTexture[0] != 0u) && (m_renderTexture[1] != 0u) && (m_renderTexture[2] != 0u)) {
+    if (m_uploader.isInitialized()) {
         m_context->makeCurrent(m_surface);
-        m_context->functions()->glDeleteTextures(3, m_renderTexture);
-        if ((m_displayTexture[0] != 0u) && (m_displayTexture[1] != 0u) && (m_displayTexture[2] != 0u)) {
-            m_context->functions()->glDeleteTextures(3, m_displayTexture);
-        }
+        m_uploader.cleanup();
         m_context->doneCurrent();
-        m_renderTexture[0] = m_renderTexture[1] = m_renderTexture[2] = 0;
-        m_displayTexture[0] = m_displayTexture[1] = m_displayTexture[2] = 0;
     }
 }
 
@@ -1726,10 +1771,10 @@ void GLWidget::startConsumer()
         KMessageBox::error(
             qApp->activeWindow(),
             i18n("Could not create the video preview window.\nThere is something wrong with your Kdenlive install or your driver settings, please fix it."));
-        if (m_displayEvent) {
-            delete m_displayEvent;
-        }
+        delete m_displayEvent;
         m_displayEvent = nullptr;
+        delete m_renderEvent;
+        m_renderEvent = nullptr;
         m_consumer.reset();
         return;
     }
@@ -1819,7 +1864,7 @@ void GLWidget::updateScaling()
 {
 #if LIBMLT_VERSION_INT >= QT_VERSION_CHECK(6,20,0)
     int previewHeight = pCore->getCurrentFrameSize().height();
-    switch (KdenliveSettings::previewScaling()) {
+    switch (qMax(KdenliveSettings::previewScaling(), m_adaptiveScaling)) {
         case 2:
             previewHeight = qMin(previewHeight, 720);
             break;
@@ -1858,6 +1903,15 @@ void GLWidget::updateScaling()
 #endif
 }
 
+void GLWidget::setAdaptiveScaling(int scaling)
+{
+    if (m_adaptiveScaling == scaling) {
+        return;
+    }
+    m_adaptiveScaling = scaling;
+    updateScaling();
+}
+
 void GLWidget::switchRuler(bool show)
 {
     m_rulerHeight = show ? QFontInfo(QFontDatabase::systemFont(QFontDatabase::SmallestReadableFont)).pixelSize() * 1.5 : 0;
@@ -35,7 +35,9 @@
 #include "bin/model/markerlistmodel.hpp"
 #include "definitions.h"
 #include "kdenlivesettings.h"
+#include "playbackmetrics.h"
 #include "scopes/sharedframe.h"
+#include "textureuploader.h"
 
 #include <mlt++/MltProfile.h>
 
@@ -113,6 +115,8 @@ public:
     void releaseMonitor();
     int droppedFrames() const;
     void resetDrops();
+    /** @brief Per frame timings of the playback pipeline, only collected while enabled */
+    PlaybackMetrics *metrics() { return &m_metrics; }
     bool checkFrameNumber(int pos, int offset, bool isPlaying);
     /** @brief Return current timeline position */
     int getCurrentPos() const;
@@ -162,6 +166,11 @@ public slots:
     void reloadProfile();
     /** @brief Update MLT's consumer scaling */
     void updateScaling();
+    /** @brief Lower the preview resolution below the user's choice during playback, 0 to disable.
+     *  Uses the same values as KdenliveSettings::previewScaling() and is reset when playback stops
+     */
+    void setAdaptiveScaling(int scaling);
+    int adaptiveScaling() const { return m_adaptiveScaling; }
 
 signals:
     void frameDisplayed(const SharedFrame &frame);
@@ -234,8 +243,17 @@ private:
     QPoint m_offset;
     MonitorProxy *m_proxy;
     std::shared_ptr<Mlt::Producer> m_blackClip;
+    PlaybackMetrics m_metrics;
+    int m_adaptiveScaling;
+    /** @brief Pipeline B: pending transfer of the textures in m_texture, waited on before painting */
+    GLsync m_textureFence;
+    /** @brief Pipeline A: uploads the frames in the monitor's own context */
+    TextureUploader m_uploader;
+    /** @brief Listen to the consumer's frame events for the configured pipeline */
+    void connectFrameEvents(bool glsl, bool sync);
+    static void recordFrameShow(GLWidget *widget, Mlt::Frame &frame);
     static void on_frame_show(mlt_consumer, void *self, mlt_frame frame);
-    static void on_frame_render(mlt_consumer, GLWidget *widget, mlt_frame frame);
+    static void on_frame_render(mlt_consumer, void *self, mlt_frame frame_ptr);
     static void on_gl_frame_show(mlt_consumer, void *self, mlt_frame frame_ptr);
     static void on_gl_nosync_frame_show(mlt_consumer, void *self, mlt_frame frame_ptr);
     QOpenGLFramebufferObject *m_fbo;
@@ -248,7 +266,7 @@ private:
      */
 private slots:
     void resizeGL(int width, int height);
-    void updateTexture(GLuint yName, GLuint uName, GLuint vName);
+    void updateTexture(GLuint yName, GLuint uName, GLuint vName, GLsync fence);
     void paintGL();
     void onFrameDisplayed(const SharedFrame &frame);
     void refresh();
@@ -316,6 +334,7 @@ public:
     ~FrameRenderer() override;
     QSemaphore *semaphore() { return &m_semaphore; }
     QOpenGLContext *context() const { return m_context; }
+    TextureUploader *uploader() { return &m_uploader; }
     Q_INVOKABLE void showFrame(Mlt::Frame frame);
     Q_INVOKABLE void showGLFrame(Mlt::Frame frame);
     Q_INVOKABLE void showGLNoSyncFrame(Mlt::Frame frame);
@@ -324,7 +343,8 @@ public slots:
     void cleanup();
 
 signals:
-    void textureReady(GLuint yName, GLuint uName = 0, GLuint vName = 0);
+    /** @brief A frame was uploaded, @param fence must be waited on before sampling the textures if not null */
+    void textureReady(GLuint yName, GLuint uName, GLuint vName, GLsync fence);
     void frameDisplayed(const SharedFrame &frame);
 
 private:
@@ -336,10 +356,15 @@ private:
 
     void pipelineSyncToFrame(Mlt::Frame &);
 
+    TextureUploader m_uploader;
+
 public:
-    GLuint m_renderTexture[3];
-    GLuint m_displayTexture[3];
     QOpenGLFunctions_3_2_Core *m_gl32;
     bool sendAudioForAnalysis;
+    PlaybackMetrics *metrics;
+
+private:
+    /** @brief Record how long the frame waited for this thread, returns the start of its processing */
+    qint64 startMeasure(Mlt::Frame &frame);
 };
 #endif
@@ -148,6 +148,7 @@ Monitor::Monitor(Kdenlive::MonitorId id, MonitorManager *manager, QWidget *paren
     , m_forceSizeFactor(0)
     , m_offset(id == Kdenlive::ProjectMonitor ? TimelineModel::seekDuration : 0)
     , m_lastMonitorSceneType(MonitorSceneDefault)
+    , m_slowZoneReported(false)
 {
     auto *layout = new QVBoxLayout;
     layout->setContentsMargins(0, 0, 0, 0);
@@ -235,6 +236,10 @@ Monitor::Monitor(Kdenlive::MonitorId id, MonitorManager *manager, QWidget *paren
     });
 
     connect(manager, &MonitorManager::updatePreviewScaling, this, [this, scalingAction]() {
+        // Start adapting again from the new resolution
+        m_adaptivePreview.reset();
+        m_glMonitor->setAdaptiveScaling(0);
+        updatePlaybackStats();
         m_glMonitor->updateScaling();
         switch (KdenliveSettings::previewScaling()) {
             case 2:
@@ -1465,6 +1470,7 @@ void Monitor::pause()
     }
     m_glMonitor->switchPlay(false);
     m_playAction->setActive(false);
+    updatePlaybackStats();
     resetSpeedInfo();
 }
 
@@ -1472,6 +1478,7 @@ void Monitor::switchPlay(bool play)
 {
     m_playAction->setActive(play);
     m_glMonitor->switchPlay(play);
+    updatePlaybackStats();
     resetSpeedInfo();
 }
 
@@ -1481,18 +1488,8 @@ void Monitor::slotSwitchPlay()
         return;
     }
     m_glMonitor->switchPlay(m_playAction->isActive());
-    bool showDropped = false;
-    if (m_id == Kdenlive::ClipMonitor) {
-        showDropped =  KdenliveSettings::displayClipMonitorInfo() & 0x20;
-    } else if (m_id == Kdenlive::ProjectMonitor) {
-        showDropped =  KdenliveSettings::displayProjectMonitorInfo() & 0x20;
-    }
-    if (showDropped) {
-        m_glMonitor->resetDrops();
-        m_droppedTimer.start();
-    } else {
-        m_droppedTimer.stop();
-    }
+    m_droppedTimer.stop();
+    updatePlaybackStats();
     resetSpeedInfo();
 }
 
@@ -1951,7 +1948,10 @@ void Monitor::updateAudioForAnalysis()
 void Monitor::onFrameDisplayed(const SharedFrame &frame)
 {
     if (!m_glMonitor->checkFrameNumber(frame.get_position(), m_offset, m_playAction->isActive())) {
-        m_playAction->setActive(false);
+        if (m_playAction->isActive()) {
+            m_playAction->setActive(false);
+            updatePlaybackStats();
+        }
     }
     emit m_monitorManager->frameDisplayed(frame);
 }
@@ -1965,12 +1965,103 @@ void Monitor::checkDrops()
         m_qmlManager->setProperty(QStringLiteral("fps"), QString::number(pCore->getCurrentFps(), 'f', 2));
     } else {
         m_glMonitor->resetDrops();
-        dropped = pCore->getCurrentFps() - dropped;
         m_qmlManager->setProperty(QStringLiteral("dropped"), true);
-        m_qmlManager->setProperty(QStringLiteral("fps"), QString::number(dropped, 'f', 2));
+        m_qmlManager->setProperty(QStringLiteral("fps"), QString::number(pCore->getCurrentFps() - dropped, 'f', 2));
+    }
+    PlaybackMetrics *metrics = m_glMonitor->metrics();
+    if (!metrics->isEnabled()) {
+        return;
+    }
+    PlaybackMetrics::Window window = metrics->collect(dropped);
+    m_qmlManager->setProperty(QStringLiteral("stats"), PlaybackMetrics::summary(window));
+    const QString logFile = KdenliveSettings::monitormetricslog();
+    if (!logFile.isEmpty() && !PlaybackMetrics::appendToLog(logFile, m_id, window)) {
+        qCWarning(KDENLIVE_LOG) << "Cannot write playback statistics to" << logFile;
+    }
+    // Trick play and shuttle are not expected to run in real time
+    if (!KdenliveSettings::adaptivepreview() || !qFuzzyCompare(m_glMonitor->playSpeed(), 1.)) {
+        return;
+    }
+    if (m_adaptivePreview.update(window, pCore->getCurrentFps(), KdenliveSettings::previewScaling())) {
+        m_glMonitor->setAdaptiveScaling(m_adaptivePreview.scaling());
+    }
+    if (m_id != Kdenlive::ProjectMonitor) {
+        return;
+    }
+    if (m_adaptivePreview.lastWindowSlow()) {
+        int pos = m_glMonitor->getCurrentPos();
+        int start = qMax(0, pos - int(pCore->getCurrentFps() * window.duration / 1000.));
+        if (m_slowZone.isNull() || start > m_slowZone.y() + pCore->getCurrentFps()) {
+            // A new slow section
+            m_slowZone = QPoint(start, pos);
+            m_slowZoneReported = false;
+        } else {
+            m_slowZone.setY(pos);
+        }
+    }
+    if (m_adaptivePreview.isSaturated() && !m_slowZoneReported) {
+        m_slowZoneReported = true;
+        suggestPreviewRender();
+    }
+}
+
+void Monitor::updatePlaybackStats()
+{
+    int overlay = 0;
+    if (m_id == Kdenlive::ClipMonitor) {
+        overlay = KdenliveSettings::displayClipMonitorInfo();
+    } else if (m_id == Kdenlive::ProjectMonitor) {
+        overlay = KdenliveSettings::displayProjectMonitorInfo();
+    }
+    bool showDropped = overlay & 0x20;
+    bool collect = (overlay & 0x40) || KdenliveSettings::adaptivepreview() || !KdenliveSettings::monitormetricslog().isEmpty();
+    m_glMonitor->metrics()->setEnabled(collect);
+    if ((showDropped || collect) && m_playAction->isActive()) {
+        if (!m_droppedTimer.isActive()) {
+            m_glMonitor->resetDrops();
+            m_glMonitor->metrics()->reset();
+            m_adaptivePreview.reset();
+            m_slowZone = QPoint();
+            m_droppedTimer.start();
+        }
+        return;
+    }
+    m_droppedTimer.stop();
+    resetAdaptiveScaling();
+}
+
+void Monitor::resetAdaptiveScaling()
+{
+    if (m_glMonitor->adaptiveScaling() > 0) {
+        // Paused frames are always displayed at the selected resolution
+        m_glMonitor->setAdaptiveScaling(0);
+        m_glMonitor->requestRefresh();
     }
 }
 
+void Monitor::suggestPreviewRender()
+{
+    if (m_slowZone.y() <= m_slowZone.x()) {
+        return;
+    }
+    const QPoint zone = m_slowZone;
+    QAction *renderPreview = new QAction(i18n("Render Preview"), m_infoMessage);
+    connect(renderPreview, &QAction::triggered, this, [this, zone, renderPreview]() {
+        m_infoMessage->removeAction(renderPreview);
+        m_infoMessage->animatedHide();
+        renderPreview->deleteLater();
+        emit renderPreviewZone(zone);
+    });
+    // Remove the action of a previous suggestion
+    const QList<QAction *> actions = m_infoMessage->actions();
+    for (QAction *ac : actions) {
+        m_infoMessage->removeAction(ac);
+    }
+    warningMessage(i18n("Playback is too slow between %1 and %2 even at the lowest resolution", m_glMonitor->frameToTime(zone.x()),
+                        m_glMonitor->frameToTime(zone.y())),
+                   10000, {renderPreview});
+}
+
 void Monitor::reloadProducer(const QString &id)
 {
     if (!m_controller) {
@@ -2326,18 +2417,11 @@ void Monitor::updateQmlDisplay(int currentOverlay)
 {
     m_glMonitor->rootObject()->setVisible((currentOverlay & 0x01) != 0);
     m_glMonitor->rootObject()->setProperty("showMarkers", currentOverlay & 0x04);
-    bool showDropped = currentOverlay & 0x20;
-    m_glMonitor->rootObject()->setProperty("showFps", showDropped);
+    m_glMonitor->rootObject()->setProperty("showFps", currentOverlay & 0x20);
+    m_glMonitor->rootObject()->setProperty("showStats", currentOverlay & 0x40);
     m_glMonitor->rootObject()->setProperty("showTimecode", currentOverlay & 0x02);
     m_glMonitor->rootObject()->setProperty("showAudiothumb", currentOverlay & 0x10);
-    if (showDropped) {
-         if (!m_droppedTimer.isActive() && m_playAction->isActive()) {
-            m_glMonitor->resetDrops();
-            m_droppedTimer.start();
-         }
-    } else {
-        m_droppedTimer.stop();
-    }
+    updatePlaybackStats();
 }
 
 void Monitor::clearDisplay()
@@ -2397,6 +2481,7 @@ void Monitor::slotStart()
         return;
     }
     m_glMonitor->switchPlay(false);
+    resetAdaptiveScaling();
     m_glMonitor->getControllerProxy()->setPosition(0);
     resetSpeedInfo();
 }
@@ -2407,6 +2492,7 @@ void Monitor::slotEnd()
         return;
     }
     m_glMonitor->switchPlay(false);
+    resetAdaptiveScaling();
     resetSpeedInfo();
     if (m_id == Kdenlive::ClipMonitor) {
         m_glMonitor->getControllerProxy()->setPosition(m_glMonitor->duration() - 1);
@@ -21,6 +21,7 @@
 #define MONITOR_H
 
 #include "abstractmonitor.h"
+#include "adaptivepreview.h"
 #include "bin/model/markerlistmodel.hpp"
 #include "definitions.h"
 #include "gentime.h"
@@ -232,6 +233,10 @@ private:
     MonitorSceneType m_lastMonitorSceneType;
     MonitorAudioLevel *m_audioMeterWidget;
     QTimer m_droppedTimer;
+    AdaptivePreview m_adaptivePreview;
+    /** @brief Timeline section that could not be played in real time, and whether we already offered to preview render it */
+    QPoint m_slowZone;
+    bool m_slowZoneReported;
     double m_displayedFps;
     QLabel *m_speedLabel;
     int m_speedIndex;
@@ -279,8 +284,14 @@ private slots:
     void removeSnapPoint(int pos);
     /** @brief Process seek and optionally pause monitor */
     void processSeek(int pos);
-    /** @brief Check and display dropped frames */
+    /** @brief Check and display dropped frames and playback statistics */
     void checkDrops();
+    /** @brief Start or stop the dropped frames timer, playback statistics and adaptive resolution */
+    void updatePlaybackStats();
+    /** @brief Go back to the selected preview resolution after playback */
+    void resetAdaptiveScaling();
+    /** @brief Offer to render a timeline preview for a section that plays too slowly at any resolution */
+    void suggestPreviewRender();
     /** @brief En/Disable the show record timecode feature in clip monitor */
     void slotSwitchRecTimecode(bool enable);
 
@@ -374,6 +385,8 @@ signals:
     void acceptRipple(bool);
     void switchTrimMode(int);
     void activateTrack(int);
+    /** @brief Ask the timeline to render a preview of a section that cannot be played in real time */
+    void renderPreviewZone(const QPoint &zone);
     void autoKeyframeChanged();
 };
 
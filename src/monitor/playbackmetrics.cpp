@@ -0,0 +1,225 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by agent <agent@local>                             *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+
+#include "playbackmetrics.h"
+
+#include "klocalizedstring.h"
+#include <QDateTime>
+#include <QFile>
+#include <QMutexLocker>
+#include <QStringList>
+#include <QTextStream>
+#include <algorithm>
+#include <cmath>
+
+constexpr std::array<int, 7> PlaybackMetrics::bucketLimits;
+const char *PlaybackMetrics::renderStartProperty = "_kdenlive_render_start";
+const char *PlaybackMetrics::showTimeProperty = "_kdenlive_show_time";
+
+PlaybackMetrics::PlaybackMetrics()
+    : m_enabled(false)
+    , m_rendererDrops(0)
+    , m_depthTotal(0)
+    , m_depthCount(0)
+    , m_maxDepth(0)
+{
+    m_windowTimer.start();
+}
+
+qint64 PlaybackMetrics::timestamp()
+{
+    static const QElapsedTimer clock = [] {
+        QElapsedTimer timer;
+        timer.start();
+        return timer;
+    }();
+    return clock.nsecsElapsed() / 1000;
+}
+
+QString PlaybackMetrics::stageName(Stage stage)
+{
+    switch (stage) {
+    case Decode:
+        return QStringLiteral("decode");
+    case Queue:
+        return QStringLiteral("queue");
+    case Upload:
+        return QStringLiteral("upload");
+    case Display:
+        return QStringLiteral("display");
+    default:
+        return QString();
+    }
+}
+
+void PlaybackMetrics::setEnabled(bool enabled)
+{
+    if (enabled && !m_enabled) {
+        reset();
+    }
+    m_enabled = enabled;
+}
+
+void PlaybackMetrics::addSample(Stage stage, qint64 usecs)
+{
+    if (!m_enabled || usecs < 0) {
+        return;
+    }
+    QMutexLocker lk(&m_mutex);
+    m_samples[stage].push_back(usecs);
+}
+
+void PlaybackMetrics::addRendererDrop()
+{
+    if (!m_enabled) {
+        return;
+    }
+    QMutexLocker lk(&m_mutex);
+    m_rendererDrops++;
+}
+
+void PlaybackMetrics::addQueueDepth(int depth)
+{
+    if (!m_enabled) {
+        return;
+    }
+    QMutexLocker lk(&m_mutex);
+    m_depthTotal += depth;
+    m_depthCount++;
+    m_maxDepth = qMax(m_maxDepth, depth);
+}
+
+void PlaybackMetrics::reset()
+{
+    QMutexLocker lk(&m_mutex);
+    for (auto &s : m_samples) {
+        s.clear();
+    }
+    m_rendererDrops = 0;
+    m_depthTotal = 0;
+    m_depthCount = 0;
+    m_maxDepth = 0;
+    m_windowTimer.restart();
+}
+
+PlaybackMetrics::Window PlaybackMetrics::collect(int consumerDrops)
+{
+    std::array<std::vector<qint64>, StageCount> samples;
+    Window window;
+    {
+        QMutexLocker lk(&m_mutex);
+        // Swap so that the consumer threads are not blocked while we sort
+        for (int i = 0; i < StageCount; ++i) {
+            std::swap(samples[i], m_samples[i]);
+            m_samples[i].reserve(samples[i].size());
+        }
+        window.duration = m_windowTimer.restart();
+        window.rendererDrops = m_rendererDrops;
+        window.averageQueueDepth = m_depthCount > 0 ? double(m_depthTotal) / m_depthCount : 0.;
+        window.maxQueueDepth = m_maxDepth;
+        m_rendererDrops = 0;
+        m_depthTotal = 0;
+        m_depthCount = 0;
+        m_maxDepth = 0;
+    }
+    window.consumerDrops = consumerDrops;
+    for (int i = 0; i < StageCount; ++i) {
+        std::vector<qint64> &values = samples[i];
+        StageStats &stats = window.stages[i];
+        stats.count = int(values.size());
+        if (values.empty()) {
+            continue;
+        }
+        std::sort(values.begin(), values.end());
+        qint64 total = 0;
+        for (qint64 v : values) {
+            total += v;
+            // Samples are in microseconds, buckets in milliseconds
+            auto bucket = std::upper_bound(bucketLimits.begin(), bucketLimits.end(), int(v / 1000));
+            stats.histogram[size_t(bucket - bucketLimits.begin())]++;
+        }
+        stats.average = total / 1000. / values.size();
+        stats.p95 = values.at(std::min(values.size() - 1, size_t(std::ceil(values.size() * 0.95)) - 1)) / 1000.;
+        stats.max = values.back() / 1000.;
+    }
+    return window;
+}
+
+QString PlaybackMetrics::summary(const Window &window)
+{
+    // One bar per histogram bucket, scaled to the fullest bucket
+    static const QString bars = QStringLiteral(" ▁▂▃▄▅▆▇█");
+    QStringList lines;
+    lines << i18n("latency avg / p95 / max, histogram <1 to %1+ ms", bucketLimits.back());
+    for (int i = 0; i < StageCount; ++i) {
+        const StageStats &stats = window.stages[size_t(i)];
+        if (stats.count == 0) {
+            continue;
+        }
+        int peak = *std::max_element(stats.histogram.begin(), stats.histogram.end());
+        QString histogram;
+        for (int count : stats.histogram) {
+            histogram.append(bars.at(count == 0 ? 0 : 1 + (count * (bars.size() - 2)) / peak));
+        }
+        lines << QStringLiteral("%1 %2 / %3 / %4 ms %5").arg(stageName(Stage(i)).leftJustified(7), QString::number(stats.average, 'f', 1),
+                                                                  QString::number(stats.p95, 'f', 1), QString::number(stats.max, 'f', 1), histogram);
+    }
+    lines << i18n("dropped %1 (consumer %2, renderer %3)", window.consumerDrops + window.rendererDrops, window.consumerDrops, window.rendererDrops);
+    lines << i18n("renderer queue %1 (max %2)", QString::number(window.averageQueueDepth, 'f', 1), window.maxQueueDepth);
+    return lines.join(QLatin1Char('\n'));
+}
+
+bool PlaybackMetrics::appendToLog(const QString &path, int monitorId, const Window &window)
+{
+    QFile file(path);
+    bool newFile = !file.exists() || file.size() == 0;
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+        return false;
+    }
+    QTextStream out(&file);
+    if (newFile) {
+        QStringList header = {QStringLiteral("time"), QStringLiteral("monitor"), QStringLiteral("window_ms")};
+        for (int i = 0; i < StageCount; ++i) {
+            const QString name = stageName(Stage(i));
+            header << name + QStringLiteral("_frames") << name + QStringLiteral("_avg_ms") << name + QStringLiteral("_p95_ms")
+                   << name + QStringLiteral("_max_ms");
+            for (int b = 0; b < bucketCount; ++b) {
+                header << (b < int(bucketLimits.size()) ? QStringLiteral("%1_lt%2ms").arg(name).arg(bucketLimits.at(size_t(b)))
+                                                        : QStringLiteral("%1_ge%2ms").arg(name).arg(bucketLimits.back()));
+            }
+        }
+        header << QStringLiteral("consumer_drops") << QStringLiteral("renderer_drops") << QStringLiteral("queue_avg") << QStringLiteral("queue_max");
+        out << header.join(QLatin1Char(',')) << '\n';
+    }
+    QStringList row = {QDateTime::currentDateTime().toString(Qt::ISODateWithMs), QString::number(monitorId), QString::number(window.duration)};
+    for (const StageStats &stats : window.stages) {
+        row << QString::number(stats.count) << QString::number(stats.average, 'f', 3) << QString::number(stats.p95, 'f', 3)
+            << QString::number(stats.max, 'f', 3);
+        for (int count : stats.histogram) {
+            row << QString::number(count);
+        }
+    }
+    row << QString::number(window.consumerDrops) << QString::number(window.rendererDrops) << QString::number(window.averageQueueDepth, 'f', 2)
+        << QString::number(window.maxQueueDepth);
+    out << row.join(QLatin1Char(',')) << '\n';
+    return true;
+}
@@ -0,0 +1,113 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by agent <agent@local>                             *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+
+#ifndef PLAYBACKMETRICS_H
+#define PLAYBACKMETRICS_H
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QString>
+#include <array>
+#include <atomic>
+#include <vector>
+
+/**
+ * @class PlaybackMetrics
+ * @brief Collects per frame timings of a monitor's playback pipeline.
+ * Samples are added from the consumer, renderer and GUI threads and accumulated until
+ * collect() is called, usually once per second, which returns the statistics of that window.
+ * Timestamps are stored on the MLT frames so that each stage can be measured per frame.
+ */
+class PlaybackMetrics
+{
+public:
+    enum Stage {
+        /** @brief From the consumer requesting the frame to it being ready for display: decoding, effects and read ahead buffer */
+        Decode = 0,
+        /** @brief From the frame being ready to the frame renderer starting to process it */
+        Queue,
+        /** @brief Texture upload on the frame renderer thread, until the GPU is done or, with pixel buffers, until the transfer is queued */
+        Upload,
+        /** @brief From the frame being ready to the GUI thread receiving it */
+        Display,
+        StageCount
+    };
+    /** @brief Upper bounds in milliseconds of the histogram buckets, the last bucket holds everything above */
+    static constexpr std::array<int, 7> bucketLimits{{1, 2, 4, 8, 16, 33, 66}};
+    static constexpr int bucketCount = int(bucketLimits.size()) + 1;
+
+    struct StageStats
+    {
+        int count = 0;
+        double average = 0.;
+        double p95 = 0.;
+        double max = 0.;
+        std::array<int, bucketCount> histogram{};
+    };
+    struct Window
+    {
+        qint64 duration = 0;
+        std::array<StageStats, StageCount> stages;
+        int consumerDrops = 0;
+        int rendererDrops = 0;
+        double averageQueueDepth = 0.;
+        int maxQueueDepth = 0;
+    };
+
+    /** @brief Frame properties used to pass the timestamps between threads */
+    static const char *renderStartProperty;
+    static const char *showTimeProperty;
+
+    PlaybackMetrics();
+    /** @brief Monotonic timestamp in microseconds, shared by all monitors */
+    static qint64 timestamp();
+    static QString stageName(Stage stage);
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return m_enabled; }
+    void addSample(Stage stage, qint64 usecs);
+    /** @brief A frame was ready but the renderer queue was full */
+    void addRendererDrop();
+    void addQueueDepth(int depth);
+    /** @brief Close the current window.
+     *  @param consumerDrops the frames dropped by the MLT consumer during that window
+     */
+    Window collect(int consumerDrops);
+    void reset();
+
+    /** @brief Multi-line text for the monitor overlay */
+    static QString summary(const Window &window);
+    /** @brief Append the window to a CSV file, writing the header if the file is new */
+    static bool appendToLog(const QString &path, int monitorId, const Window &window);
+
+private:
+    std::atomic_bool m_enabled;
+    QMutex m_mutex;
+    QElapsedTimer m_windowTimer;
+    std::array<std::vector<qint64>, StageCount> m_samples;
+    int m_rendererDrops;
+    qint64 m_depthTotal;
+    int m_depthCount;
+    int m_maxDepth;
+};
+
+#endif
@@ -0,0 +1,261 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by agent <agent@local>                             *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+
+#include "textureuploader.h"
+#include "kdenlive_debug.h"
+
+#include <QOpenGLExtraFunctions>
+#include <algorithm>
+#include <cstring>
+
+// A transfer still pending after this long means the driver is stuck, stop waiting and let it synchronize the mapping
+static const GLuint64 slotTimeout = 100000000; // 100ms in nanoseconds
+
+// With a pixel buffer bound, texture data pointers are offsets in the buffer
+static const void *planeData(const uint8_t *image, size_t offset)
+{
+    return image != nullptr ? static_cast<const void *>(image + offset) : reinterpret_cast<const void *>(offset);
+}
+
+TextureUploader::TextureUploader()
+    : m_context(nullptr)
+    , m_mode(Direct)
+    , m_current(0)
+    , m_displayed(-1)
+{
+}
+
+bool TextureUploader::isSoftwareRenderer(QOpenGLContext *context)
+{
+    const QByteArray renderer(reinterpret_cast<const char *>(context->functions()->glGetString(GL_RENDERER)));
+    for (const char *name : {"llvmpipe", "softpipe", "Software Rasterizer", "SWR", "Microsoft Basic Render"}) {
+        if (renderer.contains(name)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TextureUploader::supportsSync(QOpenGLContext *context)
+{
+    // Fences need GLES 3.0, GL 3.2 or ARB_sync
+    const QPair<int, int> version = context->format().version();
+    if (context->isOpenGLES()) {
+        return version.first >= 3;
+    }
+    return version >= qMakePair(3, 2) || context->hasExtension(QByteArrayLiteral("GL_ARB_sync"));
+}
+
+void TextureUploader::initialize(QOpenGLContext *context, bool allowPixelBuffers)
+{
+    m_context = context;
+    m_mode = Direct;
+    if (!allowPixelBuffers || isSoftwareRenderer(context)) {
+        return;
+    }
+    // Mapping buffer ranges needs GL 3.0 or GLES 3.0
+    if (supportsSync(context) && (context->isOpenGLES() || context->format().version() >= qMakePair(3, 0))) {
+        m_mode = PixelBuffer;
+    }
+}
+
+void TextureUploader::allocate(Slot &slot, int width, int height)
+{
+    QOpenGLFunctions *f = m_context->functions();
+    if (slot.textures[0] == 0u) {
+        f->glGenTextures(3, slot.textures);
+    }
+    for (int i = 0; i < 3; ++i) {
+        f->glBindTexture(GL_TEXTURE_2D, slot.textures[i]);
+        f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        int w = i == 0 ? width : width / 2;
+        int h = i == 0 ? height : height / 2;
+        f->glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE, w, h, 0, GL_LUMINANCE, GL_UNSIGNED_BYTE, nullptr);
+    }
+    if (m_mode == PixelBuffer) {
+        if (slot.buffer == 0u) {
+            f->glGenBuffers(1, &slot.buffer);
+        }
+        f->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer);
+        f->glBufferData(GL_PIXEL_UNPACK_BUFFER, width * height + 2 * (width / 2) * (height / 2), nullptr, GL_STREAM_DRAW);
+        f->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+    slot.size = QSize(width, height);
+}
+
+void TextureUploader::uploadPlanes(const Slot &slot, const uint8_t *image, int width, int height)
+{
+    QOpenGLFunctions *f = m_context->functions();
+    const size_t lumaSize = size_t(width * height);
+    const size_t chromaSize = size_t((width / 2) * (height / 2));
+    f->glBindTexture(GL_TEXTURE_2D, slot.textures[0]);
+    f->glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_LUMINANCE, GL_UNSIGNED_BYTE, planeData(image, 0));
+    f->glBindTexture(GL_TEXTURE_2D, slot.textures[1]);
+    f->glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width / 2, height / 2, GL_LUMINANCE, GL_UNSIGNED_BYTE, planeData(image, lumaSize));
+    f->glBindTexture(GL_TEXTURE_2D, slot.textures[2]);
+    f->glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width / 2, height / 2, GL_LUMINANCE, GL_UNSIGNED_BYTE, planeData(image, lumaSize + chromaSize));
+    f->glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+bool TextureUploader::releaseFence(Slot &slot)
+{
+    if (slot.fence == nullptr) {
+        return true;
+    }
+    QOpenGLExtraFunctions *ef = m_context->extraFunctions();
+    bool done = true;
+    if (ef->glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, slotTimeout) == GL_TIMEOUT_EXPIRED) {
+        qCWarning(KDENLIVE_LOG) << "Texture upload still pending after" << slotTimeout / 1000000 << "ms";
+        done = false;
+    }
+    ef->glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+    return done;
+}
+
+void TextureUploader::releaseBuffers()
+{
+    QOpenGLFunctions *f = m_context->functions();
+    for (Slot &slot : m_slots) {
+        if (slot.fence != nullptr) {
+            m_context->extraFunctions()->glDeleteSync(slot.fence);
+            slot.fence = nullptr;
+        }
+        if (slot.buffer != 0u) {
+            f->glDeleteBuffers(1, &slot.buffer);
+            slot.buffer = 0;
+        }
+    }
+}
+
+void TextureUploader::beginRead(GLuint texture)
+{
+    QMutexLocker lock(&m_readMutex);
+    m_displayed = -1;
+    for (int i = 0; i < slotCount; ++i) {
+        if (m_slots[size_t(i)].textures[0] == texture) {
+            m_displayed = i;
+            break;
+        }
+    }
+}
+
+void TextureUploader::endRead(GLsync fence)
+{
+    QMutexLocker lock(&m_readMutex);
+    GLsync previous = fence;
+    if (m_displayed >= 0) {
+        // Fences of a context signal in order, the new one covers all previous draws
+        std::swap(previous, m_slots[size_t(m_displayed)].readFence);
+    }
+    if (previous != nullptr) {
+        m_context->extraFunctions()->glDeleteSync(previous);
+    }
+}
+
+GLsync TextureUploader::upload(const uint8_t *image, int width, int height, GLuint textures[3])
+{
+    GLsync readFence = nullptr;
+    m_readMutex.lock();
+    m_current = (m_current + 1) % slotCount;
+    if (m_current == m_displayed) {
+        // Never overwrite the textures on screen, the slot after it is neither displayed nor waiting for display
+        m_current = (m_current + 1) % slotCount;
+    }
+    Slot &slot = m_slots[size_t(m_current)];
+    std::swap(readFence, slot.readFence);
+    m_readMutex.unlock();
+    QOpenGLFunctions *f = m_context->functions();
+    if (readFence != nullptr) {
+        // Let the GPU finish drawing the slot's previous frame before its textures are overwritten
+        QOpenGLExtraFunctions *ef = m_context->extraFunctions();
+        ef->glWaitSync(readFence, 0, GL_TIMEOUT_IGNORED);
+        ef->glDeleteSync(readFence);
+    }
+    // The planes of pixel data may not be a multiple of the default 4 bytes.
+    f->glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    const bool transferDone = releaseFence(slot);
+    if (slot.size != QSize(width, height)) {
+        allocate(slot, width, height);
+    }
+    std::copy(slot.textures, slot.textures + 3, textures);
+    if (m_mode == Direct) {
+        uploadPlanes(slot, image, width, height);
+        return nullptr;
+    }
+    QOpenGLExtraFunctions *ef = m_context->extraFunctions();
+    const int size = width * height + 2 * (width / 2) * (height / 2);
+    f->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer);
+    GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT;
+    if (transferDone) {
+        // The slot's fence was signaled, nothing can still be reading from this buffer
+        access |= GL_MAP_UNSYNCHRONIZED_BIT;
+    }
+    void *dest = ef->glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, access);
+    if (dest == nullptr) {
+        qCWarning(KDENLIVE_LOG) << "Cannot map pixel buffer, using direct texture upload";
+        f->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        // Keep the textures, the drawing context may be using them
+        releaseBuffers();
+        m_mode = Direct;
+        uploadPlanes(slot, image, width, height);
+        return nullptr;
+    }
+    memcpy(dest, image, size_t(size));
+    ef->glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    uploadPlanes(slot, nullptr, width, height);
+    f->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    // One fence protects the slot from being overwritten, the other one is handed to the consumer
+    slot.fence = ef->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    GLsync ready = ef->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    // Fences are only visible to other contexts once submitted
+    f->glFlush();
+    return ready;
+}
+
+void TextureUploader::cleanup()
+{
+    if (m_context == nullptr) {
+        return;
+    }
+    QOpenGLFunctions *f = m_context->functions();
+    QMutexLocker lock(&m_readMutex);
+    m_displayed = -1;
+    for (Slot &slot : m_slots) {
+        if (slot.fence != nullptr) {
+            m_context->extraFunctions()->glDeleteSync(slot.fence);
+        }
+        if (slot.readFence != nullptr) {
+            m_context->extraFunctions()->glDeleteSync(slot.readFence);
+        }
+        if (slot.textures[0] != 0u) {
+            f->glDeleteTextures(3, slot.textures);
+        }
+        if (slot.buffer != 0u) {
+            f->glDeleteBuffers(1, &slot.buffer);
+        }
+        slot = Slot();
+    }
+}
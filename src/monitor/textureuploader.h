@@ -0,0 +1,104 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by agent <agent@local>                             *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef TEXTUREUPLOADER_H
+#define TEXTUREUPLOADER_H
+
+#include <QMutex>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QSize>
+#include <array>
+
+/**
+ * @class TextureUploader
+ * @brief Uploads planar YUV 4:2:0 images into three luminance textures.
+ * Textures are kept in a ring of slots, their storage only being reallocated when the frame size changes.
+ * When the context supports it, the pixels are copied into a mapped pixel buffer object and transferred
+ * with glTexSubImage2D, a fence marking the end of the transfer instead of a glFinish. A slot is only
+ * reused once its previous transfer is complete, so the CPU copy of a frame overlaps with the GPU
+ * transfer of the previous ones. Software renderers like llvmpipe, old desktop GL and GLES 2 use the
+ * direct path, uploading from client memory into the existing storage.
+ * When another context draws the textures, it reports it with beginRead() and endRead(): the slot being
+ * displayed is skipped, and a slot is only overwritten once the draw commands using it are complete.
+ */
+class TextureUploader
+{
+public:
+    enum Mode { Direct, PixelBuffer };
+    /** @brief Number of texture sets, the one being displayed, the one ready for display and the one being uploaded */
+    static const int slotCount = 3;
+
+    TextureUploader();
+    /** @brief Choose the upload path, must be called with @param context current.
+     *  @param allowPixelBuffers false to always use the direct path
+     */
+    void initialize(QOpenGLContext *context, bool allowPixelBuffers = true);
+    bool isInitialized() const { return m_context != nullptr; }
+    Mode mode() const { return m_mode; }
+    /** @brief Returns true for software OpenGL implementations, where pixel buffers only add a copy */
+    static bool isSoftwareRenderer(QOpenGLContext *context);
+    /** @brief Returns true if @param context has fence sync objects */
+    static bool supportsSync(QOpenGLContext *context);
+    /** @brief Upload an image into the next slot, @param textures receiving the Y, U and V textures.
+     *  With pixel buffers the transfer is asynchronous and a fence is returned. The context sampling the textures
+     *  must wait for it with glWaitSync and delete it. In direct mode nullptr is returned, the upload being
+     *  queued like any other GL command.
+     */
+    GLsync upload(const uint8_t *image, int width, int height, GLuint textures[3]);
+    /** @brief Called by the drawing context before it uses @param texture, the Y texture of a slot, which is then never overwritten */
+    void beginRead(GLuint texture);
+    /** @brief Called by the drawing context once its draw commands are issued, @param fence being signaled when they are complete.
+     *  The slot's textures are only overwritten after that. Takes ownership of the fence, nullptr if the drawing context finished.
+     */
+    void endRead(GLsync fence);
+    /** @brief Delete all GL objects, must be called with the context current */
+    void cleanup();
+
+private:
+    struct Slot
+    {
+        GLuint textures[3] = {0, 0, 0};
+        GLuint buffer = 0;
+        GLsync fence = nullptr;
+        GLsync readFence = nullptr;
+        QSize size;
+    };
+    QOpenGLContext *m_context;
+    Mode m_mode;
+    std::array<Slot, slotCount> m_slots;
+    int m_current;
+    /** @brief The slot drawn by the other context, -1 if none */
+    int m_displayed;
+    /** @brief Protects the slot choice and the read fences, which the drawing context updates from its own thread */
+    QMutex m_readMutex;
+
+    /** @brief (Re)create the textures of a slot for a frame size */
+    void allocate(Slot &slot, int width, int height);
+    /** @brief Copy the three planes into the slot textures, @param image being nullptr when reading from the bound pixel buffer */
+    void uploadPlanes(const Slot &slot, const uint8_t *image, int width, int height);
+    /** @brief Wait until the previous transfer from this slot is done, returns false if it timed out */
+    bool releaseFence(Slot &slot);
+    /** @brief Delete the pixel buffers and their fences, when falling back to the direct path */
+    void releaseBuffers();
+};
+
+#endif
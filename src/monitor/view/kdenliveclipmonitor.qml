@@ -31,6 +31,8 @@ Item {
     property bool showMarkers: false
     property bool showTimecode: false
     property bool showFps: false
+    property bool showStats: false
+    property string stats
     property bool showSafezone: false
     // Display hover audio thumbnails overlay
     property bool showAudiothumb: false
@@ -432,6 +434,24 @@ Item {
                     bottomMargin: overlayMargin
                 }
             }
+            Label {
+                id: playbackStats
+                font.family: "monospace"
+                font.pointSize: fontMetrics.font.pointSize
+                objectName: "playbackstats"
+                color: "#ffffff"
+                padding: 4
+                background: Rectangle {
+                    color: "#99000000"
+                }
+                text: root.stats
+                visible: root.showStats && root.stats.length > 0
+                anchors {
+                    right: parent.right
+                    bottom: fpsdropped.visible || timecode.visible ? fpsdropped.top : parent.bottom
+                    bottomMargin: fpsdropped.visible || timecode.visible ? 2 : overlayMargin
+                }
+            }
             Label {
                 id: inPoint
                 font: fixedFont
@@ -44,7 +44,6 @@
 
 AudioSpectrum::AudioSpectrum(QWidget *parent)
     : AbstractAudioScopeWidget(true, parent)
-    , m_fftTools()
     , m_lastFFT()
     , m_lastFFTLock(1)
     , m_peaks()
@@ -207,16 +206,15 @@ QImage AudioSpectrum::renderAudioScope(uint, const audioShortVector &audioFrame,
 
         // Get the spectral power distribution of the input samples,
         // using the given window size and function
-        auto *freqSpectrum = new float[(uint)fftWindow / 2];
+        QVector<float> freqSpectrum(fftWindow / 2);
         FFTTools::WindowType windowType = (FFTTools::WindowType)m_ui->windowFunction->itemData(m_ui->windowFunction->currentIndex()).toInt();
-        m_fftTools.fftNormalized(audioFrame, 0, (uint)num_channels, freqSpectrum, windowType, (uint)fftWindow, 0);
+        FFTTools::fftNormalized(audioFrame, 0, (uint)num_channels, freqSpectrum.data(), windowType, (uint)fftWindow, 0);
 
         // Store the current FFT window (for the HUD) and run the interpolation
         // for easy pixel-based dB value access
         QVector<float> dbMap;
         m_lastFFTLock.acquire();
-        m_lastFFT = QVector<float>(fftWindow / 2);
-        memcpy(m_lastFFT.data(), &(freqSpectrum[0]), (uint)fftWindow / 2 * sizeof(float));
+        m_lastFFT = freqSpectrum;
 
         uint right = uint(((float)m_freqMax) / ((float)m_freq / 2.) * float(m_lastFFT.size() - 1));
         dbMap = FFTTools::interpolatePeakPreserving(m_lastFFT, (uint)m_innerScopeRect.width(), 0, right, -180);
@@ -225,7 +223,6 @@ QImage AudioSpectrum::renderAudioScope(uint, const audioShortVector &audioFrame,
 #ifdef DEBUG_AUDIOSPEC
         QTime drawTime = QTime::currentTime();
 #endif
-        delete[] freqSpectrum;
         // Draw the spectrum
         QImage spectrum(m_scopeRect.size(), QImage::Format_ARGB32);
         spectrum.fill(qRgba(0, 0, 0, 0));
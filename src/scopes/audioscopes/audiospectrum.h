@@ -64,7 +64,6 @@ private:
     QAction *m_aTrackMouse;
     QAction *m_aShowMax;
 
-    FFTTools m_fftTools;
     QVector<float> m_lastFFT;
     QSemaphore m_lastFFTLock;
 
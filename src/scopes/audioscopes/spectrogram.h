@@ -57,7 +57,6 @@ protected:
 
 private:
     Ui::Spectrogram_UI *m_ui;
-    FFTTools m_fftTools;
     QAction *m_aResetHz;
     QAction *m_aGrid;
     QAction *m_aTrackMouse;
@@ -236,15 +236,15 @@ bool ClipModel::requestResize(int size, bool right, Fun &undo, Fun &redo, bool l
                         if (right) {
                             int newOut = m_position + getOut() - getIn();
                             if (oldOut < newOut) {
-                                emit ptr->invalidateZone(oldOut, newOut);
+                                emit ptr->invalidateZone(oldOut, newOut, m_currentTrackId);
                             } else {
-                                emit ptr->invalidateZone(newOut, oldOut);
+                                emit ptr->invalidateZone(newOut, oldOut, m_currentTrackId);
                             }
                         } else {
                             if (oldIn < m_position) {
-                                emit ptr->invalidateZone(oldIn, m_position);
+                                emit ptr->invalidateZone(oldIn, m_position, m_currentTrackId);
                             } else {
-                                emit ptr->invalidateZone(m_position, oldIn);
+                                emit ptr->invalidateZone(m_position, oldIn, m_currentTrackId);
                             }
                         }
                     }
@@ -282,15 +282,15 @@ bool ClipModel::requestResize(int size, bool right, Fun &undo, Fun &redo, bool l
                                 if (right) {
                                     int newOut = m_position + getOut() - getIn();
                                     if (oldOut < newOut) {
-                                        emit ptr->invalidateZone(oldOut, newOut);
+                                        emit ptr->invalidateZone(oldOut, newOut, m_currentTrackId);
                                     } else {
-                                        emit ptr->invalidateZone(newOut, oldOut);
+                                        emit ptr->invalidateZone(newOut, oldOut, m_currentTrackId);
                                     }
                                 } else {
                                     if (oldIn < m_position) {
-                                        emit ptr->invalidateZone(oldIn, m_position);
+                                        emit ptr->invalidateZone(oldIn, m_position, m_currentTrackId);
                                     } else {
-                                        emit ptr->invalidateZone(m_position, oldIn);
+                                        emit ptr->invalidateZone(m_position, oldIn, m_currentTrackId);
                                     }
                                 }
                             }
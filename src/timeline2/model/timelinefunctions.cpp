@@ -40,6 +40,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <QDebug>
 #include <QInputDialog>
 #include <QSemaphore>
+#include <algorithm>
 #include <klocalizedstring.h>
 #include <unordered_map>
 
@@ -56,6 +57,8 @@ QStringList waitingBinIds;
 QMap<QString, QString> mappedIds;
 QMap<int, int> tracksMap;
 QSemaphore semaphore(1);
+// The last items copied in this session, reused on paste to skip XML parsing
+std::shared_ptr<TimelineClipboard> lastCopy;
 
 RTTR_REGISTRATION
 {
@@ -364,7 +367,24 @@ bool TimelineFunctions::requestSpacerEndOperation(const std::shared_ptr<Timeline
             mainGroup = timeline->m_groups->getRootId(itemId);
         }
     }
-    if (liftOk && (mainGroup > -1 || clips.size() == 1)) {
+    bool rippled = false;
+    // The ripple shift only inserts or removes blank space. A backward move in overwrite mode lifted the
+    // zone above, which may have cut the selected items overlapping it, so it goes through the group move
+    if (timeline->m_editMode != TimelineMode::OverwriteEdit || endPosition > startPosition) {
+        // If we are moving the whole tail of the timeline, shift it in one step instead of moving each item
+        int rippleStart = INT_MAX;
+        for (int id : clips) {
+            rippleStart = qMin(rippleStart, timeline->getItemPosition(id));
+        }
+        if (timeline->getItemsInRange(affectedTrack, rippleStart, -1) == clips) {
+            QVector<int> tracks;
+            if (affectedTrack > -1) {
+                tracks << affectedTrack;
+            }
+            rippled = final = timeline->requestRippleShift(rippleStart, endPosition - startPosition, undo, redo, tracks);
+        }
+    }
+    if (!rippled && liftOk && (mainGroup > -1 || clips.size() == 1)) {
         if (clips.size() > 1) {
             final = timeline->requestGroupMove(itemId, mainGroup, 0, endPosition - startPosition, true, true, undo, redo);
         } else {
@@ -552,6 +572,19 @@ bool TimelineFunctions::liftZone(const std::shared_ptr<TimelineItemModel> &timel
 
 bool TimelineFunctions::removeSpace(const std::shared_ptr<TimelineItemModel> &timeline, QPoint zone, Fun &undo, Fun &redo, QVector<int> allowedTracks, bool useTargets)
 {
+    QVector<int> rippleTracks = allowedTracks;
+    if (useTargets) {
+        rippleTracks.clear();
+        for (const auto &track : timeline->m_allTracks) {
+            if (track->shouldReceiveTimelineOp()) {
+                rippleTracks << track->getId();
+            }
+        }
+    }
+    // Shift all following items in one step if possible, otherwise move them as a group
+    if (!rippleTracks.isEmpty() && timeline->requestRippleShift(zone.y() - 1, zone.x() - zone.y(), undo, redo, rippleTracks)) {
+        return true;
+    }
     std::unordered_set<int> clips;
     if (useTargets) {
         auto it = timeline->m_allTracks.cbegin();
@@ -598,6 +631,11 @@ bool TimelineFunctions::requestInsertSpace(const std::shared_ptr<TimelineItemMod
     timeline->requestClearSelection();
     Fun local_undo = []() { return true; };
     Fun local_redo = []() { return true; };
+    // Shift all following items in one step if possible, otherwise move them as a group
+    if (timeline->requestRippleShift(zone.x(), zone.y() - zone.x(), local_undo, local_redo, allowedTracks)) {
+        UPDATE_UNDO_REDO_NOLOCK(local_redo, local_undo, undo, redo);
+        return true;
+    }
     std::unordered_set<int> items;
     if (allowedTracks.isEmpty()) {
         // Select clips in all tracks
@@ -1298,6 +1336,85 @@ QPair<QList<int>, QList<int>> TimelineFunctions::getAVTracksIds(const std::share
     return {audioTracks, videoTracks};
 }
 
+namespace {
+std::shared_ptr<Mlt::Properties> copyProperties(Mlt::Properties &source)
+{
+    auto result = std::make_shared<Mlt::Properties>();
+    for (int i = 0; i < source.count(); i++) {
+        const char *name = source.get_name(i);
+        if (name == nullptr || name[0] == '_') {
+            continue;
+        }
+        result->set(name, source.get(i));
+    }
+    return result;
+}
+
+std::shared_ptr<TimelineClipboard> clipboardFromXml(const QDomDocument &copiedItems)
+{
+    QDomElement root = copiedItems.documentElement();
+    if (root.tagName() != QLatin1String("kdenlive-scene")) {
+        return nullptr;
+    }
+    auto data = std::make_shared<TimelineClipboard>();
+    data->documentId = root.attribute(QStringLiteral("documentid"));
+    data->offset = root.attribute(QStringLiteral("offset")).toInt();
+    data->masterTrack = root.attribute(QStringLiteral("masterTrack"), QStringLiteral("-1")).toInt();
+    data->masterAudioTrack = root.attribute(QStringLiteral("masterAudioTrack")).toInt();
+    data->groups = root.firstChildElement(QStringLiteral("groups")).text();
+    QDomNodeList clips = root.elementsByTagName(QStringLiteral("clip"));
+    data->clips.reserve(size_t(clips.count()));
+    for (int i = 0; i < clips.count(); i++) {
+        QDomElement prod = clips.at(i).toElement();
+        TimelineClipboard::ClipData clip;
+        clip.id = prod.attribute(QStringLiteral("id")).toInt();
+        clip.binId = prod.attribute(QStringLiteral("binid"));
+        clip.in = prod.attribute(QStringLiteral("in")).toInt();
+        clip.out = prod.attribute(QStringLiteral("out")).toInt();
+        clip.position = prod.attribute(QStringLiteral("position")).toInt();
+        clip.track = prod.attribute(QStringLiteral("track")).toInt();
+        clip.audioTrack = prod.hasAttribute(QStringLiteral("audioTrack"));
+        if (clip.audioTrack) {
+            clip.mirrorTrack = prod.attribute(QStringLiteral("mirrorTrack"), QStringLiteral("-1")).toInt();
+        }
+        clip.speed = prod.attribute(QStringLiteral("speed")).toDouble();
+        if (!qFuzzyCompare(clip.speed, 1.)) {
+            clip.warpPitch = prod.attribute(QStringLiteral("warp_pitch")).toInt();
+        }
+        clip.audioStream = prod.attribute(QStringLiteral("audioStream")).toInt();
+        QDomElement effects = prod.firstChildElement(QStringLiteral("effects"));
+        clip.effectsParentIn = effects.attribute(QStringLiteral("parentIn")).toInt();
+        clip.effects = EffectStackModel::propertiesFromXml(effects);
+        data->clips.push_back(clip);
+    }
+    QDomNodeList compositions = root.elementsByTagName(QStringLiteral("composition"));
+    data->compositions.reserve(size_t(compositions.count()));
+    for (int i = 0; i < compositions.count(); i++) {
+        QDomElement prod = compositions.at(i).toElement();
+        TimelineClipboard::CompositionData compo;
+        compo.assetId = prod.attribute(QStringLiteral("composition"));
+        compo.in = prod.attribute(QStringLiteral("in")).toInt();
+        compo.out = prod.attribute(QStringLiteral("out")).toInt();
+        compo.position = prod.attribute(QStringLiteral("position")).toInt();
+        compo.track = prod.attribute(QStringLiteral("track")).toInt();
+        compo.aTrack = prod.attribute(QStringLiteral("a_track")).toInt();
+        compo.properties = std::make_shared<Mlt::Properties>();
+        QDomNodeList props = prod.elementsByTagName(QStringLiteral("property"));
+        for (int j = 0; j < props.count(); j++) {
+            compo.properties->set(props.at(j).toElement().attribute(QStringLiteral("name")).toUtf8().constData(),
+                                  props.at(j).toElement().text().toUtf8().constData());
+        }
+        data->compositions.push_back(compo);
+    }
+    QDomNodeList binClips = root.elementsByTagName(QStringLiteral("producer"));
+    for (int i = 0; i < binClips.count(); ++i) {
+        QDomElement currentProd = binClips.item(i).toElement();
+        data->binClips.insert(Xml::getXmlProperty(currentProd, QStringLiteral("kdenlive:id")), Xml::getXmlProperty(currentProd, QStringLiteral("kdenlive:file_hash")));
+    }
+    return data;
+}
+} // namespace
+
 QString TimelineFunctions::copyClips(const std::shared_ptr<TimelineItemModel> &timeline, const std::unordered_set<int> &itemIds)
 {
     int clipId = *(itemIds.begin());
@@ -1313,6 +1430,7 @@ QString TimelineFunctions::copyClips(const std::shared_ptr<TimelineItemModel> &t
     int masterTid = timeline->getItemTrackId(clipId);
     bool audioCopy = timeline->isAudioTrack(masterTid);
     int masterTrack = timeline->getTrackPosition(masterTid);
+    auto snapshot = std::make_shared<TimelineClipboard>();
     QDomDocument copiedItems;
     int offset = -1;
     QDomElement container = copiedItems.createElement(QStringLiteral("kdenlive-scene"));
@@ -1323,13 +1441,43 @@ QString TimelineFunctions::copyClips(const std::shared_ptr<TimelineItemModel> &t
             offset = timeline->getItemPosition(id);
         }
         if (timeline->isClip(id)) {
-            container.appendChild(timeline->m_allClips[id]->toXml(copiedItems));
-            const QString bid = timeline->m_allClips[id]->binId();
-            if (!binIds.contains(bid)) {
-                binIds << bid;
+            std::shared_ptr<ClipModel> clip = timeline->m_allClips[id];
+            container.appendChild(clip->toXml(copiedItems));
+            TimelineClipboard::ClipData data;
+            data.id = id;
+            data.binId = clip->binId();
+            data.in = clip->getIn();
+            data.out = clip->getOut();
+            data.position = clip->getPosition();
+            int tid = clip->getCurrentTrackId();
+            data.track = timeline->getTrackPosition(tid);
+            data.audioTrack = timeline->isAudioTrack(tid);
+            if (data.audioTrack && timeline->getClipSplitPartner(id) != -1) {
+                int mirrorId = timeline->getMirrorVideoTrackId(tid);
+                data.mirrorTrack = mirrorId > -1 ? timeline->getTrackPosition(mirrorId) : -1;
+            }
+            data.speed = clip->getSpeed();
+            data.warpPitch = !qFuzzyCompare(data.speed, 1.) && clip->getIntProperty(QStringLiteral("warp_pitch"));
+            data.audioStream = clip->getIntProperty(QStringLiteral("audio_index"));
+            data.effectsParentIn = data.in;
+            data.effects = clip->m_effectStack->toProperties();
+            snapshot->clips.push_back(data);
+            if (!binIds.contains(data.binId)) {
+                binIds << data.binId;
             }
         } else if (timeline->isComposition(id)) {
-            container.appendChild(timeline->m_allCompositions[id]->toXml(copiedItems));
+            std::shared_ptr<CompositionModel> compo = timeline->m_allCompositions[id];
+            container.appendChild(compo->toXml(copiedItems));
+            TimelineClipboard::CompositionData data;
+            data.assetId = compo->getAssetId();
+            data.in = compo->getIn();
+            data.out = compo->getOut();
+            data.position = compo->getPosition();
+            data.track = timeline->getTrackPosition(compo->getCurrentTrackId());
+            data.aTrack = compo->getATrack();
+            QScopedPointer<Mlt::Properties> props(compo->properties());
+            data.properties = copyProperties(*props.data());
+            snapshot->compositions.push_back(data);
         } else if (timeline->isSubTitle(id)) {
             //TODO
         } else {
@@ -1342,10 +1490,12 @@ QString TimelineFunctions::copyClips(const std::shared_ptr<TimelineItemModel> &t
         std::shared_ptr<ProjectClip> clip = pCore->projectItemModel()->getClipByBinID(id);
         QDomDocument tmp;
         container2.appendChild(clip->toXml(tmp));
+        snapshot->binClips.insert(id, clip->hash());
     }
     container.setAttribute(QStringLiteral("offset"), offset);
     if (audioCopy) {
         container.setAttribute(QStringLiteral("masterAudioTrack"), masterTrack);
+        snapshot->masterAudioTrack = masterTrack;
         int masterMirror = timeline->getMirrorVideoTrackId(masterTid);
         if (masterMirror == -1) {
             QPair<QList<int>, QList<int>> projectTracks = TimelineFunctions::getAVTracksIds(timeline);
@@ -1359,7 +1509,8 @@ QString TimelineFunctions::copyClips(const std::shared_ptr<TimelineItemModel> &t
     /* masterTrack contains the reference track over which we want to paste.
        this is a video track, unless audioCopy is defined */
     container.setAttribute(QStringLiteral("masterTrack"), masterTrack);
-    container.setAttribute(QStringLiteral("documentid"), pCore->currentDoc()->getDocumentProperty(QStringLiteral("documentid")));
+    const QString documentId = pCore->currentDoc()->getDocumentProperty(QStringLiteral("documentid"));
+    container.setAttribute(QStringLiteral("documentid"), documentId);
     QDomElement grp = copiedItems.createElement(QStringLiteral("groups"));
     container.appendChild(grp);
 
@@ -1371,10 +1522,30 @@ QString TimelineFunctions::copyClips(const std::shared_ptr<TimelineItemModel> &t
         qDebug() << "GROUP: " << gp;
     }
     qDebug() << "\n=======";
-    grp.appendChild(copiedItems.createTextNode(timeline->m_groups->toJson(groupRoots)));
+    const QString groups = timeline->m_groups->toJson(groupRoots);
+    grp.appendChild(copiedItems.createTextNode(groups));
+
+    snapshot->documentId = documentId;
+    snapshot->offset = offset;
+    snapshot->masterTrack = masterTrack;
+    snapshot->groups = groups;
+    snapshot->xml = copiedItems.toString();
+    lastCopy = snapshot;
+    return snapshot->xml;
+}
 
-    qDebug() << " / // / PASTED DOC: \n\n" << copiedItems.toString() << "\n\n------------";
-    return copiedItems.toString();
+std::shared_ptr<TimelineClipboard> TimelineFunctions::readClipboard(const QString &pasteString)
+{
+    if (lastCopy && lastCopy->xml == pasteString) {
+        return lastCopy;
+    }
+    QDomDocument copiedItems;
+    copiedItems.setContent(pasteString);
+    std::shared_ptr<TimelineClipboard> data = clipboardFromXml(copiedItems);
+    if (data) {
+        data->xml = pasteString;
+    }
+    return data;
 }
 
 bool TimelineFunctions::pasteClips(const std::shared_ptr<TimelineItemModel> &timeline, const QString &pasteString, int trackId, int position)
@@ -1395,21 +1566,16 @@ bool TimelineFunctions::pasteClips(const std::shared_ptr<TimelineItemModel> &tim
         qApp->processEvents();
     }
     waitingBinIds.clear();
-    QDomDocument copiedItems;
-    copiedItems.setContent(pasteString);
-    if (copiedItems.documentElement().tagName() == QLatin1String("kdenlive-scene")) {
-        qDebug() << " / / READING CLIPS FROM CLIPBOARD";
-    } else {
+    std::shared_ptr<TimelineClipboard> copiedItems = readClipboard(pasteString);
+    if (!copiedItems) {
         semaphore.release(1);
         return false;
     }
-    const QString docId = copiedItems.documentElement().attribute(QStringLiteral("documentid"));
+    const QString docId = copiedItems->documentId;
     mappedIds.clear();
     // Check available tracks
     QPair<QList<int>, QList<int>> projectTracks = TimelineFunctions::getAVTracksIds(timeline);
-    int masterSourceTrack = copiedItems.documentElement().attribute(QStringLiteral("masterTrack"), QStringLiteral("-1")).toInt();
-    QDomNodeList clips = copiedItems.documentElement().elementsByTagName(QStringLiteral("clip"));
-    QDomNodeList compositions = copiedItems.documentElement().elementsByTagName(QStringLiteral("composition"));
+    int masterSourceTrack = copiedItems->masterTrack;
     // find paste tracks
     // List of all source audio tracks
     QList<int> audioTracks;
@@ -1421,20 +1587,18 @@ bool TimelineFunctions::pasteClips(const std::shared_ptr<TimelineItemModel> &tim
     QList<int> singleAudioTracks;
     // Number of required video tracks with mirror
     int topAudioMirror = 0;
-    for (int i = 0; i < clips.count(); i++) {
-        QDomElement prod = clips.at(i).toElement();
-        int trackPos = prod.attribute(QStringLiteral("track")).toInt();
+    for (const auto &clip : copiedItems->clips) {
+        int trackPos = clip.track;
         if (trackPos < 0) {
             pCore->displayMessage(i18n("Not enough tracks to paste clipboard"), InformationMessage, 500);
             semaphore.release(1);
             return false;
         }
-        bool audioTrack = prod.hasAttribute(QStringLiteral("audioTrack"));
-        if (audioTrack) {
+        if (clip.audioTrack) {
             if (!audioTracks.contains(trackPos)) {
                 audioTracks << trackPos;
             }
-            int videoMirror = prod.attribute(QStringLiteral("mirrorTrack")).toInt();
+            int videoMirror = clip.mirrorTrack;
             if (videoMirror == -1 || masterSourceTrack == -1) {
                 if (singleAudioTracks.contains(trackPos)) {
                     continue;
@@ -1458,13 +1622,12 @@ bool TimelineFunctions::pasteClips(const std::shared_ptr<TimelineItemModel> &tim
             videoTracks << trackPos;
         }
     }
-    for (int i = 0; i < compositions.count(); i++) {
-        QDomElement prod = compositions.at(i).toElement();
-        int trackPos = prod.attribute(QStringLiteral("track")).toInt();
+    for (const auto &compo : copiedItems->compositions) {
+        int trackPos = compo.track;
         if (!videoTracks.contains(trackPos)) {
             videoTracks << trackPos;
         }
-        int atrackPos = prod.attribute(QStringLiteral("a_track")).toInt();
+        int atrackPos = compo.aTrack;
         if (atrackPos == 0 || videoTracks.contains(atrackPos)) {
             continue;
         }
@@ -1520,7 +1683,7 @@ bool TimelineFunctions::pasteClips(const std::shared_ptr<TimelineItemModel> &tim
         }
     } else {
         // Audio only
-        masterSourceTrack = copiedItems.documentElement().attribute(QStringLiteral("masterAudioTrack")).toInt();
+        masterSourceTrack = copiedItems->masterAudioTrack;
         int tracksBelow = masterSourceTrack - audioTracks.first();
         int tracksAbove = audioTracks.last() - masterSourceTrack;
         if (projectTracks.first.indexOf(trackId) < tracksBelow) {
@@ -1590,10 +1753,25 @@ bool TimelineFunctions::pasteClips(const std::shared_ptr<TimelineItemModel> &tim
         }
     };
     bool clipsImported = false;
-
-    if (docId == pCore->currentDoc()->getDocumentProperty(QStringLiteral("documentid"))) {
+    const QString currentDocId = pCore->currentDoc()->getDocumentProperty(QStringLiteral("documentid"));
+    bool sameBinClips = docId == currentDocId;
+    if (sameBinClips) {
         // Check that the bin clips exists in case we try to paste in a copy of original project
-        QDomNodeList binClips = copiedItems.documentElement().elementsByTagName(QStringLiteral("producer"));
+        for (auto it = copiedItems->binClips.constBegin(); it != copiedItems->binClips.constEnd(); ++it) {
+            if (!pCore->projectItemModel()->validateClip(it.key(), it.value())) {
+                sameBinClips = false;
+                break;
+            }
+        }
+    }
+    // The bin clip descriptions are only needed when clips have to be imported
+    QDomDocument binData;
+    if (!sameBinClips && !docId.isEmpty()) {
+        binData.setContent(copiedItems->xml);
+    }
+
+    if (!sameBinClips && docId == currentDocId) {
+        QDomNodeList binClips = binData.documentElement().elementsByTagName(QStringLiteral("producer"));
         QString folderId = pCore->projectItemModel()->getFolderIdByName(i18n("Pasted clips"));
         for (int i = 0; i < binClips.count(); ++i) {
             QDomElement currentProd = binClips.item(i).toElement();
@@ -1617,7 +1795,7 @@ bool TimelineFunctions::pasteClips(const std::shared_ptr<TimelineItemModel> &tim
         }
     }
 
-    if (!docId.isEmpty() && docId != pCore->currentDoc()->getDocumentProperty(QStringLiteral("documentid"))) {
+    if (!docId.isEmpty() && docId != currentDocId) {
         // paste from another document, import bin clips
         QString folderId = pCore->projectItemModel()->getFolderIdByName(i18n("Pasted clips"));
         if (folderId.isEmpty()) {
@@ -1626,7 +1804,7 @@ bool TimelineFunctions::pasteClips(const std::shared_ptr<TimelineItemModel> &tim
             folderId = QString::number(pCore->projectItemModel()->getFreeFolderId());
             pCore->projectItemModel()->requestAddFolder(folderId, i18n("Pasted clips"), rootId, undo, redo);
         }
-        QDomNodeList binClips = copiedItems.documentElement().elementsByTagName(QStringLiteral("producer"));
+        QDomNodeList binClips = binData.documentElement().elementsByTagName(QStringLiteral("producer"));
         for (int i = 0; i < binClips.count(); ++i) {
             QDomElement currentProd = binClips.item(i).toElement();
             QString clipId = Xml::getXmlProperty(currentProd, QStringLiteral("kdenlive:id"));
@@ -1662,32 +1840,26 @@ bool TimelineFunctions::pasteClips(const std::shared_ptr<TimelineItemModel> &tim
     return true;
 }
 
-bool TimelineFunctions::pasteTimelineClips(const std::shared_ptr<TimelineItemModel> &timeline, QDomDocument copiedItems, int position)
+bool TimelineFunctions::pasteTimelineClips(const std::shared_ptr<TimelineItemModel> &timeline, const std::shared_ptr<TimelineClipboard> &copiedItems, int position)
 {
     std::function<bool(void)> timeline_undo = []() { return true; };
     std::function<bool(void)> timeline_redo = []() { return true; };
     return TimelineFunctions::pasteTimelineClips(timeline, copiedItems, position, timeline_undo, timeline_redo, true);
 }
 
-bool TimelineFunctions::pasteTimelineClips(const std::shared_ptr<TimelineItemModel> &timeline, QDomDocument copiedItems, int position, Fun &timeline_undo, Fun & timeline_redo, bool pushToStack)
+bool TimelineFunctions::pasteTimelineClips(const std::shared_ptr<TimelineItemModel> &timeline, const std::shared_ptr<TimelineClipboard> &copiedItems, int position, Fun &timeline_undo, Fun & timeline_redo, bool pushToStack)
 {
     // Wait until all bin clips are inserted
-    QDomNodeList clips = copiedItems.documentElement().elementsByTagName(QStringLiteral("clip"));
-    QDomNodeList compositions = copiedItems.documentElement().elementsByTagName(QStringLiteral("composition"));
-    int offset = copiedItems.documentElement().attribute(QStringLiteral("offset")).toInt();
+    int offset = copiedItems->offset;
 
     bool res = true;
     std::unordered_map<int, int> correspondingIds;
-    for (int i = 0; i < clips.count(); i++) {
-        QDomElement prod = clips.at(i).toElement();
-        QString originalId = prod.attribute(QStringLiteral("binid"));
-        if (mappedIds.contains(originalId)) {
-            // Map id
-            originalId = mappedIds.value(originalId);
-        }
-        int in = prod.attribute(QStringLiteral("in")).toInt();
-        int out = prod.attribute(QStringLiteral("out")).toInt();
-        int curTrackId = tracksMap.value(prod.attribute(QStringLiteral("track")).toInt());
+    for (const auto &clip : copiedItems->clips) {
+        // Map id
+        QString originalId = mappedIds.value(clip.binId, clip.binId);
+        int in = clip.in;
+        int out = clip.out;
+        int curTrackId = tracksMap.value(clip.track);
         if (!timeline->isTrack(curTrackId)) {
             // Something is broken
             pCore->displayMessage(i18n("Not enough tracks to paste clipboard"), InformationMessage, 500);
@@ -1695,15 +1867,9 @@ bool TimelineFunctions::pasteTimelineClips(const std::shared_ptr<TimelineItemMod
             semaphore.release(1);
             return false;
         }
-        int pos = prod.attribute(QStringLiteral("position")).toInt() - offset;
-        double speed = prod.attribute(QStringLiteral("speed")).toDouble();
-        bool warp_pitch = false;
-        if (!qFuzzyCompare(speed, 1.)) {
-            warp_pitch = prod.attribute(QStringLiteral("warp_pitch")).toInt();
-        }
-        int audioStream = prod.attribute(QStringLiteral("audioStream")).toInt();
+        int pos = clip.position - offset;
         int newId;
-        bool created = timeline->requestClipCreation(originalId, newId, timeline->getTrackById_const(curTrackId)->trackType(), audioStream, speed, warp_pitch, timeline_undo, timeline_redo);
+        bool created = timeline->requestClipCreation(originalId, newId, timeline->getTrackById_const(curTrackId)->trackType(), clip.audioStream, clip.speed, clip.warpPitch, timeline_undo, timeline_redo);
         if (!created) {
             // Something is broken
             pCore->displayMessage(i18n("Could not paste items in timeline"), InformationMessage, 500);
@@ -1717,13 +1883,13 @@ bool TimelineFunctions::pasteTimelineClips(const std::shared_ptr<TimelineItemMod
             timeline->m_allClips[newId]->m_producer->set("length", out + 1);
         }
         timeline->m_allClips[newId]->setInOut(in, out);
-        int targetId = prod.attribute(QStringLiteral("id")).toInt();
-        correspondingIds[targetId] = newId;
-        res = res && timeline->getTrackById(curTrackId)->requestClipInsertion(newId, position + pos, true, true, timeline_undo, timeline_redo);
+        correspondingIds[clip.id] = newId;
+        // Timeline duration is updated once all clips are inserted
+        res = res && timeline->getTrackById(curTrackId)->requestClipInsertion(newId, position + pos, true, true, timeline_undo, timeline_redo, true);
         // paste effects
         if (res) {
             std::shared_ptr<EffectStackModel> destStack = timeline->getClipEffectStackModel(newId);
-            destStack->fromXml(prod.firstChildElement(QStringLiteral("effects")), timeline_undo, timeline_redo);
+            destStack->fromProperties(clip.effects, clip.effectsParentIn, timeline_undo, timeline_redo);
         } else {
             qDebug()<<"=== COULD NOT PASTE CLIP: "<<newId<<" ON TRACK: "<<curTrackId<<" AT: "<<position;
             break;
@@ -1731,27 +1897,25 @@ bool TimelineFunctions::pasteTimelineClips(const std::shared_ptr<TimelineItemMod
     }
     // Compositions
     if (res) {
-        for (int i = 0; res && i < compositions.count(); i++) {
-            QDomElement prod = compositions.at(i).toElement();
-            QString originalId = prod.attribute(QStringLiteral("composition"));
-            int in = prod.attribute(QStringLiteral("in")).toInt();
-            int out = prod.attribute(QStringLiteral("out")).toInt();
-            int curTrackId = tracksMap.value(prod.attribute(QStringLiteral("track")).toInt());
-            int aTrackId = prod.attribute(QStringLiteral("a_track")).toInt();
+        for (const auto &compo : copiedItems->compositions) {
+            if (!res) {
+                break;
+            }
+            int curTrackId = tracksMap.value(compo.track);
+            int aTrackId = compo.aTrack;
             if (tracksMap.contains(aTrackId)) {
                 aTrackId = timeline->getTrackPosition(tracksMap.value(aTrackId));
             } else {
                 aTrackId = 0;
             }
-            int pos = prod.attribute(QStringLiteral("position")).toInt() - offset;
+            int pos = compo.position - offset;
             int newId;
+            // The clipboard can be pasted several times, give each composition its own copy
             auto transProps = std::make_unique<Mlt::Properties>();
-            QDomNodeList props = prod.elementsByTagName(QStringLiteral("property"));
-            for (int j = 0; j < props.count(); j++) {
-                transProps->set(props.at(j).toElement().attribute(QStringLiteral("name")).toUtf8().constData(),
-                            props.at(j).toElement().text().toUtf8().constData());
+            if (compo.properties) {
+                transProps->inherit(*compo.properties.get());
             }
-            res = res && timeline->requestCompositionInsertion(originalId, curTrackId, aTrackId, position + pos, out - in + 1, std::move(transProps), newId, timeline_undo, timeline_redo);
+            res = res && timeline->requestCompositionInsertion(compo.assetId, curTrackId, aTrackId, position + pos, compo.out - compo.in + 1, std::move(transProps), newId, timeline_undo, timeline_redo);
         }
     }
     if (!res) {
@@ -1761,8 +1925,15 @@ bool TimelineFunctions::pasteTimelineClips(const std::shared_ptr<TimelineItemMod
         semaphore.release(1);
         return false;
     }
+    Fun updateDuration = [timeline]() {
+        timeline->updateDuration();
+        return true;
+    };
+    updateDuration();
+    PUSH_LAMBDA(updateDuration, timeline_undo);
+    PUSH_LAMBDA(updateDuration, timeline_redo);
     // Rebuild groups
-    const QString groupsData = copiedItems.documentElement().firstChildElement(QStringLiteral("groups")).text();
+    const QString &groupsData = copiedItems->groups;
     if (!groupsData.isEmpty()) {
         timeline->m_groups->fromJsonWithOffset(groupsData, tracksMap, position - offset, timeline_undo, timeline_redo);
     }
@@ -2012,3 +2183,126 @@ QDomDocument TimelineFunctions::extractClip(const std::shared_ptr<TimelineItemMo
     return destDoc;
 }
 
+
+bool TimelineFunctions::isOpaqueClip(const std::shared_ptr<TimelineItemModel> &timeline, int clipId)
+{
+    std::shared_ptr<ClipModel> clip = timeline->getClipPtr(clipId);
+    if (clip->clipState() != PlaylistState::VideoOnly || clip->m_effectStack->hasEnabledVideoEffect()) {
+        return false;
+    }
+    int tid = clip->getCurrentTrackId();
+    if (tid == -1 || timeline->getTrackById_const(tid)->hasMix(clipId)) {
+        return false;
+    }
+    Mlt::Producer &source = clip->service()->parent().is_valid() ? clip->service()->parent() : *clip->service();
+    switch (clip->clipType()) {
+    case ClipType::Color:
+        return source.get_color("resource").a == 0xff;
+    case ClipType::AV:
+    case ClipType::Video: {
+        if (clip->clipStatus() != FileStatus::StatusReady && clip->clipStatus() != FileStatus::StatusProxy) {
+            return false;
+        }
+        // Rotated clips and clips with another aspect ratio are letterboxed with transparent borders
+        int videoIndex = source.get_int("video_index");
+        const QByteArray rotateProperty = QStringLiteral("meta.attr.%1.stream.rotate.markup").arg(videoIndex).toUtf8();
+        if (source.get_int("rotate") != 0 || source.get_int(rotateProperty.constData()) != 0) {
+            return false;
+        }
+        // Compare display aspect ratios, non square pixels are stretched to fill the frame
+        double sar = source.get_double("force_aspect_ratio");
+        if (sar <= 0.) {
+            int sarNum = source.get_int("meta.media.sample_aspect_num");
+            int sarDen = source.get_int("meta.media.sample_aspect_den");
+            sar = sarNum > 0 && sarDen > 0 ? double(sarNum) / sarDen : 1.;
+        }
+        QSize frameSize = clip->getFrameSize();
+        if (frameSize.isEmpty() || qAbs(frameSize.width() * sar / frameSize.height() - timeline->m_profile->dar()) > 0.01) {
+            return false;
+        }
+        // Pixel formats carrying an alpha channel or a palette: yuva420p, rgba, argb, bgra, gbrap, ya8, pal8...
+        const QString pixFmt = clip->getProperty(QStringLiteral("meta.media.%1.codec.pix_fmt").arg(videoIndex));
+        return !pixFmt.isEmpty() && !pixFmt.contains(QLatin1Char('a'));
+    }
+    default:
+        return false;
+    }
+}
+
+// Removes the frames of @param remove from @param ranges, both being sorted and not overlapping
+static std::vector<std::pair<int, int>> subtractRanges(const std::vector<std::pair<int, int>> &ranges, const std::vector<std::pair<int, int>> &remove)
+{
+    std::vector<std::pair<int, int>> result;
+    auto cut = remove.cbegin();
+    for (auto range : ranges) {
+        while (cut != remove.cend() && cut->second < range.first) {
+            ++cut;
+        }
+        for (auto it = cut; it != remove.cend() && it->first <= range.second; ++it) {
+            if (it->first > range.first) {
+                result.emplace_back(range.first, it->first - 1);
+            }
+            range.first = it->second + 1;
+        }
+        if (range.first <= range.second) {
+            result.push_back(range);
+        }
+    }
+    return result;
+}
+
+// Sorts @param ranges and merges the overlapping or adjacent ones
+static std::vector<std::pair<int, int>> mergeRanges(std::vector<std::pair<int, int>> ranges)
+{
+    std::sort(ranges.begin(), ranges.end());
+    std::vector<std::pair<int, int>> result;
+    for (const auto &range : ranges) {
+        if (!result.empty() && range.first <= result.back().second + 1) {
+            result.back().second = std::max(result.back().second, range.second);
+        } else {
+            result.push_back(range);
+        }
+    }
+    return result;
+}
+
+std::vector<std::pair<int, int>> TimelineFunctions::visibleRanges(const std::shared_ptr<TimelineItemModel> &timeline, int trackId, int in, int out,
+                                                                  bool visibilityChanged)
+{
+    if (in > out) {
+        std::swap(in, out);
+    }
+    if (!timeline->isTrack(trackId)) {
+        return {{in, out}};
+    }
+    std::shared_ptr<TrackModel> track = timeline->getTrackById(trackId);
+    // Timeline preview is rendered without audio
+    if (track->isAudioTrack() || (track->isHidden() && !visibilityChanged)) {
+        return {};
+    }
+    std::vector<std::pair<int, int>> covered;
+    std::vector<std::pair<int, int>> revealed;
+    auto it = timeline->m_iteratorTable.at(trackId);
+    for (++it; it != timeline->m_allTracks.end(); ++it) {
+        const std::shared_ptr<TrackModel> &upper = *it;
+        // A composition above the track may use it directly as its a_track, or blend the opaque clip with it
+        for (const auto &compo : upper->m_allCompositions) {
+            int position = compo.second->getPosition();
+            revealed.emplace_back(position, position + compo.second->getPlaytime() - 1);
+        }
+        if (upper->isAudioTrack() || upper->isHidden() || upper->m_effectStack->hasEnabledVideoEffect()) {
+            continue;
+        }
+        for (const auto &clip : upper->m_allClips) {
+            int position = clip.second->getPosition();
+            if (position > out || position + clip.second->getPlaytime() - 1 < in) {
+                continue;
+            }
+            if (isOpaqueClip(timeline, clip.first)) {
+                covered.emplace_back(position, position + clip.second->getPlaytime() - 1);
+            }
+        }
+    }
+    covered = subtractRanges(mergeRanges(covered), mergeRanges(revealed));
+    return subtractRanges({{in, out}}, covered);
+}
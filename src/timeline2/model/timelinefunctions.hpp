@@ -26,8 +26,14 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "undohelper.hpp"
 #include <memory>
 #include <unordered_set>
+#include <vector>
 
 #include <QDir>
+#include <QMap>
+
+namespace Mlt {
+class Properties;
+}
 
 /**
  * @namespace TimelineFunction
@@ -36,6 +42,58 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
 class TimelineItemModel;
+
+/**
+ * @brief Structured content of the timeline clipboard.
+ * copyClips() keeps the last copy in memory so that pasting it in the same session does not need
+ * to parse the XML again. The XML (@ref xml) is still produced for the system clipboard so that items
+ * can be pasted in another project or instance; pasteClips() converts it back to this structure.
+ */
+struct TimelineClipboard
+{
+    struct ClipData
+    {
+        int id{-1};
+        QString binId;
+        int in{0};
+        int out{0};
+        int position{0};
+        /** @brief Track position (not id) of the clip */
+        int track{-1};
+        bool audioTrack{false};
+        /** @brief Position of the video track mirroring this audio clip's track, -1 if the clip has no split partner */
+        int mirrorTrack{-1};
+        double speed{1.};
+        bool warpPitch{false};
+        int audioStream{0};
+        /** @brief In point of the clip when its effects were copied, used to offset keyframes */
+        int effectsParentIn{0};
+        std::vector<std::shared_ptr<Mlt::Properties>> effects;
+    };
+    struct CompositionData
+    {
+        QString assetId;
+        int in{0};
+        int out{0};
+        int position{0};
+        int track{-1};
+        int aTrack{0};
+        std::shared_ptr<Mlt::Properties> properties;
+    };
+    QString documentId;
+    int offset{0};
+    int masterTrack{-1};
+    int masterAudioTrack{0};
+    /** @brief Json representation of the copied groups */
+    QString groups;
+    /** @brief Hash of each bin clip used by the copied items, indexed by bin id */
+    QMap<QString, QString> binClips;
+    std::vector<ClipData> clips;
+    std::vector<CompositionData> compositions;
+    /** @brief The XML representation placed in the system clipboard */
+    QString xml;
+};
+
 struct TimelineFunctions
 {
     /* @brief Cuts a clip at given position
@@ -62,8 +120,11 @@ struct TimelineFunctions
     /* @brief Paste the clips as described by the string. Returns true on success*/
     static bool pasteClips(const std::shared_ptr<TimelineItemModel> &timeline, const QString &pasteString, int trackId, int position);
     static bool pasteClips(const std::shared_ptr<TimelineItemModel> &timeline, const QString &pasteString, int trackId, int position, Fun &undo, Fun &redo);
-    static bool pasteTimelineClips(const std::shared_ptr<TimelineItemModel> &timeline, QDomDocument copiedItems, int position);
-    static bool pasteTimelineClips(const std::shared_ptr<TimelineItemModel> &timeline, QDomDocument copiedItems, int position, Fun &timeline_undo, Fun &timeline_redo, bool pushToStack);
+    /* @brief Returns the structured content of a clipboard string produced by copyClips().
+       If it matches the last copy made in this session, the in-memory copy is returned without parsing. Returns nullptr on invalid data */
+    static std::shared_ptr<TimelineClipboard> readClipboard(const QString &pasteString);
+    static bool pasteTimelineClips(const std::shared_ptr<TimelineItemModel> &timeline, const std::shared_ptr<TimelineClipboard> &copiedItems, int position);
+    static bool pasteTimelineClips(const std::shared_ptr<TimelineItemModel> &timeline, const std::shared_ptr<TimelineClipboard> &copiedItems, int position, Fun &timeline_undo, Fun &timeline_redo, bool pushToStack);
 
     /* @brief Request the addition of multiple clips to the timeline
      * If the addition of any of the clips fails, the entire operation is undone.
@@ -135,6 +196,19 @@ struct TimelineFunctions
     /** @brief This function extracts the content of an xml playlist file and converts it to json paste format
      */
     static QDomDocument extractClip(const std::shared_ptr<TimelineItemModel> &timeline, int cid, const QString &binId);
+
+    /** @brief Returns true if the clip hides everything below it in the composited output: an enabled, full frame clip
+     *  without transparency, effects or same track mix. This errs on the side of false, it is only used to skip preview rendering
+     */
+    static bool isOpaqueClip(const std::shared_ptr<TimelineItemModel> &timeline, int clipId);
+    /** @brief Returns the parts of the frame range @param in - @param out where a change in the content of @param trackId
+     *  can be seen in the timeline preview, sorted and not overlapping.
+     *  Audio tracks and hidden tracks never show, and frames where an opaque clip covers the track on a visible upper track are
+     *  skipped, unless a composition above the track may reveal it.
+     *  @param visibilityChanged true when the track itself was hidden or shown, in which case its hidden state is ignored
+     */
+    static std::vector<std::pair<int, int>> visibleRanges(const std::shared_ptr<TimelineItemModel> &timeline, int trackId, int in, int out,
+                                                          bool visibilityChanged = false);
 };
 
 #endif
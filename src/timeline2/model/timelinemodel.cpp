@@ -634,7 +634,7 @@ bool TimelineModel::requestClipMove(int clipId, int trackId, int position, bool
             notifyChange(modelIndex, modelIndex, StartRole);
             if (invalidateTimeline && !getTrackById_const(trackId)->isAudioTrack()) {
                 int in = getClipPosition(clipId);
-                emit invalidateZone(in, in + getClipPlaytime(clipId));
+                emit invalidateZone(in, in + getClipPlaytime(clipId), trackId);
             }
             return true;
         };
@@ -965,7 +965,7 @@ bool TimelineModel::requestClipMix(std::pair<int, int> clipIds, int trackId, int
         QModelIndex modelIndex2 = makeClipIndexFromID(clipIds.first);
         notifyChange(modelIndex2, modelIndex2, {DurationRole});
         if (invalidateTimeline && !getTrackById_const(trackId)->isAudioTrack()) {
-            emit invalidateZone(position - mixDuration / 2, position + mixDuration);
+            emit invalidateZone(position - mixDuration / 2, position + mixDuration, trackId);
         }
         return true;
     };
@@ -2479,6 +2479,55 @@ bool TimelineModel::requestGroupMove(int itemId, int groupId, int delta_track, i
     return true;
 }
 
+bool TimelineModel::requestRippleShift(int position, int delta, Fun &undo, Fun &redo, QVector<int> allowedTracks)
+{
+    QWriteLocker locker(&m_lock);
+    if (delta == 0) {
+        return true;
+    }
+    if (allowedTracks.isEmpty()) {
+        if (m_subtitleModel && !m_subtitleModel->getItemsInRange(position, -1).empty()) {
+            // Subtitles are not handled here
+            return false;
+        }
+        for (const auto &track : m_allTracks) {
+            if (!track->isLocked()) {
+                allowedTracks << track->getId();
+            }
+        }
+    }
+    std::unordered_set<int> items;
+    for (int tid : allowedTracks) {
+        if (!isTrack(tid) || getTrackById_const(tid)->isLocked()) {
+            return false;
+        }
+        std::unordered_set<int> trackItems = getItemsInRange(tid, position, -1, true);
+        items.insert(trackItems.begin(), trackItems.end());
+    }
+    // Groups are moved as a whole, so we cannot proceed if some of their items are not shifted
+    for (int itemId : items) {
+        if (m_groups->isInGroup(itemId)) {
+            std::unordered_set<int> leaves = m_groups->getLeaves(m_groups->getRootId(itemId));
+            for (int leaf : leaves) {
+                if (items.count(leaf) == 0) {
+                    return false;
+                }
+            }
+        }
+    }
+    Fun local_undo = []() { return true; };
+    Fun local_redo = []() { return true; };
+    for (int tid : allowedTracks) {
+        if (!getTrackById(tid)->requestRippleShift(position, delta, true, true, local_undo, local_redo)) {
+            bool undone = local_undo();
+            Q_ASSERT(undone);
+            return false;
+        }
+    }
+    UPDATE_UNDO_REDO(local_redo, local_undo, undo, redo);
+    return true;
+}
+
 bool TimelineModel::requestGroupDeletion(int clipId, bool logUndo)
 {
     QWriteLocker locker(&m_lock);
@@ -5104,11 +5153,11 @@ void TimelineModel::switchComposition(int cid, const QString &compoId)
         int tid = getClipTrackId(cid);
         MixInfo mixData = getTrackById_const(tid)->getMixInfo(cid).first;
         getTrackById(tid)->switchMix(cid, compoId, undo, redo);
-        Fun local_update = [cid, mixData, this]() {
+        Fun local_update = [cid, tid, mixData, this]() {
             requestMixSelection(cid);
             int in = mixData.secondClipInOut.first;
             int out = mixData.firstClipInOut.second;
-            emit invalidateZone(in, out);
+            emit invalidateZone(in, out, tid);
             checkRefresh(in, out);
             return true;
         };
@@ -476,6 +476,19 @@ public:
     bool requestGroupMove(int itemId, int groupId, int delta_track, int delta_pos, bool updateView, bool finalMove, Fun &undo, Fun &redo, bool moveMirrorTracks = true, 
                           bool allowViewRefresh = true, QVector<int> allowedTracks = QVector<int>());
 
+    /* @brief Shift all items ending after the given position by delta frames, on several tracks at once
+       Each track is shifted in one step by resizing the blank before its shifted items, which is much faster than moving
+       the items as a group on long timelines.
+       Returns true on success. If it fails, nothing is modified and the caller should fallback to a group move. This happens
+       if there is not enough space before the shifted items, or if the shift would split a group or a same track transition.
+       Subtitles are never shifted.
+       @param position items ending after this position are shifted
+       @param delta is the requested position change, negative to remove space
+       @param allowedTracks the tracks to shift. If empty, all unlocked tracks are affected, and the shift fails if there are
+       subtitles after position since they would not follow
+    */
+    bool requestRippleShift(int position, int delta, Fun &undo, Fun &redo, QVector<int> allowedTracks = QVector<int>());
+
     /* @brief Deletes all clips inside the group that contains the given clip.
        This action is undoable
        Note that if their is a hierarchy of groups, all of them will be deleted.
@@ -822,8 +835,9 @@ signals:
     /* @brief signal triggered by clearAssetView */
     void requestClearAssetView(int);
     void requestMonitorRefresh();
-    /* @brief signal triggered by track operations */
-    void invalidateZone(int in, int out);
+    /* @brief signal triggered by track operations
+       @param trackId the track whose clips changed, -1 if the change is not limited to the content of one track (compositions) */
+    void invalidateZone(int in, int out, int trackId = -1);
     /* @brief signal triggered when a track duration changed (insertion/deletion) */
     void durationUpdated();
 
@@ -24,6 +24,7 @@
 #include "core.h"
 #include "compositionmodel.hpp"
 #include "effects/effectstack/model/effectstackmodel.hpp"
+#include "kdenlive_debug.h"
 #include "transitions/transitionsrepository.hpp"
 #include "kdenlivesettings.h"
 #include "logger.hpp"
@@ -194,7 +195,7 @@ Fun TrackModel::requestClipInsertion_lambda(int clipId, int position, bool updat
                     ptr->checkRefresh(new_in, new_out);
                 }
                 if (!audioOnly && finalMove && !isAudioTrack()) {
-                    emit ptr->invalidateZone(new_in, new_out);
+                    emit ptr->invalidateZone(new_in, new_out, m_id);
                 }
             }
             return true;
@@ -346,7 +347,7 @@ void TrackModel::replugClip(int clipId)
         std::shared_ptr<ClipModel> clip = ptr->getClipPtr(clipId);
         m_playlists[target_track].insert_at(clip_position, *clip, 1);
         if (!clip->isAudioOnly() && !isAudioTrack()) {
-            emit ptr->invalidateZone(clip->getIn(), clip->getOut());
+            emit ptr->invalidateZone(clip->getIn(), clip->getOut(), m_id);
         }
         if (!clip->isAudioOnly() && !isHidden() && !isAudioTrack()) {
             // only refresh monitor if not an audio track and not hidden
@@ -400,7 +401,7 @@ Fun TrackModel::requestClipDeletion_lambda(int clipId, bool updateView, bool fin
                 ptr->m_snaps->removePoint(old_out);
                 if (finalMove) {
                     if (!audioOnly && !isAudioTrack()) {
-                        emit ptr->invalidateZone(old_in, old_out);
+                        emit ptr->invalidateZone(old_in, old_out, m_id);
                     }
                     if (!groupMove && target_clip >= m_playlists[target_track].count()) {
                         // deleted last clip in playlist
@@ -443,6 +444,202 @@ bool TrackModel::requestClipDeletion(int clipId, bool updateView, bool finalMove
     return false;
 }
 
+bool TrackModel::requestRippleShift(int position, int delta, bool updateView, bool finalMove, Fun &undo, Fun &redo)
+{
+    QWriteLocker locker(&m_lock);
+    if (isLocked()) {
+        return false;
+    }
+    if (delta == 0) {
+        return true;
+    }
+    // Split items between the shifted ones (ending after position) and the others
+    std::vector<int> clipIds;
+    std::unordered_set<int> shifted;
+    int firstStart = INT_MAX;
+    int lastEnd = 0;
+    for (const auto &clip : m_allClips) {
+        int pos = clip.second->getPosition();
+        int length = clip.second->getPlaytime();
+        if (pos + length - 1 >= position) {
+            clipIds.push_back(clip.first);
+            shifted.insert(clip.first);
+            firstStart = std::min(firstStart, pos);
+        } else {
+            lastEnd = std::max(lastEnd, pos + length);
+        }
+    }
+    // A same track transition cannot be split
+    for (auto it = m_mixList.cbegin(); it != m_mixList.cend(); ++it) {
+        if ((shifted.count(it.key()) > 0) != (shifted.count(it.value()) > 0)) {
+            qCDebug(KDENLIVE_LOG) << "Ripple shift would break mix between clips" << it.key() << it.value();
+            return false;
+        }
+    }
+    if (!clipIds.empty() && firstStart + delta < lastEnd) {
+        // Not enough blank space before the shifted clips
+        return false;
+    }
+    std::vector<int> compoIds;
+    firstStart = INT_MAX;
+    lastEnd = 0;
+    for (const auto &compo : m_allCompositions) {
+        int pos = compo.second->getPosition();
+        int length = compo.second->getPlaytime();
+        if (pos + length - 1 >= position) {
+            compoIds.push_back(compo.first);
+            firstStart = std::min(firstStart, pos);
+        } else {
+            lastEnd = std::max(lastEnd, pos + length);
+        }
+    }
+    if (!compoIds.empty() && firstStart + delta < lastEnd) {
+        return false;
+    }
+    if (clipIds.empty() && compoIds.empty()) {
+        return true;
+    }
+    int duration = trackDuration();
+    auto operation = requestRippleShift_lambda(clipIds, compoIds, delta, updateView, finalMove);
+    if (operation()) {
+        if (finalMove && duration != trackDuration()) {
+            // The shift changed the track duration, update track effects
+            m_effectStack->adjustStackLength(true, 0, duration, 0, trackDuration(), 0, undo, redo, true);
+        }
+        auto reverse = requestRippleShift_lambda(clipIds, compoIds, -delta, updateView, finalMove);
+        UPDATE_UNDO_REDO(operation, reverse, undo, redo);
+        return true;
+    }
+    return false;
+}
+
+Fun TrackModel::requestRippleShift_lambda(const std::vector<int> &clipIds, const std::vector<int> &compoIds, int delta, bool updateView, bool finalMove)
+{
+    return [clipIds, compoIds, delta, updateView, finalMove, this]() {
+        if (isLocked()) return false;
+        auto ptr = m_parent.lock();
+        if (!ptr) {
+            qCDebug(KDENLIVE_LOG) << "Error : Ripple shift failed because timeline is not available anymore";
+            return false;
+        }
+        // In each playlist, the shifted clips are the last ones, so we only have to adjust the blank before the first one
+        int firstPos[2] = {-1, -1};
+        int rangeStart = INT_MAX;
+        int rangeEnd = 0;
+        for (int cid : clipIds) {
+            int pos = m_allClips[cid]->getPosition();
+            int pl = m_allClips[cid]->getSubPlaylistIndex();
+            if (firstPos[pl] == -1 || pos < firstPos[pl]) {
+                firstPos[pl] = pos;
+            }
+            rangeStart = std::min(rangeStart, pos);
+            rangeEnd = std::max(rangeEnd, pos + m_allClips[cid]->getPlaytime());
+        }
+        // Check both playlists before modifying any of them, so that a failure leaves the track untouched
+        int blankIndex[2] = {-1, -1};
+        for (int pl = 0; pl < 2; ++pl) {
+            if (firstPos[pl] == -1) {
+                continue;
+            }
+            int index = m_playlists[pl].get_clip_index_at(firstPos[pl]);
+            bool valid = false;
+            if (index > 0 && m_playlists[pl].is_blank(index - 1)) {
+                valid = m_playlists[pl].clip_length(index - 1) + delta >= 0;
+            } else {
+                valid = delta > 0;
+            }
+            if (!valid) {
+                // requestRippleShift checked the available space, this should not happen
+                qCDebug(KDENLIVE_LOG) << "Error : Ripple shift failed on playlist" << pl << "of track" << m_id;
+                Q_ASSERT(false);
+                return false;
+            }
+            blankIndex[pl] = index;
+        }
+        for (int pl = 0; pl < 2; ++pl) {
+            if (blankIndex[pl] == -1) {
+                continue;
+            }
+            int index = blankIndex[pl];
+            m_playlists[pl].lock();
+            if (index > 0 && m_playlists[pl].is_blank(index - 1)) {
+                int blankLength = m_playlists[pl].clip_length(index - 1) + delta;
+                if (blankLength == 0) {
+                    m_playlists[pl].remove(index - 1);
+                } else {
+                    m_playlists[pl].resize_clip(index - 1, 0, blankLength - 1);
+                }
+            } else {
+                m_playlists[pl].insert_blank(index, delta - 1);
+            }
+            m_playlists[pl].unlock();
+        }
+        // Book-keeping
+        std::unordered_set<int> shifted(clipIds.begin(), clipIds.end());
+        int minRow = INT_MAX;
+        int maxRow = -1;
+        for (int cid : clipIds) {
+            std::shared_ptr<ClipModel> clip = m_allClips[cid];
+            int old_in = clip->getPosition();
+            int old_out = old_in + clip->getPlaytime();
+            ptr->m_snaps->removePoint(old_in);
+            ptr->m_snaps->removePoint(old_out);
+            clip->setPosition(old_in + delta);
+            ptr->m_snaps->addPoint(old_in + delta);
+            ptr->m_snaps->addPoint(old_out + delta);
+            int row = getRowfromClip(cid);
+            minRow = std::min(minRow, row);
+            maxRow = std::max(maxRow, row);
+        }
+        for (const auto &mix : m_sameCompositions) {
+            if (shifted.count(mix.first) > 0) {
+                Mlt::Transition *t = static_cast<Mlt::Transition *>(mix.second->getAsset());
+                t->set_in_and_out(t->get_in() + delta, t->get_out() + delta);
+            }
+        }
+        // Compositions are keyed by position, so remove them all before storing new positions
+        for (int compoId : compoIds) {
+            m_compoPos.erase(m_allCompositions[compoId]->getPosition());
+        }
+        for (int compoId : compoIds) {
+            std::shared_ptr<CompositionModel> composition = m_allCompositions[compoId];
+            int old_in = composition->getPosition();
+            int old_out = old_in + composition->getPlaytime();
+            ptr->m_snaps->removePoint(old_in);
+            ptr->m_snaps->removePoint(old_out);
+            composition->setInOut(old_in + delta, old_out + delta - 1);
+            ptr->m_snaps->addPoint(old_in + delta);
+            ptr->m_snaps->addPoint(old_out + delta);
+            m_compoPos[old_in + delta] = compoId;
+            rangeStart = std::min(rangeStart, old_in);
+            rangeEnd = std::max(rangeEnd, old_out);
+            int row = getRowfromComposition(compoId);
+            minRow = std::min(minRow, row);
+            maxRow = std::max(maxRow, row);
+        }
+        if (updateView && maxRow > -1) {
+            // A single notification for all the shifted rows
+            QModelIndex trackIndex = ptr->makeTrackIndexFromID(m_id);
+            ptr->notifyChange(ptr->index(minRow, 0, trackIndex), ptr->index(maxRow, 0, trackIndex), TimelineModel::StartRole);
+        }
+        int zoneIn = std::min(rangeStart, rangeStart + delta);
+        int zoneOut = std::max(rangeEnd, rangeEnd + delta);
+        if (finalMove) {
+            ptr->updateDuration();
+        }
+        if (!isAudioTrack()) {
+            if (finalMove) {
+                // Moved compositions also change the tracks below
+                emit ptr->invalidateZone(zoneIn, zoneOut, compoIds.empty() ? m_id : -1);
+            }
+            if (!isHidden()) {
+                ptr->checkRefresh(zoneIn, zoneOut);
+            }
+        }
+        return true;
+    };
+}
+
 int TrackModel::getBlankSizeAtPos(int frame)
 {
     READ_LOCK();
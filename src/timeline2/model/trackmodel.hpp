@@ -207,6 +207,23 @@ protected:
     /* @brief This function returns a lambda that performs the requested operation */
     Fun requestCompositionInsertion_lambda(int compoId, int position, bool updateView, bool finalMove = false);
 
+    /* @brief Shifts all the items ending after the given position by delta frames, in one step.
+       Instead of removing and inserting each clip, the blank preceding the shifted clips is resized in each playlist, and
+       positions, snaps, same track transitions and compositions are then updated in bulk. Undoing replays the same bulk
+       shift with the opposite delta instead of moving each item back.
+       Returns true if the operation succeeded, and otherwise, the track is not modified.
+       This method is protected because it shouldn't be called directly. Call the function in the timeline instead.
+       @param position items ending after this position (as returned by getClipsInRange) are shifted
+       @param delta the shift in frames, negative to remove space. There must be enough blank space before the shifted items
+       @param updateView whether we send update to the view
+       @param finalMove if the move is finished (not while dragging), so we invalidate timeline preview / check project duration
+       @param undo Lambda function containing the current undo stack. Will be updated with current operation
+       @param redo Lambda function containing the current redo queue. Will be updated with current operation
+    */
+    bool requestRippleShift(int position, int delta, bool updateView, bool finalMove, Fun &undo, Fun &redo);
+    /* @brief This function returns a lambda that shifts the given clips and compositions */
+    Fun requestRippleShift_lambda(const std::vector<int> &clipIds, const std::vector<int> &compoIds, int delta, bool updateView, bool finalMove);
+
     bool requestCompositionDeletion(int compoId, bool updateView, bool finalMove, Fun &undo, Fun &redo, bool finalDeletion);
     Fun requestCompositionDeletion_lambda(int compoId, bool updateView, bool finalMove = false);
     Fun requestCompositionResize_lambda(int compoId, int in, int out = -1, bool logUndo = false);
@@ -27,6 +27,7 @@
 #include "timeline2/view/timelinecontroller.h"
 
 #include <KLocalizedString>
+#include <QElapsedTimer>
 #include <QProcess>
 #include <QStandardPaths>
 #include <QCollator>
@@ -39,11 +40,15 @@ PreviewManager::PreviewManager(TimelineController *controller, Mlt::Tractor *tra
     , m_previewTrack(nullptr)
     , m_overlayTrack(nullptr)
     , m_previewTrackIndex(-1)
+    , m_jobRunning(false)
     , m_initialized(false)
 {
     m_previewGatherTimer.setSingleShot(true);
     m_previewGatherTimer.setInterval(200);
     QObject::connect(&m_previewProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this, &PreviewManager::processEnded);
+    // The daemon reports on stderr, stdout would fill up since nobody reads it
+    m_previewProcess.setReadChannel(QProcess::StandardError);
+    m_previewProcess.setStandardOutputFile(QProcess::nullDevice());
 
 
     // Find path for Kdenlive renderer
@@ -58,7 +63,11 @@ PreviewManager::PreviewManager(TimelineController *controller, Mlt::Tractor *tra
             m_renderer = QStringLiteral("kdenlive_render");
         }
     }
-    connect(this, &PreviewManager::abortPreview, &m_previewProcess, &QProcess::kill, Qt::DirectConnection);
+    connect(this, &PreviewManager::abortPreview, this, [this]() {
+        if (m_jobRunning) {
+            m_previewProcess.write("abort\n");
+        }
+    }, Qt::DirectConnection);
     connect(&m_previewProcess, &QProcess::readyReadStandardError, this, &PreviewManager::receivedStderr);
 }
 
@@ -76,6 +85,7 @@ PreviewManager::~PreviewManager()
             }
         }
     }
+    stopDaemon();
     delete m_overlayTrack;
     delete m_previewTrack;
 }
@@ -468,12 +478,12 @@ void PreviewManager::addPreviewRange(const QPoint zone, bool add)
     if (add) {
         qDebug() << "CHUNKS CHANGED: " << m_dirtyChunks;
         emit m_controller->dirtyChunksChanged();
-        if (m_previewProcess.state() == QProcess::NotRunning && KdenliveSettings::autopreview()) {
+        if (!m_jobRunning && KdenliveSettings::autopreview()) {
             m_previewTimer.start();
         }
     } else {
         // Remove processed chunks
-        bool isRendering = m_previewProcess.state() != QProcess::NotRunning;
+        bool isRendering = m_jobRunning;
         m_previewGatherTimer.stop();
         abortRendering();
         m_tractor->lock();
@@ -503,13 +513,18 @@ void PreviewManager::addPreviewRange(const QPoint zone, bool add)
 
 void PreviewManager::abortRendering()
 {
-    if (m_previewProcess.state() == QProcess::NotRunning) {
+    if (!m_jobRunning) {
         return;
     }
     qDebug() << "/// ABORTING RENDEIGN 1\nRRRRRRRRRR";
     emit abortPreview();
-    m_previewProcess.waitForFinished();
-    if (m_previewProcess.state() != QProcess::NotRunning) {
+    // The daemon checks for aborts while encoding, wait for it to acknowledge
+    QElapsedTimer timer;
+    timer.start();
+    while (m_jobRunning && m_previewProcess.state() == QProcess::Running && timer.elapsed() < 5000) {
+        m_previewProcess.waitForReadyRead(100);
+    }
+    if (m_jobRunning) {
         m_previewProcess.kill();
         m_previewProcess.waitForFinished();
     }
@@ -539,8 +554,9 @@ void PreviewManager::startPreviewRender()
 
 void PreviewManager::receivedStderr()
 {
-    QStringList resultList = QString::fromLocal8Bit(m_previewProcess.readAllStandardError()).split(QLatin1Char('\n'));
-    for (auto &result : resultList) {
+    // The daemon stays alive, so a line may arrive in several reads
+    while (m_previewProcess.canReadLine()) {
+        const QString result = QString::fromLocal8Bit(m_previewProcess.readLine()).trimmed();
         qDebug() << "GOT PROCESS RESULT: " << result;
         if (result.startsWith(QLatin1String("START:"))) {
             workingPreview = result.section(QLatin1String("START:"), 1).simplified().toInt();
@@ -553,7 +569,13 @@ void PreviewManager::receivedStderr()
             qDebug() << "---------------\nJOB PROGRRESS: " << m_chunksToRender << ", " << m_processedChunks << " = "
                      << (100 * m_processedChunks / m_chunksToRender);
             emit previewRender(chunk, m_cacheDir.absoluteFilePath(fileName), 1000 * m_processedChunks / m_chunksToRender);
-        } else {
+        } else if (result == QLatin1String("FINISHED") || result == QLatin1String("ABORTED")) {
+            jobEnded(result == QLatin1String("ABORTED"));
+        } else if (result == QLatin1String("FAILED")) {
+            // The daemon could not encode a chunk, show its log
+            jobEnded(true);
+            emit previewRender(0, m_errorLog, -1);
+        } else if (result != QLatin1String("READY")) {
             m_errorLog.append(result);
         }
     }
@@ -566,7 +588,7 @@ void PreviewManager::doPreviewRender(const QString &scene)
     if (m_dirtyChunks.isEmpty()) {
         return;
     }
-    Q_ASSERT(m_previewProcess.state() == QProcess::NotRunning);
+    Q_ASSERT(!m_jobRunning);
 
     QStringList chunks;
     for (QVariant &frame : m_dirtyChunks) {
@@ -575,26 +597,68 @@ void PreviewManager::doPreviewRender(const QString &scene)
     m_chunksToRender = m_dirtyChunks.count();
     m_processedChunks = 0;
     int chunkSize = KdenliveSettings::timelinechunks();
-    QStringList args{KdenliveSettings::rendererpath(),
-                     scene,
-                     m_cacheDir.absolutePath(),
-                     QStringLiteral("-split"),
-                     chunks.join(QLatin1Char(',')),
-                     QString::number(chunkSize - 1),
-                     pCore->getCurrentProfilePath(),
-                     m_extension,
-                     m_consumerParams.join(QLatin1Char(' '))};
-    qDebug() << " -  - -STARTING PREVIEW JOBS: " << args;
+    if (!startDaemon()) {
+        pCore->displayMessage(i18n("Cannot start the timeline preview renderer %1", m_renderer), ErrorMessage);
+        return;
+    }
+    QStringList request{QStringLiteral("render"), scene, m_cacheDir.absolutePath(), QString::number(chunkSize), chunks.join(QLatin1Char(','))};
+    qDebug() << " -  - -STARTING PREVIEW JOBS: " << request;
     pCore->currentDoc()->previewProgress(0);
+    m_jobRunning = true;
+    m_previewProcess.write(request.join(QLatin1Char('\t')).toUtf8() + '\n');
+}
+
+bool PreviewManager::startDaemon()
+{
+    const QStringList args{QStringLiteral("-daemon"), pCore->getCurrentProfilePath(), m_extension, m_consumerParams.join(QLatin1Char(' '))};
+    const QString params = args.join(QLatin1Char('\n'));
+    if (m_previewProcess.state() == QProcess::Running && params == m_daemonParams) {
+        return true;
+    }
+    // Profile or encoding parameters changed, they are fixed for the daemon lifetime
+    stopDaemon();
     m_previewProcess.start(m_renderer, args);
-    if (m_previewProcess.waitForStarted()) {
-        qDebug() << " -  - -STARTING PREVIEW JOBS . . . STARTED";
+    if (!m_previewProcess.waitForStarted()) {
+        return false;
+    }
+    m_daemonParams = params;
+    return true;
+}
+
+void PreviewManager::stopDaemon()
+{
+    m_daemonParams.clear();
+    if (m_previewProcess.state() == QProcess::NotRunning) {
+        return;
+    }
+    m_previewProcess.write("quit\n");
+    m_previewProcess.closeWriteChannel();
+    if (!m_previewProcess.waitForFinished(2000)) {
+        m_previewProcess.kill();
+        m_previewProcess.waitForFinished();
     }
 }
 
+void PreviewManager::jobEnded(bool aborted)
+{
+    m_jobRunning = false;
+    const QString sceneList = m_cacheDir.absoluteFilePath(QStringLiteral("preview.mlt"));
+    QFile::remove(sceneList);
+    // The daemon already removed the partially rendered chunk
+    pCore->currentDoc()->previewProgress(aborted ? -1 : 1000);
+    workingPreview = -1;
+    emit m_controller->workingPreviewChanged();
+}
+
 void PreviewManager::processEnded(int, QProcess::ExitStatus status)
 {
     qDebug() << "// PROCESS IS FINISHED!!!";
+    m_daemonParams.clear();
+    if (!m_jobRunning) {
+        // The daemon was idle, it is restarted on the next render
+        return;
+    }
+    m_jobRunning = false;
     const QString sceneList = m_cacheDir.absoluteFilePath(QStringLiteral("preview.mlt"));
     QFile::remove(sceneList);
     if (status == QProcess::QProcess::CrashExit) {
@@ -750,8 +814,8 @@ void PreviewManager::gotPreviewRender(int frame, const QString &file, int progre
 
 void PreviewManager::corruptedChunk(int frame, const QString &fileName)
 {
+    // Called while parsing the daemon output, its ABORTED answer is handled later
     emit abortPreview();
-    m_previewProcess.waitForFinished();
     if (workingPreview >= 0) {
         workingPreview = -1;
         emit m_controller->workingPreviewChanged();
@@ -100,8 +100,12 @@ private:
     int m_previewTrackIndex;
     /** @brief: The kdenlive renderer app. */
     QString m_renderer;
-    /** @brief: The kdenlive timeline preview process. */
+    /** @brief: The kdenlive_render daemon, kept running between preview renders. */
     QProcess m_previewProcess;
+    /** @brief: Profile and encoding parameters the running daemon was started with. */
+    QString m_daemonParams;
+    /** @brief: True while the daemon processes our render request. */
+    bool m_jobRunning;
     /** @brief: The directory used to store the preview files. */
     QDir m_cacheDir;
     /** @brief: The directory used to store undo history of preview files (child of m_cacheDir). */
@@ -130,6 +134,12 @@ private:
     void enable();
     /** @brief: Temporarily disable timeline preview track. */
     void disable();
+    /** @brief: Start the render daemon if it is not running or was started with other parameters. */
+    bool startDaemon();
+    /** @brief: Ask the render daemon to quit, killing it if it does not answer. */
+    void stopDaemon();
+    /** @brief: The daemon reported the end of the render request. */
+    void jobEnded(bool aborted);
 
 private slots:
     /** @brief: To avoid filling the hard drive, remove preview undo history after 5 steps. */
@@ -140,7 +150,7 @@ private slots:
     void slotRemoveInvalidUndo(int ix);
     /** @brief: When the timer collecting invalid zones is done, process. */
     void slotProcessDirtyChunks();
-    /** @brief: Process preview rendering output. */
+    /** @brief: Process the daemon output, rendering progress and end of requests. */
     void receivedStderr();
     void processEnded(int, QProcess::ExitStatus status);
 
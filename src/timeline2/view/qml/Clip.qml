@@ -222,7 +222,6 @@ Rectangle {
     }
 */
     property bool noThumbs: (isAudio || itemType == ProducerType.Color || mltService === '')
-    property string baseThumbPath: noThumbs ? '' : 'image://thumbnail/' + binId + '/' + documentId + '/#'
 
     DropArea { //Drop area for clips
         anchors.fill: clipRoot
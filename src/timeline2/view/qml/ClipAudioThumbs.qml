@@ -1,61 +1,48 @@
 import QtQuick 2.11
-import QtQuick.Controls 2.4
 import Kdenlive.Controls 1.0
-import QtQml.Models 2.11
 import com.enums 1.0
 
-Row {
+Item {
     id: waveform
     opacity: clipState == ClipState.Disabled ? 0.2 : 1
-    property int maxWidth: 500 + 100 * timeline.scaleFactor
     anchors.fill: parent
 
-    Timer {
-        id: waveTimer
-        interval: 50; running: false; repeat: false
-        onTriggered: processReload()
-    }
-
     function reload(reset) {
+        // A duration change resizes the item, which already rebuilds the vertices
         if (reset == 0) {
-            waveformRepeater.model = 0
+            levels.reload()
         }
-        waveTimer.start()
-    }
-    onMaxWidthChanged: {
-        waveTimer.start();
     }
 
-    function processReload() {
-        // This is needed to make the model have the correct count.
-        // Model as a property expression is not working in all cases.
-        if (!waveform.visible || !timeline.showAudioThumbnails) {
-            return;
-        }
-        var chunks = Math.ceil(waveform.width / waveform.maxWidth)
-        if (waveformRepeater.model == undefined || chunks != waveformRepeater.model) {
-            waveformRepeater.model = chunks
-        }
+    // Levels are drawn by the scene graph, vertices are only rebuilt on zoom, trim or when scrolling far enough
+    TimelineAudioWaveform {
+        id: levels
+        anchors.fill: parent
+        visible: timeline.showAudioThumbnails
+        channels: clipRoot.audioChannels
+        binId: clipRoot.binId
+        audioStream: clipRoot.audioStream
+        inPoint: clipRoot.inPoint
+        maxDuration: clipRoot.maxDuration
+        speed: clipRoot.speed
+        timeScale: clipRoot.timeScale
+        format: timeline.audioThumbFormat
+        normalize: timeline.audioThumbNormalize
+        scrollStart: clipRoot.scrollStart
+        viewWidth: scrollView.width
+        fillColor1: root.thumbColor1
+        fillColor2: root.thumbColor2
     }
 
     Repeater {
-        id: waveformRepeater
-        TimelineWaveform {
-            width: Math.min(waveform.width, waveform.maxWidth)
-            height: waveform.height
-            channels: clipRoot.audioChannels
-            binId: clipRoot.binId
-            audioStream: clipRoot.audioStream
-            isFirstChunk: index == 0
-            showItem: waveform.visible && (index * waveform.maxWidth < (clipRoot.scrollStart + scrollView.width)) && ((index * waveform.maxWidth + width) > clipRoot.scrollStart)
-            format: timeline.audioThumbFormat
-            normalize: timeline.audioThumbNormalize
-            drawInPoint: Math.max(0, clipRoot.scrollStart - (index * waveform.maxWidth))
-            drawOutPoint: (clipRoot.scrollStart + scrollView.width - (index * waveform.maxWidth))
-            waveInPoint: clipRoot.speed < 0 ? (Math.round((clipRoot.maxDuration - 1 - clipRoot.inPoint) * Math.abs(clipRoot.speed)  - (index * waveform.maxWidth / clipRoot.timeScale) * Math.abs(clipRoot.speed)) * channels) : (Math.round((clipRoot.inPoint + (index * waveform.maxWidth / clipRoot.timeScale)) * clipRoot.speed) * channels)
-            waveOutPoint: clipRoot.speed < 0 ? (waveInPoint - Math.ceil(width / clipRoot.timeScale * Math.abs(clipRoot.speed)) * channels) : (waveInPoint + Math.round(width / clipRoot.timeScale * clipRoot.speed) * channels)
-            fillColor1: root.thumbColor1
-            fillColor2: root.thumbColor2
+        // Channel names
+        model: timeline.audioThumbFormat && clipRoot.audioChannels > 1 && clipRoot.audioChannels < 7 ? clipRoot.audioChannels : 0
+        Text {
+            x: 2
+            y: (index + 1) * waveform.height / clipRoot.audioChannels - height
+            text: ["L", "R", "C", "LFE", "BL", "BR"][index]
+            color: index % 2 == 0 ? root.thumbColor1 : root.thumbColor2
+            font.pointSize: root.fontUnit
         }
     }
 }
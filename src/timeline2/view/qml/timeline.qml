@@ -344,6 +344,9 @@ Rectangle {
         if (root.autoScrolling) Logic.scrollIfNeeded()
     }
 
+    onScrollMinChanged: timeline.setVisibleRange(scrollMin, scrollMax)
+    onScrollMaxChanged: timeline.setVisibleRange(scrollMin, scrollMax)
+
     onViewActiveTrackChanged: {
         var tk = Logic.getTrackById(timeline.activeTrack)
         if (tk.y + subtitleTrack.height < scrollView.contentY) {
@@ -23,12 +23,23 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "kdenlivesettings.h"
 #include "core.h"
 #include "bin/projectitemmodel.h"
+#include "timeline2/view/thumbnailprefetcher.h"
+#include "utils/thumbnailcache.hpp"
 #include <QPainter>
 #include <QPainterPath>
+#include <QPointer>
 #include <QQuickPaintedItem>
+#include <QQuickWindow>
+#include <QSGFlatColorMaterial>
+#include <QSGGeometryNode>
+#include <QSGImageNode>
+#include <QSGSimpleRectNode>
 #include <QElapsedTimer>
 #include <QtMath>
 #include <cmath>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
 #include "kdenlivesettings.h"
 
 const QStringList chanelNames{"L", "R", "C", "LFE", "BL", "BR"};
@@ -297,11 +308,516 @@ private:
     bool m_firstChunk;
 };
 
+/* @brief Audio levels of a clip stream, with each channel reduced by successive factors of 2
+ * so that the peak of any range of frames is found by reading a few values.
+ */
+struct WaveformPyramid
+{
+    int channels = 1;
+    // For each channel, level 0 holds one value per frame, level k the max of 2^k frames
+    std::vector<std::vector<std::vector<uint8_t>>> levels;
+
+    WaveformPyramid(const QVector<uint8_t> &audioLevels, int channelCount)
+        : channels(qMax(1, channelCount))
+    {
+        int frames = audioLevels.size() / channels;
+        levels.resize(size_t(channels));
+        for (int c = 0; c < channels; ++c) {
+            std::vector<uint8_t> base(size_t(frames));
+            for (int i = 0; i < frames; ++i) {
+                base[size_t(i)] = audioLevels.at(i * channels + c);
+            }
+            levels[size_t(c)].push_back(std::move(base));
+            while (levels[size_t(c)].back().size() > 1) {
+                const std::vector<uint8_t> &prev = levels[size_t(c)].back();
+                std::vector<uint8_t> next((prev.size() + 1) / 2);
+                for (size_t i = 0; i < next.size(); ++i) {
+                    next[i] = 2 * i + 1 < prev.size() ? qMax(prev[2 * i], prev[2 * i + 1]) : prev[2 * i];
+                }
+                levels[size_t(c)].push_back(std::move(next));
+            }
+        }
+    }
+    int frameCount() const { return levels.empty() || levels.front().empty() ? 0 : int(levels.front().front().size()); }
+    /* @brief Returns the peak level of a channel between two source frames (first included, last excluded) */
+    uint8_t peak(int channel, double first, double last) const
+    {
+        const auto &pyramid = levels[size_t(channel)];
+        int start = qMax(0, int(first));
+        int end = qMin(frameCount(), qMax(start + 1, int(std::ceil(last))));
+        if (start >= end) {
+            return 0;
+        }
+        // Pick the coarsest level where the range still spans a couple of values
+        int level = 0;
+        while (level + 1 < int(pyramid.size()) && (2 << level) <= end - start) {
+            level++;
+        }
+        const std::vector<uint8_t> &values = pyramid[size_t(level)];
+        size_t i = size_t(start >> level);
+        size_t last_i = qMin(values.size(), size_t(((end - 1) >> level) + 1));
+        uint8_t result = 0;
+        for (; i < last_i; ++i) {
+            result = qMax(result, values[i]);
+        }
+        return result;
+    }
+};
+
+class TimelineAudioWaveform : public QQuickItem
+{
+    Q_OBJECT
+    Q_PROPERTY(QColor fillColor1 MEMBER m_color NOTIFY propertyChanged)
+    Q_PROPERTY(QColor fillColor2 MEMBER m_color2 NOTIFY propertyChanged)
+    Q_PROPERTY(QString binId MEMBER m_binId NOTIFY levelsChanged)
+    Q_PROPERTY(int audioStream MEMBER m_stream NOTIFY levelsChanged)
+    Q_PROPERTY(int channels MEMBER m_channels NOTIFY levelsChanged)
+    Q_PROPERTY(int inPoint MEMBER m_inPoint NOTIFY propertyChanged)
+    Q_PROPERTY(int maxDuration MEMBER m_maxDuration NOTIFY propertyChanged)
+    Q_PROPERTY(double speed MEMBER m_speed NOTIFY propertyChanged)
+    Q_PROPERTY(double timeScale MEMBER m_timeScale NOTIFY propertyChanged)
+    Q_PROPERTY(bool format MEMBER m_format NOTIFY propertyChanged)
+    Q_PROPERTY(bool normalize MEMBER m_normalize NOTIFY propertyChanged)
+    // Visible part of the clip, in pixels from the clip start
+    Q_PROPERTY(double scrollStart MEMBER m_scrollStart NOTIFY scrollChanged)
+    Q_PROPERTY(double viewWidth MEMBER m_viewWidth NOTIFY scrollChanged)
+
+public:
+    TimelineAudioWaveform()
+    {
+        setFlag(QQuickItem::ItemHasContents, true);
+        connect(this, &TimelineAudioWaveform::levelsChanged, this, &TimelineAudioWaveform::reload);
+        connect(this, &TimelineAudioWaveform::propertyChanged, this, &TimelineAudioWaveform::invalidate);
+        connect(this, &TimelineAudioWaveform::scrollChanged, this, [this]() {
+            // The vertices cover a few pages around the view, only rebuild when scrolling past them
+            if (m_scrollStart < m_builtStart || m_scrollStart + m_viewWidth > m_builtEnd) {
+                invalidate();
+            }
+        });
+    }
+    /** @brief Fetch the audio levels again, for example when they were just computed */
+    Q_INVOKABLE void reload()
+    {
+        if (!isComponentComplete()) {
+            // Wait for all properties to be set
+            return;
+        }
+        const QString key = QStringLiteral("%1:%2:%3").arg(m_binId).arg(m_stream).arg(m_channels);
+        // Another clip may still hold outdated levels, don't share them anymore
+        pyramids().erase(key);
+        m_pyramid.reset();
+        if (!m_binId.isEmpty() && m_stream >= 0) {
+            QVector<uint8_t> audioLevels = pCore->projectItemModel()->getAudioLevelsByBinID(m_binId, m_stream);
+            if (!audioLevels.isEmpty()) {
+                m_pyramid = std::make_shared<const WaveformPyramid>(audioLevels, m_channels);
+                pyramids()[key] = m_pyramid;
+            }
+        }
+        invalidate();
+    }
+
+protected:
+    void componentComplete() override
+    {
+        QQuickItem::componentComplete();
+        const QString key = QStringLiteral("%1:%2:%3").arg(m_binId).arg(m_stream).arg(m_channels);
+        auto it = pyramids().find(key);
+        if (it != pyramids().end()) {
+            m_pyramid = it->second.lock();
+        }
+        if (!m_pyramid) {
+            reload();
+        }
+    }
+    void geometryChanged(const QRectF &newGeometry, const QRectF &oldGeometry) override
+    {
+        QQuickItem::geometryChanged(newGeometry, oldGeometry);
+        if (newGeometry.size() != oldGeometry.size()) {
+            invalidate();
+        }
+    }
+
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *) override
+    {
+        if (!m_dirty && oldNode) {
+            return oldNode;
+        }
+        m_dirty = false;
+        delete oldNode;
+        auto *root = new QSGNode;
+        if (!m_pyramid || m_pyramid->frameCount() == 0 || m_timeScale <= 0 || width() < 1 || height() < 1) {
+            m_builtStart = 0;
+            m_builtEnd = width();
+            return root;
+        }
+        double scaleFactor = m_audioMax > 1 ? 255 * m_audioMax : 255;
+        // Build one page on each side of the view
+        m_builtStart = qMax(0., m_scrollStart - m_viewWidth);
+        m_builtEnd = qMin(width(), m_scrollStart + 2 * m_viewWidth);
+        int firstColumn = int(m_builtStart);
+        int lastColumn = int(std::ceil(m_builtEnd));
+        if (lastColumn <= firstColumn) {
+            return root;
+        }
+        double absSpeed = qAbs(m_speed);
+        // Source frame range covered by a pixel column
+        auto columnRange = [&](int x, double &first, double &last) {
+            double start = x / m_timeScale;
+            double end = (x + 1) / m_timeScale;
+            if (m_speed >= 0) {
+                first = (m_inPoint + start) * absSpeed;
+                last = (m_inPoint + end) * absSpeed;
+            } else {
+                first = (m_maxDuration - 1 - m_inPoint - end) * absSpeed;
+                last = (m_maxDuration - 1 - m_inPoint - start) * absSpeed;
+            }
+        };
+        int channels = m_pyramid->channels;
+        int columns = lastColumn - firstColumn;
+        if (!m_format) {
+            // All channels merged, drawn from the bottom
+            QSGGeometryNode *node = createStrip(columns, m_color);
+            QSGGeometry::Point2D *v = node->geometry()->vertexDataAsPoint2D();
+            double h = height();
+            for (int i = 0; i < columns; ++i) {
+                int x = firstColumn + i;
+                double first, last;
+                columnRange(x, first, last);
+                uint8_t level = 0;
+                for (int c = 0; c < channels; ++c) {
+                    level = qMax(level, m_pyramid->peak(c, first, last));
+                }
+                float top = float(h - qMin(1., level / scaleFactor) * h);
+                v[2 * i].set(float(x), float(h));
+                v[2 * i + 1].set(float(x), top);
+            }
+            root->appendChildNode(node);
+            return root;
+        }
+        double channelHeight = height() / channels;
+        for (int c = 0; c < channels; ++c) {
+            double y = c * channelHeight + channelHeight / 2;
+            QColor color = c % 2 == 0 ? m_color : m_color2;
+            if (c % 2 == 0) {
+                // Dark background on odd channels
+                root->appendChildNode(new QSGSimpleRectNode(QRectF(0, c * channelHeight, width(), channelHeight), QColor(0, 0, 0, 51)));
+            }
+            QColor median = color;
+            median.setAlphaF(0.5);
+            root->appendChildNode(new QSGSimpleRectNode(QRectF(0, y, width(), 1), median));
+            QSGGeometryNode *node = createStrip(columns, color);
+            QSGGeometry::Point2D *v = node->geometry()->vertexDataAsPoint2D();
+            for (int i = 0; i < columns; ++i) {
+                int x = firstColumn + i;
+                double first, last;
+                columnRange(x, first, last);
+                double level = qMin(1., m_pyramid->peak(c, first, last) / scaleFactor) * channelHeight / 2;
+                v[2 * i].set(float(x), float(y - level));
+                v[2 * i + 1].set(float(x), float(y + level));
+            }
+            root->appendChildNode(node);
+        }
+        return root;
+    }
+
+signals:
+    void levelsChanged();
+    void propertyChanged();
+    void scrollChanged();
+
+private:
+    QString m_binId;
+    int m_stream = -1;
+    int m_channels = 1;
+    int m_inPoint = 0;
+    int m_maxDuration = 0;
+    double m_speed = 1.;
+    double m_timeScale = 1.;
+    bool m_format = false;
+    bool m_normalize = false;
+    double m_scrollStart = 0.;
+    double m_viewWidth = 0.;
+    QColor m_color;
+    QColor m_color2;
+    std::shared_ptr<const WaveformPyramid> m_pyramid;
+    bool m_dirty = true;
+    /** @brief The horizontal range covered by the current vertices, written during the scene graph sync */
+    double m_builtStart = 0.;
+    double m_builtEnd = 0.;
+
+    double m_audioMax = 0.;
+
+    void invalidate()
+    {
+        m_audioMax = m_normalize || m_binId.isEmpty() ? 0 : pCore->projectItemModel()->getAudioMaxLevel(m_binId);
+        m_dirty = true;
+        update();
+    }
+    /** @brief Levels are shared by all timeline instances of a clip stream */
+    static std::unordered_map<QString, std::weak_ptr<const WaveformPyramid>> &pyramids()
+    {
+        static std::unordered_map<QString, std::weak_ptr<const WaveformPyramid>> cache;
+        return cache;
+    }
+    static QSGGeometryNode *createStrip(int columns, const QColor &color)
+    {
+        auto *geometry = new QSGGeometry(QSGGeometry::defaultAttributes_Point2D(), 2 * columns);
+        geometry->setDrawingMode(QSGGeometry::DrawTriangleStrip);
+        auto *material = new QSGFlatColorMaterial;
+        material->setColor(color);
+        auto *node = new QSGGeometryNode;
+        node->setGeometry(geometry);
+        node->setFlag(QSGNode::OwnsGeometry);
+        node->setMaterial(material);
+        node->setFlag(QSGNode::OwnsMaterial);
+        return node;
+    }
+};
+
+class TimelineThumbnails : public QQuickItem
+{
+    Q_OBJECT
+    Q_PROPERTY(QString binId MEMBER m_binId NOTIFY clipChanged)
+    Q_PROPERTY(QObject *prefetcher READ prefetcher WRITE setPrefetcher NOTIFY clipChanged)
+    Q_PROPERTY(int inPoint MEMBER m_inPoint NOTIFY propertyChanged)
+    Q_PROPERTY(int outPoint MEMBER m_outPoint NOTIFY propertyChanged)
+    Q_PROPERTY(int maxDuration MEMBER m_maxDuration NOTIFY propertyChanged)
+    Q_PROPERTY(double speed MEMBER m_speed NOTIFY propertyChanged)
+    Q_PROPERTY(double scaleFactor MEMBER m_scaleFactor NOTIFY propertyChanged)
+    Q_PROPERTY(double thumbWidth MEMBER m_thumbWidth NOTIFY propertyChanged)
+    // 0 = in/out thumbs, 1 = all frames, 2 = in frame, 3 = none
+    Q_PROPERTY(int format MEMBER m_format NOTIFY propertyChanged)
+    Q_PROPERTY(bool fixedThumbs MEMBER m_fixedThumbs NOTIFY propertyChanged)
+    Q_PROPERTY(int keyframeSpacing MEMBER m_keyframeSpacing NOTIFY propertyChanged)
+    // Visible part of the clip, in pixels from the clip start
+    Q_PROPERTY(double scrollStart MEMBER m_scrollStart NOTIFY propertyChanged)
+    Q_PROPERTY(double viewWidth MEMBER m_viewWidth NOTIFY propertyChanged)
+
+public:
+    TimelineThumbnails()
+    {
+        setFlag(QQuickItem::ItemHasContents, true);
+        connect(this, &TimelineThumbnails::propertyChanged, this, &QQuickItem::update);
+        connect(this, &TimelineThumbnails::clipChanged, this, &TimelineThumbnails::reloadThumbs);
+    }
+    QObject *prefetcher() const { return m_prefetcher.data(); }
+    void setPrefetcher(QObject *prefetcher)
+    {
+        if (m_prefetcher) {
+            disconnect(m_prefetcher.data(), nullptr, this, nullptr);
+        }
+        m_prefetcher = qobject_cast<ThumbnailPrefetcher *>(prefetcher);
+        if (m_prefetcher) {
+            // Thumbnails are decoded in worker threads, these connections are queued
+            connect(m_prefetcher.data(), &ThumbnailPrefetcher::thumbnailsReady, this, &TimelineThumbnails::thumbnailReady);
+            connect(m_prefetcher.data(), &ThumbnailPrefetcher::requestsCanceled, this, &TimelineThumbnails::requestsCanceled);
+        }
+        emit clipChanged();
+    }
+    /** @brief Drop the displayed thumbnails, for example after the clip was reloaded */
+    Q_INVOKABLE void reloadThumbs()
+    {
+        if (m_prefetcher && !m_binId.isEmpty()) {
+            m_prefetcher->clearKeyframeThumbnails(m_binId);
+        }
+        m_requested.clear();
+        m_reset = true;
+        update();
+    }
+
+protected:
+    void geometryChanged(const QRectF &newGeometry, const QRectF &oldGeometry) override
+    {
+        QQuickItem::geometryChanged(newGeometry, oldGeometry);
+        update();
+    }
+
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *) override
+    {
+        QSGNode *root = oldNode;
+        if (root == nullptr) {
+            // The scene graph deleted our nodes
+            root = new QSGNode;
+            m_slots.clear();
+            m_extraNodes.clear();
+        }
+        // Placeholders and separators are cheap, recreate them
+        for (QSGNode *node : m_extraNodes) {
+            root->removeChildNode(node);
+            delete node;
+        }
+        m_extraNodes.clear();
+        std::unordered_map<int, Slot> previous;
+        previous.swap(m_slots);
+        for (auto &s : previous) {
+            root->removeChildNode(s.second.node);
+        }
+        if (m_reset) {
+            for (auto &s : previous) {
+                delete s.second.node;
+            }
+            previous.clear();
+            m_reset = false;
+        }
+        m_missing.clear();
+        int count = m_thumbWidth < 1 ? 0 : m_format == 0 ? 2 : m_format == 1 ? qCeil(width() / m_thumbWidth) : m_format == 2 ? 1 : 0;
+        if (m_binId.isEmpty() || count == 0 || height() < 1) {
+            count = 0;
+        }
+        double imageWidth = count > 0 ? qMax(m_thumbWidth, width() / count) : 0;
+        bool keyframes = count > 2 && m_keyframeSpacing > 0 && m_thumbWidth / m_scaleFactor * qAbs(m_speed) >= m_keyframeSpacing;
+        for (int i = 0; i < count; ++i) {
+            double x = i * imageWidth;
+            int frame = 0;
+            bool alignRight = false;
+            if (count < 3) {
+                alignRight = i == 1;
+                if (!m_fixedThumbs) {
+                    frame = ThumbnailPrefetcher::sourceFrame(m_inPoint, i == 0 ? 0 : m_outPoint - m_inPoint, m_speed, m_maxDuration);
+                }
+            } else {
+                if (x < m_scrollStart - imageWidth || x > m_scrollStart + m_viewWidth) {
+                    // Not visible
+                    continue;
+                }
+                if (!m_fixedThumbs) {
+                    frame = ThumbnailPrefetcher::sourceFrame(m_inPoint, qRound(x / m_scaleFactor), m_speed, m_maxDuration);
+                }
+            }
+            QRectF box(x, 0, imageWidth, height());
+            auto existing = previous.find(i);
+            Slot slot;
+            if (existing != previous.end()) {
+                slot = existing->second;
+                previous.erase(existing);
+            }
+            if (slot.node == nullptr || slot.frame != frame) {
+                QImage img = thumbnail(frame, keyframes);
+                if (!img.isNull()) {
+                    delete slot.node;
+                    slot.node = window()->createImageNode();
+                    // Small textures end up in the scene graph's shared atlas, so all strips are drawn in a few batches
+                    slot.node->setTexture(window()->createTextureFromImage(img, QQuickWindow::TextureCanUseAtlas));
+                    slot.node->setOwnsTexture(true);
+                    slot.node->setFiltering(QSGTexture::Linear);
+                    slot.frame = frame;
+                } else {
+                    // Keep showing the previous image of this slot until the new one is ready
+                    m_missing.push_back(frame);
+                }
+            }
+            if (slot.node) {
+                QSizeF size = slot.node->texture()->textureSize();
+                size.scale(box.size(), Qt::KeepAspectRatio);
+                double left = alignRight ? box.right() - size.width() : box.left();
+                slot.node->setRect(QRectF(left, box.top() + (box.height() - size.height()) / 2, size.width(), size.height()));
+                root->appendChildNode(slot.node);
+                m_slots[i] = slot;
+            } else {
+                auto *placeholder = new QSGSimpleRectNode(QRectF(box.left(), box.top(), qMin(m_thumbWidth, box.width()), box.height()), QColor(0, 0, 0, 60));
+                root->appendChildNode(placeholder);
+                m_extraNodes.push_back(placeholder);
+            }
+            if (count < 3) {
+                // Separate the in / out thumbnails from the rest of the clip
+                double sepX = alignRight ? box.right() - m_thumbWidth - 1 : box.left() + m_thumbWidth;
+                auto *separator = new QSGSimpleRectNode(QRectF(sepX, 0, 1, height()), QColor(255, 255, 255, 77));
+                root->appendChildNode(separator);
+                m_extraNodes.push_back(separator);
+            }
+        }
+        for (auto &s : previous) {
+            delete s.second.node;
+        }
+        if (!m_missing.empty()) {
+            m_missingKeyframes = keyframes;
+            QMetaObject::invokeMethod(this, "requestMissing", Qt::QueuedConnection);
+        }
+        return root;
+    }
+
+signals:
+    void clipChanged();
+    void propertyChanged();
+
+private slots:
+    void thumbnailReady(const QString &binId)
+    {
+        if (binId == m_binId) {
+            update();
+        }
+    }
+    void requestsCanceled()
+    {
+        if (!m_requested.empty()) {
+            // Our pending frames may have been dropped
+            m_requested.clear();
+            update();
+        }
+    }
+    void requestMissing()
+    {
+        if (!m_prefetcher || m_binId.isEmpty()) {
+            return;
+        }
+        std::vector<int> frames;
+        for (int frame : m_missing) {
+            if (m_requested.insert(frame).second) {
+                frames.push_back(frame);
+            }
+        }
+        if (!frames.empty()) {
+            m_prefetcher->requestFrames(m_binId, frames, m_missingKeyframes);
+        }
+    }
+
+private:
+    struct Slot
+    {
+        QSGImageNode *node = nullptr;
+        int frame = -1;
+    };
+    QString m_binId;
+    QPointer<ThumbnailPrefetcher> m_prefetcher;
+    int m_inPoint = 0;
+    int m_outPoint = 0;
+    int m_maxDuration = 0;
+    double m_speed = 1.;
+    double m_scaleFactor = 1.;
+    double m_thumbWidth = 0.;
+    int m_format = 0;
+    bool m_fixedThumbs = false;
+    int m_keyframeSpacing = 0;
+    double m_scrollStart = 0.;
+    double m_viewWidth = 0.;
+    bool m_reset = false;
+    /** @brief The thumbnail nodes currently displayed, by position in the strip. Only accessed during the scene graph sync */
+    std::unordered_map<int, Slot> m_slots;
+    std::vector<QSGNode *> m_extraNodes;
+    /** @brief Frames that were not in the cache during the last sync */
+    std::vector<int> m_missing;
+    bool m_missingKeyframes = false;
+    /** @brief Frames already passed to the prefetcher */
+    std::unordered_set<int> m_requested;
+
+    /** @brief Returns a cached thumbnail, never decodes nor reads the disk since this runs during the scene graph sync */
+    QImage thumbnail(int frame, bool keyframes) const
+    {
+        QImage img = ThumbnailCache::get()->getThumbnail(m_binId, frame, true);
+        if (img.isNull() && keyframes && m_prefetcher) {
+            img = m_prefetcher->keyframeThumbnail(m_binId, frame);
+        }
+        return img;
+    }
+};
+
 void registerTimelineItems()
 {
     qmlRegisterType<TimelineTriangle>("Kdenlive.Controls", 1, 0, "TimelineTriangle");
     qmlRegisterType<TimelinePlayhead>("Kdenlive.Controls", 1, 0, "TimelinePlayhead");
     qmlRegisterType<TimelineWaveform>("Kdenlive.Controls", 1, 0, "TimelineWaveform");
+    qmlRegisterType<TimelineThumbnails>("Kdenlive.Controls", 1, 0, "TimelineThumbnails");
+    qmlRegisterType<TimelineAudioWaveform>("Kdenlive.Controls", 1, 0, "TimelineAudioWaveform");
 }
 
 #include "timelineitems.moc"
@@ -53,7 +53,9 @@ QImage ThumbnailProvider::requestImage(const QString &id, QSize *size, const QSi
         if (binClip) {
             std::shared_ptr<Mlt::Producer> prod = binClip->thumbProducer();
             if (prod && prod->is_valid()) {
+                QMutexLocker seekLock(binClip->thumbSeekMutex());
                 result = makeThumbnail(prod, frameNumber, requestedSize);
+                seekLock.unlock();
                 ThumbnailCache::get()->storeThumbnail(binId, frameNumber, result, false);
             }
         }
@@ -88,9 +90,12 @@ QImage ThumbnailProvider::makeThumbnail(const std::shared_ptr<Mlt::Producer> &pr
     if (frame == nullptr || !frame->is_valid()) {
         return QImage();
     }
+    frame->set("deinterlace_method", "onefield");
+    frame->set("top_field_first", -1);
+    frame->set("rescale.interp", "nearest");
     // TODO: cache these values ?
     int imageHeight = pCore->thumbProfile()->height();
     int imageWidth = pCore->thumbProfile()->width();
     int fullWidth = imageHeight * pCore->getCurrentDar() + 0.5;
-    return KThumb::getFrame(frame.data(), imageWidth, imageHeight, fullWidth);
+    return KThumb::getThumbnail(frame.data(), imageWidth, imageHeight, fullWidth);
 }
@@ -32,9 +32,10 @@ public:
     explicit ThumbnailProvider();
     ~ThumbnailProvider() override;
     QImage requestImage(const QString &id, QSize *size, const QSize &requestedSize) override;
+    /** @brief Decode a timeline thumbnail for a clip's thumb producer, also used by the prefetcher */
+    static QImage makeThumbnail(const std::shared_ptr<Mlt::Producer> &producer, int frameNumber, const QSize &requestedSize);
 
 private:
-    QImage makeThumbnail(const std::shared_ptr<Mlt::Producer> &producer, int frameNumber, const QSize &requestedSize);
     QString cacheKey(Mlt::Properties &properties, const QString &service, const QString &resource, const QString &hash, int frameNumber);
 };
 
@@ -0,0 +1,182 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by agent <agent@local>                             *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "thumbnailprefetcher.h"
+#include "bin/projectclip.h"
+#include "bin/projectitemmodel.h"
+#include "core.h"
+#include "timeline2/view/qmltypes/thumbnailprovider.h"
+#include "utils/thumbnailcache.hpp"
+
+#include <QThread>
+#include <QtMath>
+#include <QtConcurrent>
+#include <algorithm>
+#include <climits>
+
+ThumbnailPrefetcher::ThumbnailPrefetcher(QObject *parent)
+    : QObject(parent)
+    , m_generation(0)
+    , m_keyframeCache(20000)
+{
+    // Leave enough cores for playback and the job manager
+    m_pool.setMaxThreadCount(qBound(1, QThread::idealThreadCount() / 2, 4));
+}
+
+ThumbnailPrefetcher::~ThumbnailPrefetcher()
+{
+    cancel();
+    m_pool.waitForDone();
+}
+
+void ThumbnailPrefetcher::cancel()
+{
+    m_generation++;
+    m_pool.clear();
+    emit requestsCanceled();
+}
+
+void ThumbnailPrefetcher::setRequests(std::unordered_map<QString, std::set<int>> requests, const std::unordered_map<QString, int> &priorities)
+{
+    cancel();
+    int generation = m_generation;
+    std::vector<QString> clips;
+    clips.reserve(requests.size());
+    for (const auto &r : requests) {
+        if (!r.second.empty()) {
+            clips.push_back(r.first);
+        }
+    }
+    // Start with the clips closest to the playhead, the pool processes batches in submission order
+    std::sort(clips.begin(), clips.end(), [&priorities](const QString &a, const QString &b) {
+        auto pa = priorities.find(a);
+        auto pb = priorities.find(b);
+        int va = pa == priorities.end() ? INT_MAX : pa->second;
+        int vb = pb == priorities.end() ? INT_MAX : pb->second;
+        return va < vb;
+    });
+    for (const QString &binId : clips) {
+        const std::set<int> &frames = requests.at(binId);
+        std::vector<int> batch;
+        batch.reserve(frames.size());
+        for (int f : frames) {
+            // Skip frames we already have, std::set keeps the remaining ones sorted
+            if (!ThumbnailCache::get()->hasThumbnail(binId, f, true)) {
+                batch.push_back(f);
+            }
+        }
+        if (!batch.empty()) {
+            QtConcurrent::run(&m_pool, this, &ThumbnailPrefetcher::processBatch, binId, batch, generation, false);
+        }
+    }
+}
+
+void ThumbnailPrefetcher::requestFrames(const QString &binId, const std::vector<int> &frames, bool keyframes)
+{
+    std::vector<int> batch = frames;
+    std::sort(batch.begin(), batch.end());
+    batch.erase(std::unique(batch.begin(), batch.end()), batch.end());
+    if (!batch.empty()) {
+        QtConcurrent::run(&m_pool, this, &ThumbnailPrefetcher::processBatch, binId, batch, int(m_generation), keyframes);
+    }
+}
+
+QImage ThumbnailPrefetcher::keyframeThumbnail(const QString &binId, int frame)
+{
+    QMutexLocker lk(&m_keyframeMutex);
+    QImage *cached = m_keyframeCache.object(QStringLiteral("%1/%2").arg(binId).arg(frame));
+    return cached ? *cached : QImage();
+}
+
+void ThumbnailPrefetcher::clearKeyframeThumbnails(const QString &binId)
+{
+    QMutexLocker lk(&m_keyframeMutex);
+    const QString prefix = binId + QLatin1Char('/');
+    const QList<QString> keys = m_keyframeCache.keys();
+    for (const QString &key : keys) {
+        if (key.startsWith(prefix)) {
+            m_keyframeCache.remove(key);
+        }
+    }
+}
+
+int ThumbnailPrefetcher::sourceFrame(int in, int offset, double speed, int maxDuration)
+{
+    if (speed >= 0) {
+        return qFloor((in + offset) * speed);
+    }
+    // Reversed clips play from the end of the source
+    return qMax(0, qRound((maxDuration - in - offset) * -speed - 1));
+}
+
+void ThumbnailPrefetcher::processBatch(const QString &binId, const std::vector<int> &frames, int generation, bool keyframes)
+{
+    if (generation != m_generation) {
+        return;
+    }
+    std::shared_ptr<ProjectClip> binClip = pCore->projectItemModel()->getClipByBinID(binId);
+    if (!binClip) {
+        return;
+    }
+    std::shared_ptr<Mlt::Producer> prod = keyframes ? binClip->keyframeThumbProducer() : binClip->thumbProducer();
+    if (!prod || !prod->is_valid()) {
+        return;
+    }
+    for (int frame : frames) {
+        if (generation != m_generation) {
+            // Viewport changed, the new request set will resubmit what is still visible
+            return;
+        }
+        if (ThumbnailCache::get()->hasThumbnail(binId, frame, true)) {
+            continue;
+        }
+        if (keyframes) {
+            const QString key = QStringLiteral("%1/%2").arg(binId).arg(frame);
+            {
+                QMutexLocker kl(&m_keyframeMutex);
+                if (m_keyframeCache.contains(key)) {
+                    continue;
+                }
+            }
+            QMutexLocker seekLock(binClip->thumbSeekMutex());
+            QImage result = ThumbnailProvider::makeThumbnail(prod, frame, QSize());
+            seekLock.unlock();
+            if (!result.isNull()) {
+                QMutexLocker kl(&m_keyframeMutex);
+                m_keyframeCache.insert(key, new QImage(result), qMax(1, int(result.sizeInBytes() / 1024)));
+                kl.unlock();
+                emit thumbnailsReady(binId);
+            }
+            continue;
+        }
+        // Thumbnails saved with the project only need to be read back into memory
+        QImage result = ThumbnailCache::get()->getThumbnail(binId, frame);
+        if (result.isNull()) {
+            // The producer is shared with the thumbnail provider and jobs, only hold it for one frame
+            QMutexLocker seekLock(binClip->thumbSeekMutex());
+            result = ThumbnailProvider::makeThumbnail(prod, frame, QSize());
+        }
+        if (!result.isNull()) {
+            ThumbnailCache::get()->storeThumbnail(binId, frame, result, false);
+            emit thumbnailsReady(binId);
+        }
+    }
+}
@@ -0,0 +1,92 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by agent <agent@local>                             *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef THUMBNAILPREFETCHER_H
+#define THUMBNAILPREFETCHER_H
+
+#include "definitions.h"
+
+#include <QCache>
+#include <QImage>
+#include <QMutex>
+#include <QObject>
+#include <QThreadPool>
+#include <atomic>
+#include <memory>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class ThumbnailPrefetcher
+ * @brief Fills the volatile thumbnail cache ahead of the timeline view.
+ * The timeline controller computes the source frames needed to display the visible
+ * range at the current zoom level and hands them over grouped by bin clip. Each bin
+ * clip is then decoded by a single worker in ascending frame order so that the thumb
+ * producer seeks forward instead of jumping around. Work that scrolled out of view is
+ * dropped as soon as a new request set arrives.
+ */
+
+class ThumbnailPrefetcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ThumbnailPrefetcher(QObject *parent = nullptr);
+    ~ThumbnailPrefetcher() override;
+    /** @brief Replace all pending requests with a new set.
+     *  @param requests the source frames to decode for each bin clip
+     *  @param priorities the distance (in frames) between each bin clip and the playhead, closest clips are decoded first
+     */
+    void setRequests(std::unordered_map<QString, std::set<int>> requests, const std::unordered_map<QString, int> &priorities);
+    /** @brief Decode some frames of a clip for a timeline item, without dropping the pending requests.
+     *  @param keyframes if true, the nearest keyframe of each frame is decoded and stored apart, see keyframeThumbnail()
+     */
+    void requestFrames(const QString &binId, const std::vector<int> &frames, bool keyframes);
+    /** @brief Returns a keyframe aligned thumbnail decoded by requestFrames(), or a null image */
+    QImage keyframeThumbnail(const QString &binId, int frame);
+    /** @brief Forget the keyframe aligned thumbnails of a reloaded clip */
+    void clearKeyframeThumbnails(const QString &binId);
+    /** @brief Drop all queued work and ask running workers to stop. */
+    void cancel();
+    /** @brief Returns the source frame displayed at a timeline offset (in frames) from the in point of a clip, handling speed and reverse */
+    static int sourceFrame(int in, int offset, double speed, int maxDuration);
+
+signals:
+    /** @brief A thumbnail of this clip was stored, emitted from a worker thread */
+    void thumbnailsReady(const QString &binId);
+    /** @brief Pending work was dropped, timeline items should request their missing thumbnails again */
+    void requestsCanceled();
+
+private:
+    /** @brief The bounded pool running our decode batches, separate from the global pool used by jobs */
+    QThreadPool m_pool;
+    /** @brief Incremented on each new request set, workers stop when it does not match theirs anymore */
+    std::atomic<int> m_generation;
+
+    /** @brief Keyframe aligned thumbnails don't match the requested frame, so they are kept apart from the ThumbnailCache */
+    QCache<QString, QImage> m_keyframeCache;
+    QMutex m_keyframeMutex;
+
+    void processBatch(const QString &binId, const std::vector<int> &frames, int generation, bool keyframes);
+};
+
+#endif
@@ -41,6 +41,7 @@
 #include "monitor/monitormanager.h"
 #include "previewmanager.h"
 #include "project/projectmanager.h"
+#include "thumbnailprefetcher.h"
 #include "timeline2/model/clipmodel.hpp"
 #include "timeline2/model/compositionmodel.hpp"
 #include "timeline2/model/groupsmodel.hpp"
@@ -59,6 +60,7 @@
 #include <QApplication>
 #include <QClipboard>
 #include <QQuickItem>
+#include <QtMath>
 #include <memory>
 #include <unistd.h>
 
@@ -75,7 +77,13 @@ TimelineController::TimelineController(QObject *parent)
     , m_timelinePreview(nullptr)
     , m_ready(false)
     , m_snapStackIndex(-1)
+    , m_thumbPrefetcher(new ThumbnailPrefetcher(this))
+    , m_visibleRange(-1, -1)
 {
+    // Scrolling and zooming trigger many range updates, only prefetch once the view settles
+    m_prefetchTimer.setSingleShot(true);
+    m_prefetchTimer.setInterval(150);
+    connect(&m_prefetchTimer, &QTimer::timeout, this, &TimelineController::prefetchThumbnails);
     m_disablePreview = pCore->currentDoc()->getAction(QStringLiteral("disable_preview"));
     connect(m_disablePreview, &QAction::triggered, this, &TimelineController::disablePreview);
     connect(this, &TimelineController::selectionChanged, this, &TimelineController::updateClipActions);
@@ -98,6 +106,8 @@ void TimelineController::prepareClose()
     QObject::disconnect( m_deleteConnection );
     m_ready = false;
     m_root = nullptr;
+    m_prefetchTimer.stop();
+    m_thumbPrefetcher->cancel();
     // Delete timeline preview before resetting model so that removing clips from timeline doesn't invalidate
     delete m_timelinePreview;
     m_timelinePreview = nullptr;
@@ -108,6 +118,8 @@ void TimelineController::setModel(std::shared_ptr<TimelineItemModel> model)
     delete m_timelinePreview;
     m_zone = QPoint(-1, -1);
     m_timelinePreview = nullptr;
+    m_thumbPrefetcher->cancel();
+    m_visibleRange = QPoint(-1, -1);
     m_model = std::move(model);
     m_activeSnaps.clear();
     connect(m_model.get(), &TimelineItemModel::requestClearAssetView, pCore.get(), &Core::clearAssetPanel);
@@ -600,6 +612,17 @@ bool TimelineController::showThumbnails() const
     return KdenliveSettings::videothumbnails();
 }
 
+int TimelineController::keyframeThumbSpacing() const
+{
+    // Long GOP footage usually has a keyframe every few seconds
+    return KdenliveSettings::keyframethumbnails() ? qRound(pCore->getCurrentFps() * 5) : 0;
+}
+
+QObject *TimelineController::thumbnailPrefetcher() const
+{
+    return m_thumbPrefetcher;
+}
+
 bool TimelineController::showAudioThumbnails() const
 {
     return KdenliveSettings::audiothumbnails();
@@ -1767,6 +1790,17 @@ void TimelineController::startPreviewRender()
     }
 }
 
+void TimelineController::renderPreviewZone(const QPoint &zone)
+{
+    if (!m_timelinePreview) {
+        initializePreview();
+    }
+    if (m_timelinePreview) {
+        m_timelinePreview->addPreviewRange(zone, true);
+        startPreviewRender();
+    }
+}
+
 void TimelineController::stopPreviewRender()
 {
     if (m_timelinePreview) {
@@ -1997,25 +2031,47 @@ void TimelineController::invalidateItem(int cid)
     }
     int start = m_model->getItemPosition(cid);
     int end = start + m_model->getItemPlaytime(cid);
-    m_timelinePreview->invalidatePreview(start, end);
+    if (m_model->isComposition(cid)) {
+        // A composition changes the blending of the tracks below it, always invalidate its whole range
+        m_timelinePreview->invalidatePreview(start, end);
+        return;
+    }
+    invalidateTrackZone(tid, start, end, false);
 }
 
-void TimelineController::invalidateTrack(int tid)
+void TimelineController::invalidateTrack(int tid, bool visibilityChanged)
 {
     if (!m_timelinePreview || !m_model->isTrack(tid) || m_model->getTrackById_const(tid)->isAudioTrack()) {
         return;
     }
     for (const auto &clp : m_model->getTrackById_const(tid)->m_allClips) {
-        invalidateItem(clp.first);
+        int start = clp.second->getPosition();
+        invalidateTrackZone(tid, start, start + clp.second->getPlaytime(), visibilityChanged);
     }
 }
 
-void TimelineController::invalidateZone(int in, int out)
+void TimelineController::invalidateZone(int in, int out, int trackId)
 {
     if (!m_timelinePreview) {
         return;
     }
-    m_timelinePreview->invalidatePreview(in, out == -1 ? m_duration : out);
+    if (out == -1) {
+        out = m_duration;
+    }
+    if (trackId == -1) {
+        m_timelinePreview->invalidatePreview(in, out);
+        return;
+    }
+    invalidateTrackZone(trackId, in, out, false);
+}
+
+void TimelineController::invalidateTrackZone(int tid, int in, int out, bool visibilityChanged)
+{
+    // Changes on hidden tracks or below opaque clips don't need a new render
+    const auto ranges = TimelineFunctions::visibleRanges(m_model, tid, in, out, visibilityChanged);
+    for (const auto &range : ranges) {
+        m_timelinePreview->invalidatePreview(range.first, range.second);
+    }
 }
 
 void TimelineController::changeItemSpeed(int clipId, double speed)
@@ -4014,3 +4070,89 @@ void TimelineController::showToolTip(const QString &info) const
 {
     pCore->displayMessage(info, DirectMessage);
 }
+
+void TimelineController::setVisibleRange(int startFrame, int endFrame)
+{
+    m_visibleRange = QPoint(startFrame, endFrame);
+    m_prefetchTimer.start();
+}
+
+void TimelineController::prefetchThumbnails()
+{
+    if (!m_model || !m_ready || !KdenliveSettings::videothumbnails() || m_visibleRange.y() <= m_visibleRange.x()) {
+        m_thumbPrefetcher->cancel();
+        return;
+    }
+    // Also prepare half a page on each side so that thumbnails are ready when scrolling
+    int margin = (m_visibleRange.y() - m_visibleRange.x()) / 2;
+    int rangeStart = qMax(0, m_visibleRange.x() - margin);
+    int rangeEnd = m_visibleRange.y() + margin;
+    int playhead = pCore->getTimelinePosition();
+    double dar = pCore->getCurrentDar();
+    int keyframeSpacing = keyframeThumbSpacing();
+    std::unordered_map<QString, std::set<int>> requests;
+    std::unordered_map<QString, int> priorities;
+    for (const auto &track : m_model->m_allTracks) {
+        if (track->isAudioTrack() || track->getProperty("kdenlive:collapsed").toInt() > 0) {
+            continue;
+        }
+        // Thumbs format: 0 = in/out, 1 = all frames, 2 = in frame, 3 = none
+        int thumbsFormat = track->getProperty("kdenlive:thumbs_format").toInt();
+        if (thumbsFormat > 2) {
+            continue;
+        }
+        int trackHeight = track->getProperty("kdenlive:trackheight").toInt();
+        if (trackHeight <= 0) {
+            trackHeight = KdenliveSettings::trackheight();
+        }
+        // Must match the thumbnail width computed in ClipThumbs.qml (the clip border is 2 pixels)
+        int thumbWidth = int((trackHeight - 4) * dar);
+        if (thumbWidth <= 0) {
+            continue;
+        }
+        for (const auto &clip : track->m_allClips) {
+            ClipType::ProducerType type = clip.second->clipType();
+            if ((type != ClipType::Video && type != ClipType::AV && type != ClipType::Playlist) || clip.second->isAudioOnly()) {
+                continue;
+            }
+            int pos = clip.second->getPosition();
+            int playtime = clip.second->getPlaytime();
+            if (pos > rangeEnd || pos + playtime < rangeStart) {
+                continue;
+            }
+            const QString &binId = clip.second->binId();
+            int in = clip.second->getIn();
+            double speed = clip.second->getSpeed();
+            int count = thumbsFormat == 0 ? 2 : thumbsFormat == 2 ? 1 : qCeil((playtime * m_scale - 4) / thumbWidth);
+            if (count > 2 && keyframeSpacing > 0 && thumbWidth / m_scale * qAbs(speed) >= keyframeSpacing) {
+                // The thumbnail strip requests keyframe aligned thumbnails at this zoom level, they are cheap enough
+                continue;
+            }
+            std::set<int> &frames = requests[binId];
+            int maxDuration = clip.second->getMaxDuration();
+            if (count < 3) {
+                frames.insert(ThumbnailPrefetcher::sourceFrame(in, 0, speed, maxDuration));
+                if (count == 2) {
+                    frames.insert(ThumbnailPrefetcher::sourceFrame(in, clip.second->getOut() - in, speed, maxDuration));
+                }
+            } else {
+                for (int i = 0; i < count; ++i) {
+                    int offset = qRound(i * thumbWidth / m_scale);
+                    if (pos + offset < rangeStart) {
+                        continue;
+                    }
+                    if (pos + offset > rangeEnd) {
+                        break;
+                    }
+                    frames.insert(ThumbnailPrefetcher::sourceFrame(in, offset, speed, maxDuration));
+                }
+            }
+            int distance = playhead < pos ? pos - playhead : (playhead > pos + playtime ? playhead - pos - playtime : 0);
+            auto prio = priorities.find(binId);
+            if (prio == priorities.end() || prio->second > distance) {
+                priorities[binId] = distance;
+            }
+        }
+    }
+    m_thumbPrefetcher->setRequests(std::move(requests), priorities);
+}
@@ -28,8 +28,10 @@
 
 #include <KActionCollection>
 #include <QDir>
+#include <QTimer>
 
 class PreviewManager;
+class ThumbnailPrefetcher;
 class QAction;
 class QQuickItem;
 
@@ -56,6 +58,10 @@ class TimelineController : public QObject
     Q_PROPERTY(bool scrub READ scrub NOTIFY scrubChanged)
     Q_PROPERTY(bool snap READ snap NOTIFY snapChanged)
     Q_PROPERTY(bool showThumbnails READ showThumbnails NOTIFY showThumbnailsChanged)
+    /* @brief minimum distance in frames between two thumbnails for keyframe aligned thumbnails, 0 if disabled
+     */
+    Q_PROPERTY(int keyframeThumbSpacing READ keyframeThumbSpacing NOTIFY showThumbnailsChanged)
+    Q_PROPERTY(QObject *thumbnailPrefetcher READ thumbnailPrefetcher CONSTANT)
     Q_PROPERTY(bool showMarkers READ showMarkers NOTIFY showMarkersChanged)
     Q_PROPERTY(bool showAudioThumbnails READ showAudioThumbnails NOTIFY showAudioThumbnailsChanged)
     Q_PROPERTY(QVariantList dirtyChunks READ dirtyChunks NOTIFY dirtyChunksChanged)
@@ -257,6 +263,12 @@ public:
     /* @brief Do we want to display video thumbnails
      */
     bool showThumbnails() const;
+    /* @brief When thumbnails are at least this number of frames apart, snapping them to keyframes is acceptable
+     */
+    int keyframeThumbSpacing() const;
+    /* @brief The thumbnail decoder used by the timeline clips' thumbnail strips
+     */
+    QObject *thumbnailPrefetcher() const;
     bool showAudioThumbnails() const;
     bool showMarkers() const;
     bool audioThumbFormat() const;
@@ -493,6 +505,9 @@ public:
      */
     void clearPreviewRange(bool resetZones);
     void startPreviewRender();
+    /* @brief Add a timeline section to preview rendering and start rendering it
+     */
+    void renderPreviewZone(const QPoint &zone);
     void stopPreviewRender();
     QVariantList dirtyChunks() const;
     QVariantList renderedChunks() const;
@@ -588,6 +603,11 @@ public:
     void importSubtitle(const QString path = QString());
     /** @brief Export a subtitle file*/
     void exportSubtitle();
+    /** @brief The visible timeline range changed (scroll or zoom), schedule thumbnail prefetching
+     *  @param startFrame the first visible frame
+     *  @param endFrame the last visible frame
+     */
+    Q_INVOKABLE void setVisibleRange(int startFrame, int endFrame);
 
 public slots:
     void resetView();
@@ -599,8 +619,12 @@ public slots:
     /** @brief Dis / enable timeline preview. */
     void disablePreview(bool disable);
     void invalidateItem(int cid);
-    void invalidateTrack(int tid);
-    void invalidateZone(int in, int out);
+    /** @brief Invalidate the preview of all clips in a track.
+     *  @param visibilityChanged true if the track was hidden or shown, otherwise nothing is done for a hidden track
+     */
+    void invalidateTrack(int tid, bool visibilityChanged = false);
+    /** @brief Invalidate the preview between in and out, limited to the frames where @param trackId can be seen if it is not -1 */
+    void invalidateZone(int in, int out, int trackId = -1);
     void checkDuration();
     /** @brief Dis / enable multi track view. */
     void slotMultitrackView(bool enable = true, bool refresh = true);
@@ -619,6 +643,8 @@ private slots:
     void updateAudioTarget();
     /** @brief Dis / enable multi track view. */
     void updateMultiTrack();
+    /** @brief Compute the thumbnails needed around the visible range and pass them to the prefetcher. */
+    void prefetchThumbnails();
 
 public:
     /** @brief a list of actions that have to be enabled/disabled depending on the timeline selection */
@@ -654,10 +680,16 @@ private:
     int m_snapStackIndex;
     QMetaObject::Connection m_connection;
     QMetaObject::Connection m_deleteConnection;
+    ThumbnailPrefetcher *m_thumbPrefetcher;
+    /** @brief The visible timeline range (first frame, last frame) as reported by qml */
+    QPoint m_visibleRange;
+    QTimer m_prefetchTimer;
 
     void initializePreview();
     bool darkBackground() const;
     int getMenuOrTimelinePos() const;
+    /** @brief Invalidate the preview chunks where a change in track @param tid can be seen */
+    void invalidateTrackZone(int tid, int in, int out, bool visibilityChanged);
 
 signals:
     void selected(Mlt::Producer *producer);
@@ -27,15 +27,29 @@
 #include <QStandardPaths>
 
 #include "profiles/profilemodel.hpp"
+#include "utils/startupprofiler.hpp"
 #include <mlt++/Mlt.h>
 
 std::unique_ptr<TransitionsRepository> TransitionsRepository::instance;
 std::once_flag TransitionsRepository::m_onceFlag;
 
+// File name of the catalog cache, in the application cache directory
+static const QString catalogName = QStringLiteral("transitions.catalog");
+
 TransitionsRepository::TransitionsRepository()
     : AbstractAssetsRepository<AssetListType::AssetType>()
 {
+    StartupProfiler::Phase phase(QStringLiteral("Transitions repository"));
     init();
+}
+
+void TransitionsRepository::prefetch()
+{
+    prefetchCatalog(catalogName);
+}
+
+void TransitionsRepository::checkFavorites()
+{
     QStringList invalidTransition;
     for (const QString &effect : KdenliveSettings::favorite_transitions()) {
         if (!exists(effect)) {
@@ -153,6 +167,11 @@ QString TransitionsRepository::assetPreferredListPath() const
     return QLatin1String("");
 }
 
+QString TransitionsRepository::assetCatalogName() const
+{
+    return catalogName;
+}
+
 std::unique_ptr<Mlt::Transition> TransitionsRepository::getTransition(const QString &transitionId) const
 {
     Q_ASSERT(exists(transitionId));
@@ -40,6 +40,9 @@ public:
     // Returns the instance of the Singleton
     static std::unique_ptr<TransitionsRepository> &get();
 
+    /* @brief Starts reading the transitions' catalog cache from disk, so that building the repository does not wait for it */
+    static void prefetch();
+
     /* @brief Creates and return an instance of a transition given its id.
      */
     std::unique_ptr<Mlt::Transition> getTransition(const QString &transitionId) const;
@@ -50,6 +53,10 @@ public:
     /* @brief Returns the id of the transition to be used for compositing */
     const QString getCompositingTransition();
 
+    /** @brief Removes the favorite compositions that don't exist anymore.
+     *  This writes the settings, so it must run in the GUI thread once the repository is loaded. */
+    void checkFavorites();
+
 protected:
     // Constructor is protected because class is a Singleton
     TransitionsRepository();
@@ -71,6 +78,9 @@ protected:
     /* @brief Returns the path to the effects' preferred list*/
     QString assetPreferredListPath() const override;
 
+    /* @brief Returns the file name of the transitions' catalog cache*/
+    QString assetCatalogName() const override;
+
     void parseType(QScopedPointer<Mlt::Properties> &metadata, Info &res) override;
 
     /* @brief Returns the metadata associated with the given asset*/
@@ -0,0 +1,169 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by agent <agent@local>                             *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "startupprofiler.hpp"
+#include "kdenlive_debug.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QThread>
+#include <QVector>
+#include <iostream>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#else
+#include <ctime>
+#endif
+
+namespace {
+struct PhaseInfo
+{
+    QString name;
+    QString thread;
+    qint64 start;
+    qint64 wall;
+    qint64 cpu;
+};
+
+// Startup should not keep the user waiting for more than a second
+const qint64 interactiveTargetMs = 1000;
+
+QMutex profilerMutex;
+QElapsedTimer startupClock;
+QVector<PhaseInfo> phases;
+QString outputPath;
+bool finished = false;
+} // namespace
+
+void StartupProfiler::start()
+{
+    QMutexLocker lk(&profilerMutex);
+    if (!startupClock.isValid()) {
+        startupClock.start();
+    }
+}
+
+qint64 StartupProfiler::elapsed()
+{
+    QMutexLocker lk(&profilerMutex);
+    return startupClock.isValid() ? startupClock.elapsed() : 0;
+}
+
+qint64 StartupProfiler::threadCpuTime()
+{
+#ifdef Q_OS_WIN
+    FILETIME creation, exit, kernel, user;
+    if (GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user) == 0) {
+        return 0;
+    }
+    // FILETIME is in 100 ns units
+    quint64 kernelTime = (quint64(kernel.dwHighDateTime) << 32) | kernel.dwLowDateTime;
+    quint64 userTime = (quint64(user.dwHighDateTime) << 32) | user.dwLowDateTime;
+    return qint64((kernelTime + userTime) / 10000);
+#else
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+        return 0;
+    }
+    return qint64(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+#endif
+}
+
+void StartupProfiler::setOutput(const QString &output)
+{
+    QMutexLocker lk(&profilerMutex);
+    outputPath = output;
+}
+
+void StartupProfiler::record(const QString &name, qint64 startMs, qint64 wallMs, qint64 cpuMs)
+{
+    QMutexLocker lk(&profilerMutex);
+    if (finished) {
+        return;
+    }
+    bool mainThread = QCoreApplication::instance() == nullptr || QThread::currentThread() == QCoreApplication::instance()->thread();
+    QString thread = mainThread ? QStringLiteral("main") : QStringLiteral("worker");
+    phases.append({name, thread, startMs, wallMs, cpuMs});
+}
+
+void StartupProfiler::finish()
+{
+    QMutexLocker lk(&profilerMutex);
+    if (finished) {
+        return;
+    }
+    finished = true;
+    qint64 total = startupClock.isValid() ? startupClock.elapsed() : 0;
+    // finish() is called from the main thread
+    qint64 totalCpu = threadCpuTime();
+    if (outputPath.isEmpty()) {
+        return;
+    }
+    QString summary = QStringLiteral("Startup profile, interactive after %1 ms (target %2 ms%3), main thread cpu %4 ms\n")
+                          .arg(total)
+                          .arg(interactiveTargetMs)
+                          .arg(total > interactiveTargetMs ? QStringLiteral(", exceeded") : QString())
+                          .arg(totalCpu);
+    QJsonArray list;
+    for (const PhaseInfo &phase : qAsConst(phases)) {
+        summary.append(QStringLiteral("  %1 (%2): start %3 ms, wall %4 ms, cpu %5 ms\n").arg(phase.name, phase.thread).arg(phase.start).arg(phase.wall).arg(phase.cpu));
+        QJsonObject obj;
+        obj.insert(QLatin1String("name"), phase.name);
+        obj.insert(QLatin1String("thread"), phase.thread);
+        obj.insert(QLatin1String("start"), phase.start);
+        obj.insert(QLatin1String("wall"), phase.wall);
+        obj.insert(QLatin1String("cpu"), phase.cpu);
+        list.append(obj);
+    }
+    if (outputPath == QLatin1String("-")) {
+        std::cout << summary.toStdString() << std::flush;
+        return;
+    }
+    qCDebug(KDENLIVE_LOG).noquote() << summary;
+    QJsonObject report;
+    report.insert(QLatin1String("interactive"), total);
+    report.insert(QLatin1String("target"), interactiveTargetMs);
+    report.insert(QLatin1String("cpu"), totalCpu);
+    report.insert(QLatin1String("phases"), list);
+    QFile file(outputPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCWarning(KDENLIVE_LOG) << "Cannot write startup profile to" << outputPath;
+        return;
+    }
+    file.write(QJsonDocument(report).toJson());
+}
+
+StartupProfiler::Phase::Phase(const QString &name)
+    : m_name(name)
+    , m_start(StartupProfiler::elapsed())
+    , m_cpuStart(StartupProfiler::threadCpuTime())
+{
+}
+
+StartupProfiler::Phase::~Phase()
+{
+    StartupProfiler::record(m_name, m_start, StartupProfiler::elapsed() - m_start, StartupProfiler::threadCpuTime() - m_cpuStart);
+}
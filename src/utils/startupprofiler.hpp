@@ -0,0 +1,77 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by agent <agent@local>                             *
+ *   This file is part of Kdenlive. See www.kdenlive.org.                  *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) version 3 or any later version accepted by the       *
+ *   membership of KDE e.V. (or its successor approved  by the membership  *
+ *   of KDE e.V.), which shall act as a proxy defined in Section 14 of     *
+ *   version 3 of the license.                                             *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#pragma once
+
+#include <QElapsedTimer>
+#include <QString>
+
+/** @brief This class records how long each step of the application startup takes.
+    Phases are recorded with their wall time and the CPU time used by their own thread meanwhile,
+    which shows whether a phase is busy or waiting (on disk, GPU or another thread).
+    The report compares the time until the main window is interactive with the one second target.
+    Recording is always on since it only costs a few timer reads, the report is only
+    written if it was requested with the --startup-profile command line option.
+    All functions are thread safe so that phases running in background threads can be recorded.
+ */
+
+class StartupProfiler
+{
+
+public:
+    /* @brief Starts the startup clock, must be called as early as possible */
+    static void start();
+
+    /* @brief Requests a report when startup is finished
+       @param output path of a JSON file to write, or "-" to print the report on the standard output
+    */
+    static void setOutput(const QString &output);
+
+    /* @brief Marks the application as interactive and writes the report if requested. Later phases are ignored */
+    static void finish();
+
+    /* @brief Records a phase that was measured by the caller
+       @param name the name of the phase
+       @param startMs the start of the phase, in ms since start()
+       @param wallMs the wall clock duration of the phase
+       @param cpuMs the CPU time used by the calling thread during the phase
+    */
+    static void record(const QString &name, qint64 startMs, qint64 wallMs, qint64 cpuMs);
+
+    /* @brief Returns the ms elapsed since start() */
+    static qint64 elapsed();
+
+    /* @brief Returns the CPU time used by the calling thread since it started, in ms */
+    static qint64 threadCpuTime();
+
+    /** @brief Measures the lifetime of the object as a startup phase */
+    class Phase
+    {
+    public:
+        explicit Phase(const QString &name);
+        ~Phase();
+
+    private:
+        QString m_name;
+        qint64 m_start;
+        qint64 m_cpuStart;
+    };
+};
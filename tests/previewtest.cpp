@@ -0,0 +1,108 @@
+#include "catch.hpp"
+#include "doc/docundostack.hpp"
+#include "test_utils.hpp"
+
+#include "definitions.h"
+#define private public
+#define protected public
+#include "core.h"
+
+using namespace fakeit;
+Mlt::Profile profile_preview;
+
+TEST_CASE("Timeline preview dependencies", "[Preview]")
+{
+    Logger::clear();
+    auto binModel = pCore->projectItemModel();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    std::shared_ptr<MarkerListModel> guideModel = std::make_shared<MarkerListModel>(undoStack);
+
+    Mock<ProjectManager> pmMock;
+    When(Method(pmMock, undoStack)).AlwaysReturn(undoStack);
+    ProjectManager &mocked = pmMock.get();
+    pCore->m_projectManager = &mocked;
+
+    TimelineItemModel tim(&profile_preview, undoStack);
+    Mock<TimelineItemModel> timMock(tim);
+    auto timeline = std::shared_ptr<TimelineItemModel>(&timMock.get(), [](...) {});
+    TimelineItemModel::finishConstruct(timeline, guideModel);
+    Fake(Method(timMock, adjustAssetRange));
+
+    int tidAudio, tid1, tid2;
+    REQUIRE(timeline->requestTrackInsertion(-1, tidAudio, QString(), true));
+    REQUIRE(timeline->requestTrackInsertion(-1, tid1));
+    REQUIRE(timeline->requestTrackInsertion(-1, tid2));
+    // tid2 is above tid1
+    REQUIRE(timeline->getTrackPosition(tid2) > timeline->getTrackPosition(tid1));
+
+    QString opaqueId = createProducer(profile_preview, "0xff0000ff", binModel, 20);
+    QString transparentId = createProducer(profile_preview, "0x00000000", binModel, 20);
+    int lowerClip, upperClip;
+    REQUIRE(timeline->requestClipInsertion(opaqueId, tid1, 0, lowerClip));
+    using Ranges = std::vector<std::pair<int, int>>;
+
+    SECTION("Nothing above")
+    {
+        REQUIRE(TimelineFunctions::visibleRanges(timeline, tid1, 0, 50) == Ranges({{0, 50}}));
+        // Preview is rendered without audio
+        REQUIRE(TimelineFunctions::visibleRanges(timeline, tidAudio, 0, 50).empty());
+        // Unknown track, invalidate everything
+        REQUIRE(TimelineFunctions::visibleRanges(timeline, -1, 50, 0) == Ranges({{0, 50}}));
+    }
+
+    SECTION("Opaque clip on upper track")
+    {
+        REQUIRE(timeline->requestClipInsertion(opaqueId, tid2, 10, upperClip));
+        REQUIRE(TimelineFunctions::isOpaqueClip(timeline, upperClip));
+        REQUIRE(TimelineFunctions::visibleRanges(timeline, tid1, 0, 50) == Ranges({{0, 9}, {30, 50}}));
+        REQUIRE(TimelineFunctions::visibleRanges(timeline, tid1, 12, 25).empty());
+        // Nothing above the upper track
+        REQUIRE(TimelineFunctions::visibleRanges(timeline, tid2, 0, 50) == Ranges({{0, 50}}));
+
+        // Hidden upper track does not cover anything
+        timeline->getTrackById(tid2)->setProperty(QStringLiteral("hide"), QStringLiteral("3"));
+        REQUIRE(TimelineFunctions::visibleRanges(timeline, tid1, 0, 50) == Ranges({{0, 50}}));
+        timeline->getTrackById(tid2)->setProperty(QStringLiteral("hide"), QStringLiteral("2"));
+
+        // A video effect may make the clip transparent
+        REQUIRE(timeline->getClipPtr(upperClip)->addEffect(QStringLiteral("sepia")));
+        REQUIRE_FALSE(TimelineFunctions::isOpaqueClip(timeline, upperClip));
+        REQUIRE(TimelineFunctions::visibleRanges(timeline, tid1, 0, 50) == Ranges({{0, 50}}));
+    }
+
+    SECTION("Transparent clip on upper track")
+    {
+        REQUIRE(timeline->requestClipInsertion(transparentId, tid2, 10, upperClip));
+        REQUIRE_FALSE(TimelineFunctions::isOpaqueClip(timeline, upperClip));
+        REQUIRE(TimelineFunctions::visibleRanges(timeline, tid1, 0, 50) == Ranges({{0, 50}}));
+    }
+
+    SECTION("Hidden track")
+    {
+        REQUIRE(timeline->requestClipInsertion(opaqueId, tid2, 10, upperClip));
+        timeline->getTrackById(tid1)->setProperty(QStringLiteral("hide"), QStringLiteral("3"));
+        REQUIRE(TimelineFunctions::visibleRanges(timeline, tid1, 0, 50).empty());
+        // Hiding or showing the track itself changes the output where it is not covered
+        REQUIRE(TimelineFunctions::visibleRanges(timeline, tid1, 0, 50, true) == Ranges({{0, 9}, {30, 50}}));
+    }
+
+    SECTION("Composition above the track")
+    {
+        QString compoId;
+        for (const auto &trans : TransitionsRepository::get()->getNames()) {
+            if (TransitionsRepository::get()->isComposition(trans.first)) {
+                compoId = trans.first;
+                break;
+            }
+        }
+        REQUIRE(!compoId.isEmpty());
+        REQUIRE(timeline->requestClipInsertion(opaqueId, tid2, 10, upperClip));
+        int compo = CompositionModel::construct(timeline, compoId, QString());
+        REQUIRE(timeline->requestCompositionMove(compo, tid2, 12));
+        int length = timeline->getCompositionPlaytime(compo);
+        REQUIRE(TimelineFunctions::visibleRanges(timeline, tid1, 0, 50) == Ranges({{0, 9}, {12, 11 + length}, {30, 50}}));
+    }
+    binModel->clean();
+    pCore->m_projectManager = nullptr;
+    Logger::print_trace();
+}
@@ -0,0 +1,193 @@
+#include "test_utils.hpp"
+
+using namespace fakeit;
+Mlt::Profile profile_ripple;
+
+TEST_CASE("Ripple shift of the timeline tail", "[Ripple]")
+{
+    Logger::clear();
+    auto binModel = pCore->projectItemModel();
+    binModel->clean();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    std::shared_ptr<MarkerListModel> guideModel = std::make_shared<MarkerListModel>(undoStack);
+
+    Mock<ProjectManager> pmMock;
+    When(Method(pmMock, undoStack)).AlwaysReturn(undoStack);
+
+    ProjectManager &mocked = pmMock.get();
+    pCore->m_projectManager = &mocked;
+
+    TimelineItemModel tim(&profile_ripple, undoStack);
+    Mock<TimelineItemModel> timMock(tim);
+    auto timeline = std::shared_ptr<TimelineItemModel>(&timMock.get(), [](...) {});
+    TimelineItemModel::finishConstruct(timeline, guideModel);
+
+    RESET(timMock)
+
+    QString binId = createProducer(profile_ripple, "red", binModel);
+
+    int tid1 = TrackModel::construct(timeline);
+    int tid2 = TrackModel::construct(timeline);
+    int cid1 = ClipModel::construct(timeline, binId, -1, PlaylistState::VideoOnly);
+    int cid2 = ClipModel::construct(timeline, binId, -1, PlaylistState::VideoOnly);
+    int cid3 = ClipModel::construct(timeline, binId, -1, PlaylistState::VideoOnly);
+    int cid4 = ClipModel::construct(timeline, binId, -1, PlaylistState::VideoOnly);
+
+    REQUIRE(timeline->requestClipMove(cid1, tid1, 0));
+    REQUIRE(timeline->requestClipMove(cid2, tid1, 30));
+    REQUIRE(timeline->requestClipMove(cid3, tid1, 60));
+    REQUIRE(timeline->requestClipMove(cid4, tid2, 40));
+
+    auto state0 = [&]() {
+        REQUIRE(timeline->checkConsistency());
+        REQUIRE(timeline->getClipTrackId(cid1) == tid1);
+        REQUIRE(timeline->getClipTrackId(cid4) == tid2);
+        REQUIRE(timeline->getClipPosition(cid1) == 0);
+        REQUIRE(timeline->getClipPosition(cid2) == 30);
+        REQUIRE(timeline->getClipPosition(cid3) == 60);
+        REQUIRE(timeline->getClipPosition(cid4) == 40);
+        REQUIRE(timeline->duration() == 80);
+    };
+    state0();
+
+    Fun undo = []() { return true; };
+    Fun redo = []() { return true; };
+
+    SECTION("Insert space on all tracks")
+    {
+        REQUIRE(timeline->requestRippleShift(25, 10, undo, redo));
+        auto state1 = [&]() {
+            REQUIRE(timeline->checkConsistency());
+            REQUIRE(timeline->getClipPosition(cid1) == 0);
+            REQUIRE(timeline->getClipPosition(cid2) == 40);
+            REQUIRE(timeline->getClipPosition(cid3) == 70);
+            REQUIRE(timeline->getClipPosition(cid4) == 50);
+            REQUIRE(timeline->duration() == 90);
+        };
+        state1();
+        REQUIRE(undo());
+        state0();
+        REQUIRE(redo());
+        state1();
+        REQUIRE(undo());
+        state0();
+    }
+
+    SECTION("Remove space on all tracks")
+    {
+        REQUIRE(timeline->requestRippleShift(25, -5, undo, redo));
+        REQUIRE(timeline->checkConsistency());
+        REQUIRE(timeline->getClipPosition(cid1) == 0);
+        REQUIRE(timeline->getClipPosition(cid2) == 25);
+        REQUIRE(timeline->getClipPosition(cid3) == 55);
+        REQUIRE(timeline->getClipPosition(cid4) == 35);
+        REQUIRE(timeline->duration() == 75);
+        REQUIRE(undo());
+        state0();
+    }
+
+    SECTION("Not enough space is rejected on all tracks")
+    {
+        // The shift succeeds on tid2 but not on tid1, so tid2 must be restored
+        REQUIRE_FALSE(timeline->requestRippleShift(25, -15, undo, redo, {tid2, tid1}));
+        state0();
+    }
+
+    SECTION("Clip over the position is shifted")
+    {
+        REQUIRE(timeline->requestRippleShift(35, 10, undo, redo));
+        REQUIRE(timeline->checkConsistency());
+        REQUIRE(timeline->getClipPosition(cid1) == 0);
+        REQUIRE(timeline->getClipPosition(cid2) == 40);
+        REQUIRE(timeline->getClipPosition(cid3) == 70);
+        REQUIRE(timeline->getClipPosition(cid4) == 50);
+        REQUIRE(undo());
+        state0();
+    }
+
+    SECTION("Locked tracks are not shifted")
+    {
+        timeline->setTrackLockedState(tid2, true);
+        REQUIRE(timeline->requestRippleShift(25, 10, undo, redo));
+        REQUIRE(timeline->checkConsistency());
+        REQUIRE(timeline->getClipPosition(cid2) == 40);
+        REQUIRE(timeline->getClipPosition(cid3) == 70);
+        REQUIRE(timeline->getClipPosition(cid4) == 40);
+        REQUIRE(undo());
+        timeline->setTrackLockedState(tid2, false);
+        state0();
+    }
+
+    SECTION("Groups are not split")
+    {
+        REQUIRE(timeline->requestClipsGroup({cid1, cid2}) > 0);
+        REQUIRE_FALSE(timeline->requestRippleShift(25, 10, undo, redo));
+        state0();
+        REQUIRE(timeline->requestClipsGroup({cid3, cid4}) > 0);
+        REQUIRE(timeline->requestRippleShift(50, 10, undo, redo));
+        REQUIRE(timeline->checkConsistency());
+        REQUIRE(timeline->getClipPosition(cid2) == 30);
+        REQUIRE(timeline->getClipPosition(cid3) == 70);
+        REQUIRE(timeline->getClipPosition(cid4) == 50);
+        REQUIRE(undo());
+        state0();
+    }
+
+    SECTION("Insert and remove space use the ripple shift")
+    {
+        REQUIRE(TimelineFunctions::requestInsertSpace(timeline, QPoint(25, 35), undo, redo));
+        REQUIRE(timeline->checkConsistency());
+        REQUIRE(timeline->getClipPosition(cid2) == 40);
+        REQUIRE(timeline->getClipPosition(cid3) == 70);
+        REQUIRE(timeline->getClipPosition(cid4) == 50);
+        REQUIRE(TimelineFunctions::removeSpace(timeline, QPoint(25, 35), undo, redo, {tid1, tid2}));
+        state0();
+        REQUIRE(undo());
+        state0();
+    }
+
+    SECTION("Spacer removes space")
+    {
+        REQUIRE(TimelineFunctions::requestSpacerStartOperation(timeline, -1, 25) > -1);
+        REQUIRE(TimelineFunctions::requestSpacerEndOperation(timeline, cid2, 30, 25, -1));
+        REQUIRE(timeline->checkConsistency());
+        REQUIRE(timeline->getClipPosition(cid1) == 0);
+        REQUIRE(timeline->getClipPosition(cid2) == 25);
+        REQUIRE(timeline->getClipPosition(cid3) == 55);
+        REQUIRE(timeline->getClipPosition(cid4) == 35);
+        undoStack->undo();
+        state0();
+    }
+
+    SECTION("Spacer in overwrite mode overwrites the zone")
+    {
+        timeline->setEditMode(TimelineMode::OverwriteEdit);
+        REQUIRE(TimelineFunctions::requestSpacerStartOperation(timeline, -1, 25) > -1);
+        // Moving back over the end of cid1 cuts it
+        REQUIRE(TimelineFunctions::requestSpacerEndOperation(timeline, cid2, 30, 15, -1));
+        REQUIRE(timeline->checkConsistency());
+        REQUIRE(timeline->getClipPosition(cid1) == 0);
+        REQUIRE(timeline->getClipPlaytime(cid1) == 15);
+        REQUIRE(timeline->getClipPosition(cid2) == 15);
+        REQUIRE(timeline->getClipPosition(cid3) == 45);
+        REQUIRE(timeline->getClipPosition(cid4) == 25);
+        undoStack->undo();
+        REQUIRE(timeline->getClipPlaytime(cid1) == 20);
+        state0();
+        // Moving forward only inserts space
+        REQUIRE(TimelineFunctions::requestSpacerStartOperation(timeline, -1, 25) > -1);
+        REQUIRE(TimelineFunctions::requestSpacerEndOperation(timeline, cid2, 30, 40, -1));
+        REQUIRE(timeline->checkConsistency());
+        REQUIRE(timeline->getClipPlaytime(cid1) == 20);
+        REQUIRE(timeline->getClipPosition(cid2) == 40);
+        REQUIRE(timeline->getClipPosition(cid3) == 70);
+        REQUIRE(timeline->getClipPosition(cid4) == 50);
+        undoStack->undo();
+        state0();
+        timeline->setEditMode(TimelineMode::NormalEdit);
+    }
+
+    binModel->clean();
+    pCore->m_projectManager = nullptr;
+    Logger::print_trace();
+}
@@ -0,0 +1,103 @@
+#include "catch.hpp"
+
+#include "scopes/colorscopes/histogramgenerator.h"
+#include "scopes/colorscopes/rgbparadegenerator.h"
+#include "scopes/colorscopes/vectorscopegenerator.h"
+#include "scopes/colorscopes/waveformgenerator.h"
+
+#include <QImage>
+#include <QRect>
+
+// Returns the bounding rect of all pixels drawn by a scope
+static QRect litArea(const QImage &scope)
+{
+    QRect area;
+    for (int y = 0; y < scope.height(); ++y) {
+        for (int x = 0; x < scope.width(); ++x) {
+            if (qAlpha(scope.pixel(x, y)) > 0) {
+                area |= QRect(x, y, 1, 1);
+            }
+        }
+    }
+    return area;
+}
+
+TEST_CASE("Colour scopes render without a display", "[Scopes]")
+{
+    // Frames as handed over by the monitor: 32 bit RGB, wider than the scopes
+    QImage gray(320, 240, QImage::Format_RGB32);
+    gray.fill(qRgb(128, 128, 128));
+    QImage gradient(320, 240, QImage::Format_RGB32);
+    for (int y = 0; y < gradient.height(); ++y) {
+        for (int x = 0; x < gradient.width(); ++x) {
+            gradient.setPixel(x, y, qRgb(x * 255 / 319, y * 255 / 239, 255 - x * 255 / 319));
+        }
+    }
+    const QSize size(256, 256);
+
+    SECTION("Waveform of a flat frame is a single line")
+    {
+        WaveformGenerator generator;
+        QRect reference;
+        for (uint accel : {1u, 2u, 4u}) {
+            QImage wave = generator.calculateWaveform(size, gray, WaveformGenerator::PaintMode_Yellow, false, ITURec::Rec_709, accel);
+            REQUIRE(wave.size() == size);
+            QRect area = litArea(wave);
+            REQUIRE(area.height() == 1);
+            if (reference.isNull()) {
+                reference = area;
+            }
+            // Skipping lines must not move the trace
+            REQUIRE(area.top() == reference.top());
+        }
+    }
+
+    SECTION("Vectorscope of a neutral frame stays in the center")
+    {
+        VectorscopeGenerator generator;
+        for (uint accel : {1u, 2u, 4u}) {
+            QImage scope = generator.calculateVectorscope(size, gray, 1., VectorscopeGenerator::PaintMode_Green2, VectorscopeGenerator::ColorSpace_YUV, false,
+                                                          accel);
+            REQUIRE(scope.size() == size);
+            QRect area = litArea(scope);
+            REQUIRE_FALSE(area.isNull());
+            REQUIRE(qAbs(area.center().x() - (size.width() - 1) / 2) <= 1);
+            REQUIRE(qAbs(area.center().y() - (size.height() - 1) / 2) <= 1);
+            REQUIRE(area.width() <= 2);
+            REQUIRE(area.height() <= 2);
+        }
+    }
+
+    SECTION("All scopes handle a coloured frame at each acceleration factor")
+    {
+        WaveformGenerator waveform;
+        HistogramGenerator histogram;
+        VectorscopeGenerator vectorscope;
+        RGBParadeGenerator parade;
+        const int components = HistogramGenerator::ComponentY | HistogramGenerator::ComponentR | HistogramGenerator::ComponentG | HistogramGenerator::ComponentB;
+        for (uint accel : {1u, 2u, 4u, 8u}) {
+            QImage result = waveform.calculateWaveform(size, gradient, WaveformGenerator::PaintMode_Yellow, true, ITURec::Rec_709, accel);
+            REQUIRE(result.size() == size);
+            REQUIRE_FALSE(litArea(result).isNull());
+            result = histogram.calculateHistogram(size, gradient, components, ITURec::Rec_709, false, false, accel);
+            REQUIRE(result.size() == size);
+            REQUIRE_FALSE(litArea(result).isNull());
+            result = vectorscope.calculateVectorscope(size, gradient, 1., VectorscopeGenerator::PaintMode_Green2, VectorscopeGenerator::ColorSpace_YUV, true,
+                                                      accel);
+            REQUIRE(result.size() == size);
+            // A colourful frame spreads out of the center
+            REQUIRE(litArea(result).width() > 10);
+            result = parade.calculateRGBParade(size, gradient, RGBParadeGenerator::PaintMode_RGB, true, false, accel);
+            REQUIRE(result.size() == size);
+            REQUIRE_FALSE(litArea(result).isNull());
+        }
+    }
+
+    SECTION("Invalid input gives a null image")
+    {
+        WaveformGenerator waveform;
+        VectorscopeGenerator vectorscope;
+        REQUIRE(waveform.calculateWaveform(size, QImage(), WaveformGenerator::PaintMode_Yellow, false, ITURec::Rec_709).isNull());
+        REQUIRE(vectorscope.calculateVectorscope(QSize(), gray, 1., VectorscopeGenerator::PaintMode_Green2, VectorscopeGenerator::ColorSpace_YUV, false).isNull());
+    }
+}
@@ -0,0 +1,96 @@
+#include "catch.hpp"
+
+#include <QDateTime>
+#include <QDomDocument>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+
+#define private public
+#define protected public
+#include "bin/projectclip.h"
+#include "doc/projectsidecar.h"
+
+// Write a project referencing the clip at @param path with the signature a ProjectClip would record when hashing it
+static QDomDocument hashedProject(const QString &path, bool withModified = true)
+{
+    const qint64 modified = QFileInfo(path).lastModified().toMSecsSinceEpoch();
+    const QPair<QByteArray, qint64> hashData = ProjectClip::calculateHash(path);
+    QString xml = QStringLiteral("<mlt root=\"%1\"><producer id=\"producer0\">"
+                                 "<property name=\"mlt_service\">avformat</property>"
+                                 "<property name=\"resource\">%2</property>"
+                                 "<property name=\"kdenlive:file_hash\">%3</property>"
+                                 "<property name=\"kdenlive:file_size\">%4</property>")
+                      .arg(QFileInfo(path).absolutePath(), QFileInfo(path).fileName(), QString::fromLatin1(hashData.first.toHex()),
+                           QString::number(hashData.second));
+    if (withModified) {
+        xml.append(QStringLiteral("<property name=\"kdenlive:file_modified\">%1</property>").arg(modified));
+    }
+    xml.append(QStringLiteral("</producer></mlt>"));
+    QDomDocument doc;
+    doc.setContent(xml);
+    return doc;
+}
+
+static void writeClip(const QString &path, const QByteArray &data)
+{
+    QFile file(path);
+    REQUIRE(file.open(QIODevice::WriteOnly | QIODevice::Append));
+    file.write(data);
+    file.close();
+}
+
+TEST_CASE("Project sidecar", "[Sidecar]")
+{
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    const QString clipPath = dir.filePath(QStringLiteral("clip.mp4"));
+    writeClip(clipPath, QByteArray(1000, 'a'));
+    const QByteArray hash = ProjectClip::calculateHash(clipPath).first.toHex();
+    ProjectSidecar sidecar(dir.filePath(QStringLiteral("project.kdenlive")));
+
+    SECTION("Unchanged clips are recognized on reopening")
+    {
+        QDomDocument doc = hashedProject(clipPath);
+        const QByteArray projectData = doc.toByteArray();
+        sidecar.save(projectData, doc);
+
+        ProjectSidecar reopened(dir.filePath(QStringLiteral("project.kdenlive")));
+        REQUIRE(reopened.load(projectData));
+        REQUIRE(reopened.isUnchanged(clipPath, hash));
+        REQUIRE_FALSE(reopened.isUnchanged(clipPath, QByteArray("0123456789abcdef")));
+        REQUIRE_FALSE(reopened.isUnchanged(dir.filePath(QStringLiteral("other.mp4")), hash));
+
+        // Modifying the clip after saving requires a full check
+        writeClip(clipPath, QByteArray(10, 'b'));
+        REQUIRE_FALSE(reopened.isUnchanged(clipPath, hash));
+    }
+
+    SECTION("Sidecar is ignored if the project file was modified")
+    {
+        QDomDocument doc = hashedProject(clipPath);
+        sidecar.save(doc.toByteArray(), doc);
+        REQUIRE_FALSE(sidecar.load(doc.toByteArray().append(' ')));
+        REQUIRE_FALSE(sidecar.isUnchanged(clipPath, hash));
+    }
+
+    SECTION("Clip modified between hashing and saving is not trusted")
+    {
+        QDomDocument doc = hashedProject(clipPath);
+        writeClip(clipPath, QByteArray(10, 'b'));
+        const QByteArray projectData = doc.toByteArray();
+        sidecar.save(projectData, doc);
+        REQUIRE(sidecar.load(projectData));
+        REQUIRE_FALSE(sidecar.isUnchanged(clipPath, hash));
+    }
+
+    SECTION("Clips without a recorded modification time are not stored")
+    {
+        QDomDocument doc = hashedProject(clipPath, false);
+        const QByteArray projectData = doc.toByteArray();
+        sidecar.save(projectData, doc);
+        REQUIRE(sidecar.load(projectData));
+        REQUIRE_FALSE(sidecar.isUnchanged(clipPath, hash));
+    }
+    QFile::remove(sidecar.cachePath());
+}
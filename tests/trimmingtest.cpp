@@ -1071,6 +1071,71 @@ TEST_CASE("Copy/paste", "[CP]")
         cid4 = timeline->m_groups->getSplitPartner(cid3);
         state2(tid2b);
     }
+
+    SECTION("Paste from the in-memory clipboard and from its XML")
+    {
+        int cid1 = -1;
+        REQUIRE(timeline->requestClipInsertion(binId, tid1, 3, cid1, true, true, false));
+        int l = timeline->getClipPlaytime(cid1);
+        int cid2 = timeline->m_groups->getSplitPartner(cid1);
+        REQUIRE(cid2 != -1);
+
+        QString cpy_str = TimelineFunctions::copyClips(timeline, {cid1});
+        // The copy made in this session is reused as is
+        std::shared_ptr<TimelineClipboard> fast = TimelineFunctions::readClipboard(cpy_str);
+        REQUIRE(fast != nullptr);
+        REQUIRE(fast == TimelineFunctions::readClipboard(cpy_str));
+        // Anything else goes through the XML
+        std::shared_ptr<TimelineClipboard> parsed = TimelineFunctions::readClipboard(cpy_str + QStringLiteral("\n"));
+        REQUIRE(parsed != nullptr);
+        REQUIRE(parsed != fast);
+        REQUIRE(TimelineFunctions::readClipboard(QStringLiteral("<mlt/>")) == nullptr);
+
+        auto sameContent = [](const std::shared_ptr<TimelineClipboard> &a, const std::shared_ptr<TimelineClipboard> &b) {
+            REQUIRE(a->documentId == b->documentId);
+            REQUIRE(a->offset == b->offset);
+            REQUIRE(a->masterTrack == b->masterTrack);
+            REQUIRE(a->groups == b->groups);
+            REQUIRE(a->binClips == b->binClips);
+            REQUIRE(a->clips.size() == b->clips.size());
+            for (const auto &clip : a->clips) {
+                auto match = std::find_if(b->clips.begin(), b->clips.end(), [&clip](const TimelineClipboard::ClipData &c) { return c.id == clip.id; });
+                REQUIRE(match != b->clips.end());
+                REQUIRE(match->binId == clip.binId);
+                REQUIRE(match->in == clip.in);
+                REQUIRE(match->out == clip.out);
+                REQUIRE(match->position == clip.position);
+                REQUIRE(match->track == clip.track);
+                REQUIRE(match->audioTrack == clip.audioTrack);
+                REQUIRE(match->mirrorTrack == clip.mirrorTrack);
+                REQUIRE(match->effects.size() == clip.effects.size());
+            }
+        };
+        sameContent(fast, parsed);
+
+        auto checkPasted = [&](int position) {
+            REQUIRE(timeline->checkConsistency());
+            int cid3 = timeline->getTrackById(tid1)->getClipByPosition(position);
+            REQUIRE(cid3 != -1);
+            int cid4 = timeline->m_groups->getSplitPartner(cid3);
+            REQUIRE(timeline->getClipTrackId(cid4) == tid2);
+            REQUIRE(timeline->getClipPosition(cid3) == position);
+            REQUIRE(timeline->getClipPosition(cid4) == position);
+            REQUIRE(timeline->getGroupElements(cid3) == std::unordered_set<int>({cid3, cid4}));
+        };
+        REQUIRE(TimelineFunctions::pasteClips(timeline, cpy_str, tid1, 3 + l));
+        checkPasted(3 + l);
+        REQUIRE(TimelineFunctions::pasteClips(timeline, cpy_str + QStringLiteral("\n"), tid1, 3 + 2 * l));
+        checkPasted(3 + 2 * l);
+        REQUIRE(timeline->getTrackClipsCount(tid1) == 3);
+        REQUIRE(timeline->getTrackClipsCount(tid2) == 3);
+
+        undoStack->undo();
+        undoStack->undo();
+        REQUIRE(timeline->checkConsistency());
+        REQUIRE(timeline->getTrackClipsCount(tid1) == 1);
+        REQUIRE(timeline->getTrackClipsCount(tid2) == 1);
+    }
     binModel->clean();
     pCore->m_projectManager = nullptr;
     Logger::print_trace();